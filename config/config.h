@@ -65,6 +65,34 @@
 #define MESSAGE_DURATION_INFO 3000
 #define MESSAGE_DURATION_SLEEP 3000
 
+// =============================================================================
+// BUS I2C COMPARTIDO (PMU, BME280 Y OLED EN GPIO21/22)
+// =============================================================================
+
+#define I2C_BUS_ENABLE true             // Coordinar los accesos y encolar las escrituras del display
+#define I2C_BUS_CLOCK_PMU_HZ 400000     // AXP192/AXP2101
+#define I2C_BUS_CLOCK_BME280_HZ 400000  // BME280 (hasta 3.4 MHz)
+#define I2C_BUS_CLOCK_DISPLAY_HZ 0      // SSD1306 (0 = el que indica U8g2 para el modelo)
+#define I2C_BUS_QUEUE_DEPTH 48          // Escrituras del display en cola (un sendBuffer() completo son ~43)
+#define I2C_BUS_TIMEOUT_MS 100          // Espera máxima por el bus o por hueco en la cola
+
+// =============================================================================
+// REPARTO ENTRE NÚCLEOS (MAC LoRaWAN / ADQUISICIÓN)
+// =============================================================================
+
+#define DUAL_CORE_ENABLE false          // true: lectura y codificación en una tarea del otro núcleo, en paralelo al join
+#define DUAL_CORE_ACQ_CORE 0            // Núcleo de la adquisición (loop() y LMIC corren en el 1)
+#define DUAL_CORE_POLL_MS 100           // Reintento de do_send() mientras la adquisición no termina
+
+// =============================================================================
+// FRECUENCIA DE CPU POR FASE DEL DESPERTAR (esp_pm)
+// =============================================================================
+
+#define CPU_PM_ENABLE false             // true: frecuencia mínima en las esperas, máxima solo en cálculo
+#define CPU_PM_MAX_MHZ 240              // Trabajos de LMIC (AES, arranque de TX/RX) y codificación
+#define CPU_PM_MIN_MHZ 80               // Esperas de sensores y radio (80 mantiene el APB: UART, SPI, I2C, RMT)
+#define CPU_PM_LIGHT_SLEEP false        // Sueño ligero automático en delay() (requiere FreeRTOS tickless)
+
 // =============================================================================
 // CONFIGURACIÓN LoRaWAN
 // =============================================================================
@@ -75,6 +103,23 @@
 // Parámetros de transmisión
 #define TX_POWER_DBM 17              // Potencia de transmisión (máx 17 para evitar interferencias)
 #define BACKOFF_INITIAL_SECONDS 300  // Backoff inicial exponencial
+#define BACKOFF_MAX_SECONDS 3600     // Backoff máximo entre ciclos de join (antes del mínimo por duty cycle)
+#define BACKOFF_JITTER_PERCENT 25    // Jitter aleatorio ±% aplicado al backoff de join
+
+// Aprendizaje del DR de join (guardado en NVS)
+#define JOIN_STRATEGY_ENABLE true          // Empezar los joins en frío en el último DR que funcionó
+#define JOIN_STRATEGY_PROBE_INTERVAL 8     // 1 de cada N joins prueba un DR más rápido
+#define JOIN_STRATEGY_SNR_MARGIN_DB 10     // Margen de SNR sobre el umbral para subir un DR
+#define JOIN_STRATEGY_FORGET_AFTER 3       // Ciclos fallidos tras los que se olvida el DR aprendido
+
+// Calibración del error de reloj para las ventanas RX1/RX2 (guardada en NVS)
+#define CLOCK_ERROR_DEFAULT_PERCENT 1      // Error asumido hasta la primera medida (y máximo)
+#define CLOCK_ERROR_MARGIN_PERCENT 200     // Margen sobre el error medido (200 = x2)
+#define CLOCK_ERROR_MIN_PPM 200            // Error mínimo aplicado tras calibrar
+
+// Arranque en caliente de la radio tras despertar por temporizador
+#define RADIO_WARM_START true              // Reutilizar el estado del SX1276 (sin reset ni calibración)
+#define RADIO_WARM_MAX_TEMP_DRIFT 10       // Deriva de temperatura (°C) que obliga a un arranque completo
 
 // =============================================================================
 // CLAVES LoRaWAN OTAA (¡MODIFICA EN lorawan_config.h!)
@@ -89,8 +134,86 @@
 #define SEND_INTERVAL_SECONDS 900    // Intervalo entre envíos (15 minutos)
 #define WATCHDOG_TIMEOUT_MINUTES 5   // Timeout del watchdog en minutos
 
+// Alineación de envíos a ranuras de reloj (evita colisiones entre boyas de la flota)
+#define WAKE_SLOT_ALIGN true         // true: uplink en k*intervalo + desfase; false: dormir intervalo fijo
+#define WAKE_SLOT_OFFSET_SECONDS -1  // Desfase dentro del intervalo (-1 = derivado del DevEUI)
+#define WAKE_MIN_SLEEP_SECONDS 60    // Si la próxima ranura queda más cerca, usar la siguiente
+
+// Hora de red (DeviceTimeReq) para sellar las muestras
+#define NET_TIME_ENABLE true         // Pedir la hora a la red cuando el error estimado lo requiera
+#define NET_TIME_MAX_ERROR_MS 2000   // Cota de error que obliga a pedir de nuevo la hora
+#define NET_TIME_DRIFT_PPM 150       // Deriva máxima del reloj RTC recalibrado (ppm)
+#define NET_TIME_LEAP_SECONDS 18     // Diferencia GPS - UTC en segundos intercalares
+#define ENABLE_SAMPLE_TIMESTAMP false // Añadir al payload la hora de la muestra (2 bytes, unidades de 2 s)
+
+// Envío por excepción: omitir el join y el uplink si ninguna medida cambió
+#define REPORT_BY_EXCEPTION true           // false: enviar en todos los ciclos
+#define REPORT_HEARTBEAT_SECONDS 21600     // Silencio máximo antes de forzar un envío (6 h)
+#define REPORT_DEADBAND_BATTERY 0.05f      // Banda muerta de batería (V)
+#define REPORT_DEADBAND_PH 0.05f           // Banda muerta de pH
+#define REPORT_DEADBAND_TEMPERATURE 0.3f   // Banda muerta de temperatura exterior (°C)
+#define REPORT_DEADBAND_TEMP_1M 0.05f      // Banda muerta de temperatura del agua (°C)
+#define REPORT_DEADBAND_HUMIDITY 2.0f      // Banda muerta de humedad (%)
+#define REPORT_DEADBAND_PRESSURE 0.2f      // Banda muerta de presión (hPa)
+#define REPORT_PH_ALARM_LOW 6.5f           // pH por debajo: envío inmediato al cruzar
+#define REPORT_PH_ALARM_HIGH 8.5f          // pH por encima: envío inmediato al cruzar
+
+// Resúmenes estadísticos por ventana (muestreo del agua entre uplinks)
+#define STATS_ENABLE false                 // true: muestrear el agua entre envíos y enviar resumen
+#define STATS_SAMPLE_INTERVAL_SECONDS 60   // Periodo de muestreo de pH y temperatura del agua
+#define STATS_FPORT 2                      // Puerto LoRaWAN del uplink de resumen
+
+// Despertares de muestreo resueltos en el wake stub, sin arranque completo (requiere STATS_ENABLE)
+// El stub solo lee el pH crudo del ADC: la temperatura del agua se muestrea en los arranques completos
+#define WAKE_STUB_ENABLE false             // true: los despertares intermedios no arrancan IDF/Arduino
+#define WAKE_STUB_RING_SIZE 64             // Muestras de pH guardadas en RTC entre arranques completos
+#define WAKE_STUB_ADC_SAMPLES 4            // Conversiones promediadas por muestra del stub
+
+// Muestreo de pH y batería con el coprocesador ULP durante el sueño (requiere STATS_ENABLE)
+// Alternativa a WAKE_STUB_ENABLE: la CPU solo despierta al cerrar la ventana o con alarma de pH
+#define ULP_SAMPLER_ENABLE false           // true: el ULP sustituye a los despertares de muestreo
+#define ULP_SAMPLER_PERIOD_SECONDS 10      // Periodo de muestreo del ULP
+#define ULP_SAMPLER_LOG_SIZE 128           // Muestras de pH guardadas por ventana (memoria RTC)
+#define ULP_SAMPLER_WAKE_ON_PH_ALARM true  // Despertar al cruzar REPORT_PH_ALARM_LOW/HIGH
+
+// Archivo binario de todas las lecturas en la tarjeta SD (bloques de 512 bytes)
+// En la T3 V1.6 la SD comparte GPIO15 (MOSI) con el DS18B20 y GPIO13 (CS) con la
+// alimentación de sensores: reasignar esos pines antes de habilitarlo
+#define SD_LOG_ENABLE false                // true: archivar cada lectura en la SD
+#define SD_LOG_PATH "/boya.bin"            // Archivo preasignado (buffer circular)
+#define SD_LOG_FILE_BLOCKS 4096            // Tamaño del archivo en bloques de 512 bytes (2 MB)
+
+// Muestreo multifrecuencia: cada sensor solo se enciende y lee en los ciclos que le tocan
+// Los periodos se redondean a ciclos de envío (mínimo uno por ciclo)
+#define SENSOR_MULTIRATE_ENABLE false      // true: leer según periodo y enviar máscara de presencia
+#define SENSOR_PERIOD_BME280_SECONDS 900   // Presión, temperatura y humedad del aire
+#define SENSOR_PERIOD_DS18B20_SECONDS 300  // Temperatura del agua
+#define SENSOR_PERIOD_PH_SECONDS 3600      // pH (el más caro: muestreo ADC y calentamiento)
+#define SENSOR_PHASE_BME280_CYCLES 0       // Desfase dentro del periodo (ciclos de envío)
+#define SENSOR_PHASE_DS18B20_CYCLES 0
+#define SENSOR_PHASE_PH_CYCLES 0
+
+// Salud de sensores: un sensor que falla deja de inicializarse cada ciclo y se re-sondea con backoff
+#define SENSOR_HEALTH_FAIL_THRESHOLD 3      // Fallos seguidos para dar un sensor por caído
+#define SENSOR_HEALTH_BACKOFF_MAX_CYCLES 96 // Máximo entre re-sondeos de un sensor caído (ciclos de envío)
+#define SENSOR_HEALTH_IN_PAYLOAD false      // true: añadir 1 byte con 2 bits de salud por sensor
+
+// Adquisición analógica: pH, batería y NTC en un único barrido corto calibrado con el eFuse
+// Cambia la conversión a tensión del pH: recalibrar la sonda (CALPH) al activarlo
+#define ADC_SCAN_ENABLE false               // false: cada driver con su propio bucle de analogRead()
+#define ADC_SCAN_SAMPLES 16                 // Muestras por entrada en cada barrido (media recortada)
+#define ADC_SCAN_MAX_AGE_MS 1000            // Antigüedad máxima de un barrido para reutilizarlo
+
 // Energía y batería
 #define ENABLE_SOLAR_CHARGING true   // Habilitar carga solar
+#define PMU_TELEMETRY_MAX_AGE_MS 1000 // Antigüedad máxima de la instantánea de registros del PMU
+#define BATTERY_SOC_ENABLE false     // Estado de carga por medidor del PMU o curva OCV y recuento (no lineal por tensión)
+#define BATTERY_CAPACITY_MAH 3000    // Capacidad nominal de la batería (mAh)
+#define BATTERY_INTERNAL_RES_MOHM 150 // Resistencia interna de la celda a 25 °C (mΩ)
+#define SOC_SLEEP_CURRENT_UA 150     // Consumo medio en sueño profundo (µA)
+#define SOC_AWAKE_CURRENT_MA 45      // Consumo medio despierto (mA)
+#define SOC_TX_CURRENT_MA 120        // Consumo durante la transmisión LoRa (mA)
+#define SOC_OCV_WEIGHT 0.2f          // Peso de la OCV frente al recuento por ciclo (0-1)
 #define BATTERY_LOW_THRESHOLD 20     // Umbral de batería baja (%)
 #define BATTERY_AS_PERCENTAGE        // Descomentar para enviar batería como porcentaje (1 byte)
                                      // Comentar para enviar como voltaje (2 bytes)
@@ -168,16 +291,42 @@
 #define PAYLOAD_SIZE_BATTERY 2  // 2 bytes para voltaje (* 100)
 #endif
 
-// Orden del payload: Batería, pH, Temperatura exterior, Temperatura 1m, Humedad, Presión
+#if SENSOR_MULTIRATE_ENABLE
+#define PAYLOAD_SIZE_PRESENCE 1  // Máscara de campos leídos en el ciclo
+#else
+#define PAYLOAD_SIZE_PRESENCE 0
+#endif
+
+#if ENABLE_SAMPLE_TIMESTAMP
+#define PAYLOAD_SIZE_TIMESTAMP 2  // Hora UTC compacta de la muestra
+#else
+#define PAYLOAD_SIZE_TIMESTAMP 0
+#endif
+
+#if SENSOR_HEALTH_IN_PAYLOAD
+#define PAYLOAD_SIZE_HEALTH 1  // 2 bits de salud por sensor
+#else
+#define PAYLOAD_SIZE_HEALTH 0
+#endif
+
+// Orden del payload: Batería, [Presencia], pH, Temperatura exterior, Temperatura 1m, Humedad, Presión, Hora, Salud
+// Con SENSOR_MULTIRATE_ENABLE es el tamaño máximo: solo viajan los campos leídos en el ciclo
 #define PAYLOAD_SIZE_BYTES ( \
     PAYLOAD_SIZE_BATTERY + \
+    PAYLOAD_SIZE_PRESENCE + \
     PAYLOAD_SIZE_PH + \
     PAYLOAD_SIZE_TEMPERATURE + \
     PAYLOAD_SIZE_TEMP_1M + \
     PAYLOAD_SIZE_HUMIDITY + \
-    PAYLOAD_SIZE_PRESSURE \
+    PAYLOAD_SIZE_PRESSURE + \
+    PAYLOAD_SIZE_TIMESTAMP + \
+    PAYLOAD_SIZE_HEALTH \
 )
 
+// Payload de resumen por ventana: batería (1) + 9 bytes por canal (pH, temperatura 1m)
+#define STATS_CHANNEL_COUNT (SYSTEM_HAS_PH + SYSTEM_HAS_TEMP_1M)
+#define STATS_PAYLOAD_SIZE (1 + 9 * STATS_CHANNEL_COUNT)
+
 // Valores de error para lecturas fallidas
 #define SENSOR_ERROR_TEMPERATURE -999.0f
 #define SENSOR_ERROR_HUMIDITY -1.0f
@@ -196,6 +345,7 @@
 /**
  * @brief Estructura que contiene todas las lecturas del sensor
  * @note MODIFICA esta estructura al añadir nuevos tipos de datos de sensores
+ * @note Con SENSOR_MULTIRATE_ENABLE los campos de sensores no leídos en el ciclo valen NAN
  */
 typedef struct {
     float temperature;        /**< Temperatura exterior en °C (BME280) */
@@ -204,6 +354,7 @@ typedef struct {
     float temperature_1m;     /**< Temperatura a 1m de profundidad en °C (DS18B20) */
     float ph;                 /**< Valor de pH */
     float battery;            /**< Voltaje de batería en V */
+    uint32_t timestamp;       /**< Hora UTC de la adquisición en s (0 = sin hora de red) */
     bool valid;               /**< true si todas las lecturas son válidas */
 } sensor_data_t;
 
@@ -216,7 +367,6 @@ typedef struct {
     uint8_t max_size;     /**< Tamaño máximo del buffer */
     uint8_t written;      /**< Bytes realmente escritos */
     // Añade aquí campos adicionales para configuración de payload
-    // bool include_timestamp;
     // uint8_t compression_level;
 } payload_config_t;
 
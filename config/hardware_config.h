@@ -22,6 +22,13 @@
 // Las definiciones de placa se hacen en utilities.h
 // Este archivo solo contiene las configuraciones específicas de hardware
 
+// Modelos de PMU para PMU_MODEL. Con un modelo fijo el driver es una instancia
+// estática y las llamadas se resuelven en compilación; PMU_MODEL_PROBE prueba
+// AXP2101 y AXP192 en el arranque (instancia en el heap y llamadas virtuales)
+#define PMU_MODEL_PROBE   0
+#define PMU_MODEL_AXP192  1
+#define PMU_MODEL_AXP2101 2
+
 #ifdef T3_V1_3_SX1276
 
 #define USING_SX1276
@@ -137,6 +144,9 @@
 #define HAS_PMU
 #define PMU_IRQ 35
 #define PMU_WIRE_PORT Wire
+#ifndef PMU_MODEL
+#define PMU_MODEL PMU_MODEL_AXP2101     // T3 V1.6.1 del proyecto
+#endif
 #define BOARD_VARIANT_NAME "T3 V1.6 SX1276"
 
 #define DISPLAY_MODEL_SSD_LIB SSD1306Wire
@@ -195,6 +205,11 @@
 
 #define UNUSED_PIN (0)
 
+// Placas sin modelo de PMU fijado (T3 V1.3, T-Beam AXP192 o AXP2101 según revisión)
+#ifndef PMU_MODEL
+#define PMU_MODEL PMU_MODEL_PROBE
+#endif
+
 // Tipos de radio soportados
 #if defined(USING_SX1262)
 #define RADIO_TYPE_STR "SX1262"
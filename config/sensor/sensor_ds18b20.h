@@ -10,6 +10,12 @@
 // Configuración hardware
 #define DS18B20_DATA_PIN 15  // Pin para OneWire (ajustar según hardware)
 
+// Transporte OneWire
+#define DS18B20_USE_RMT false  // true: slots generados por el RMT (sin bloquear interrupciones), false: librería OneWire
+#define DS18B20_RMT_TX_CHANNEL 0  // Canal RMT de transmisión (usa también la memoria del canal 1)
+#define DS18B20_RMT_RX_CHANNEL 2  // Canal RMT de captura (usa también la memoria del canal 3)
+#define DS18B20_RMT_MEM_BLOCKS 2  // Bloques de 64 símbolos por canal
+
 // Control de alimentación
 #define DS18B20_USE_POWER_CONTROL false  // true: usa MOSFET, false: alimentación permanente
 #ifndef DS18B20_POWER_PIN
@@ -15,7 +15,15 @@
 #ifndef PH_POWER_PIN
 #define PH_POWER_PIN 13   // Pin para controlar alimentación de sensores (si USE_POWER_CONTROL = true)
 #endif
-#define PH_POWER_ON_DELAY_MS 30000  // 30 segundos para estabilización (si USE_POWER_CONTROL = true)
+#define PH_POWER_ON_DELAY_MS 30000  // Espera máxima de estabilización (si USE_POWER_CONTROL = true)
+
+// Detección de estabilización tras encender la sonda (si USE_POWER_CONTROL = true)
+#define PH_SETTLE_ENABLE true                 // false: esperar siempre PH_POWER_ON_DELAY_MS completo
+#define PH_SETTLE_SAMPLE_INTERVAL_MS 1000     // Periodo de muestreo de la tensión durante la espera
+#define PH_SETTLE_WINDOW 8                    // Muestras de la ventana deslizante (ajuste lineal)
+#define PH_SETTLE_MIN_MS 5000                 // Espera mínima aunque la ventana ya parezca estable
+#define PH_SETTLE_MAX_DRIFT_MV 2.0f           // Variación máxima de la recta a lo largo de la ventana (~0.01 pH)
+#define PH_SETTLE_MAX_NOISE_MV 3.0f           // Desviación típica máxima respecto a la recta
 
 // Configuración del sensor DFRobot
 #define PH_REFERENCE_VOLTAGE 3.3f             // Voltaje de referencia ADC (3.3V para ESP32)
@@ -103,7 +103,44 @@ bool recoveryGPS();
 void scanWiFi();
 
 #ifdef HAS_PMU
-extern XPowersLibInterface *PMU;
+#if PMU_MODEL == PMU_MODEL_PROBE
+// Modelo detectado en beginPower(): llamadas a través de la interfaz virtual
+typedef XPowersLibInterface PmuDriver;
+#define PMU_IS_AXP192()  (PMU->getChipModel() == XPOWERS_AXP192)
+#define PMU_IS_AXP2101() (PMU->getChipModel() == XPOWERS_AXP2101)
+#else
+/**
+ * @brief Driver del PMU fijado en compilación
+ *
+ * Clase final sobre la del chip: las llamadas a través de PMU no pasan por
+ * la vtable de XPowersLibInterface y los accesos a registros de XPowersLib
+ * se pueden alinear.
+ */
+template <class Chip>
+class PmuFixed final : public Chip {
+public:
+    // Público en XPowersLibInterface pero protegido en las clases de chip
+    using Chip::enablePowerOutput;
+    using Chip::disablePowerOutput;
+    using Chip::isPowerChannelEnable;
+    using Chip::setPowerChannelVoltage;
+    using Chip::getPowerChannelVoltage;
+};
+#if PMU_MODEL == PMU_MODEL_AXP2101
+typedef PmuFixed<XPowersAXP2101> PmuDriver;
+#define PMU_FIXED_ADDRESS AXP2101_SLAVE_ADDRESS
+#define PMU_FIXED_NAME "AXP2101"
+#elif PMU_MODEL == PMU_MODEL_AXP192
+typedef PmuFixed<XPowersAXP192> PmuDriver;
+#define PMU_FIXED_ADDRESS AXP192_SLAVE_ADDRESS
+#define PMU_FIXED_NAME "AXP192"
+#else
+#error "PMU_MODEL desconocido (PMU_MODEL_PROBE, PMU_MODEL_AXP192 o PMU_MODEL_AXP2101)"
+#endif
+#define PMU_IS_AXP192()  (PMU_MODEL == PMU_MODEL_AXP192)
+#define PMU_IS_AXP2101() (PMU_MODEL == PMU_MODEL_AXP2101)
+#endif
+extern PmuDriver *PMU;
 extern bool pmuInterrupt;
 void loopPMU(void (*pressed_cb)(void));
 bool beginPower();
@@ -160,3 +197,11 @@ float readBatteryVoltage();
  * @return Porcentaje estimado (0-100).
  */
 uint8_t batteryPercentFromVoltage(float voltage);
+
+/**
+ * @brief Recalibra el reloj lento del RTC frente al cristal principal.
+ *        Actualiza la calibración con la que se cuenta el tiempo en sueño profundo.
+ *
+ * @return Periodo del reloj lento (us << 19), 0 si la calibración falla.
+ */
+uint32_t calibrateSlowClock();
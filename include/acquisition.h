@@ -0,0 +1,86 @@
+/**
+ * @file      acquisition.h
+ * @brief     Adquisición y codificación del ciclo, separadas de la MAC LoRaWAN
+ *
+ * Una tarea hace todo lo que no es radio: inicializa y lee los sensores,
+ * guarda la lectura en la SD, aplica la política de envío (o añade la
+ * muestra a la ventana de estadísticas) y deja el payload codificado. El
+ * resultado llega a la MAC por una cola sin bloqueos (spsc_queue.h).
+ *
+ * Con DUAL_CORE_ENABLE la tarea corre en DUAL_CORE_ACQ_CORE mientras
+ * loop() sigue despachando LMIC en el otro núcleo: las esperas de los
+ * sensores y la escritura en la SD ya no retrasan las ventanas RX y el
+ * join avanza mientras se mide. Sin él, acquisitionStart() hace el mismo
+ * trabajo en el núcleo que la llama y el resultado ya está disponible al
+ * volver.
+ *
+ * La tarea no toca ni LMIC ni la pantalla; de eso se encarga la MAC al
+ * recibir el resultado.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef ACQUISITION_H
+#define ACQUISITION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config/config.h"
+#include "sensor_interface.h"
+
+// Payload más grande de los dos formatos (lectura instantánea o resumen de ventana)
+#define ACQ_PAYLOAD_MAX (PAYLOAD_SIZE_BYTES > STATS_PAYLOAD_SIZE ? PAYLOAD_SIZE_BYTES : STATS_PAYLOAD_SIZE)
+
+/**
+ * @brief Resultado de un ciclo de adquisición
+ */
+typedef struct {
+    sensor_data_t data;
+    bool sensorsOk;         /**< sensors_init_all() encontró todos los sensores */
+    bool dataOk;            /**< La lectura es válida */
+    bool send;              /**< La política decidió enviar este ciclo */
+    uint8_t port;           /**< FPort del payload */
+    uint8_t payloadSize;    /**< 0 si falló la codificación */
+    uint8_t payload[ACQ_PAYLOAD_MAX];
+    uint32_t elapsedMs;     /**< Duración de la adquisición */
+} acquisition_result_t;
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Lanza la adquisición del ciclo
+ *
+ * Con DUAL_CORE_ENABLE crea la tarea en DUAL_CORE_ACQ_CORE y vuelve al
+ * momento; si no hay memoria para la tarea, o sin DUAL_CORE_ENABLE, la
+ * hace aquí mismo.
+ */
+void acquisitionStart();
+
+/**
+ * @brief Recoge el resultado si ya está listo (solo desde la MAC)
+ *
+ * @return true si se copió un resultado
+ */
+bool acquisitionPoll(acquisition_result_t* result);
+
+/**
+ * @brief Indica si la adquisición sigue en marcha
+ *
+ * No se debe dormir mientras tanto: la tarea puede estar escribiendo en
+ * la SD o en el estado RTC.
+ */
+bool acquisitionBusy();
+
+/**
+ * @brief Indica si el resultado puede decidir no enviar nada
+ *
+ * Solo ocurre con el envío por excepción sin resúmenes por ventana; en
+ * ese caso conviene no empezar el join hasta conocer la decisión.
+ */
+bool acquisitionMaySkipUplink();
+
+#endif // ACQUISITION_H
@@ -0,0 +1,81 @@
+/**
+ * @file      adc_scan.h
+ * @brief     Barrido único y calibrado de todas las entradas analógicas
+ *
+ * El pH (GPIO25), la batería (ADC_PIN) y la NTC (NTC_PIN) se leían cada
+ * uno con su propio bucle de analogRead() y sus esperas. Aquí se leen
+ * todas juntas en un barrido corto: las muestras de los canales se
+ * intercalan (pH, batería, NTC, pH, batería...) sin esperas entre ellas,
+ * cada canal se filtra con una media recortada (se descartan el cuarto más
+ * bajo y el cuarto más alto) y el resultado se convierte a mV con la
+ * calibración de fábrica del eFuse, caracterizada una sola vez por unidad
+ * y atenuación.
+ *
+ * Una nueva sonda analógica (conductividad, turbidez, oxígeno disuelto) se
+ * añade con una entrada en adc_scan_input_t y otra en la tabla de
+ * adc_scan.cpp y entra en el mismo barrido sin alargar el despertar.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef ADC_SCAN_H
+#define ADC_SCAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config/config.h"
+
+/**
+ * @brief Entradas analógicas del barrido
+ */
+typedef enum {
+    ADC_SCAN_PH = 0,        /**< Sonda de pH DFRobot */
+    ADC_SCAN_BATTERY,       /**< Divisor de la batería */
+    ADC_SCAN_NTC,           /**< Termistor de la placa */
+    ADC_SCAN_INPUT_COUNT
+} adc_scan_input_t;
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Hace un barrido de todas las entradas presentes en la placa
+ *
+ * @return Número de entradas con lectura válida
+ */
+uint8_t adcScanRun();
+
+/**
+ * @brief Tensión filtrada y calibrada de una entrada
+ *
+ * Reutiliza el último barrido si no tiene más de maxAgeMs; si no, lanza
+ * uno nuevo (que actualiza todas las entradas).
+ *
+ * @param input Entrada a consultar
+ * @param maxAgeMs Antigüedad máxima aceptada (0 = barrer siempre)
+ * @return Tensión en mV; NAN si la entrada no existe o no se pudo leer
+ */
+float adcScanMillivolts(adc_scan_input_t input, uint32_t maxAgeMs);
+
+/**
+ * @brief Unidad y canal ADC de una entrada (configura atenuación y ancho)
+ *
+ * Para quien lee el canal fuera del barrido (wake stub, ULP).
+ *
+ * @param unit Salida: 1 o 2
+ * @param channel Salida: canal dentro de la unidad
+ * @return false si la entrada no existe en la placa
+ */
+bool adcScanChannel(adc_scan_input_t input, uint8_t* unit, uint8_t* channel);
+
+/**
+ * @brief Convierte a mV una lectura cruda de 12 bits de una entrada
+ *
+ * @return Tensión en mV con la calibración del eFuse; NAN si la entrada no existe
+ */
+float adcScanRawToMillivolts(adc_scan_input_t input, uint16_t raw);
+
+#endif // ADC_SCAN_H
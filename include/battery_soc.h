@@ -0,0 +1,81 @@
+/**
+ * @file      battery_soc.h
+ * @brief     Estado de carga de la batería para el payload y las políticas
+ *
+ * batteryPercentFromVoltage() reparte linealmente 3.0-4.1 V sin
+ * compensar la carga ni la temperatura, así que el porcentaje salta con
+ * cada pico de corriente. Con BATTERY_SOC_ENABLE:
+ *
+ *   - Con AXP2101 y batería presente se usa su medidor de carga (registro
+ *     0xA4), que integra la corriente de la celda en el propio chip.
+ *   - Sin él se usa soc_estimator: recuento del consumo estimado por fase
+ *     (sueño, despierto y TX, con las corrientes de config.h) corregido con
+ *     la curva OCV de la tensión medida en cada ciclo.
+ *
+ * El estado vive en memoria RTC (retained_state). La duración del sueño
+ * se mide con el reloj del sistema, que sigue contando durante el sueño
+ * profundo y los despertares del stub y del ULP. Mientras entra VBUS y la
+ * batería carga no se cuenta consumo; la siguiente lectura sin carga
+ * resincroniza con la OCV.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef BATTERY_SOC_H
+#define BATTERY_SOC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config/config.h"
+
+/**
+ * @brief Origen de la última estimación
+ */
+typedef enum {
+    BATTERY_SOC_NONE = 0,   /**< Sin estimación: porcentaje lineal por tensión */
+    BATTERY_SOC_GAUGE,      /**< Medidor de carga del AXP2101 */
+    BATTERY_SOC_ESTIMATED   /**< Curva OCV y recuento de carga */
+} battery_soc_source_t;
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Actualiza la estimación con la lectura del ciclo
+ *
+ * Llamar una vez por ciclo, tras leer la batería.
+ *
+ * @param volts Tensión de batería medida (0 = sin lectura)
+ * @param tempC Temperatura ambiente, si el PMU no da la suya (NAN si no hay)
+ */
+void batterySocUpdate(float volts, float tempC);
+
+/**
+ * @brief Suma el tiempo en aire de un uplink al consumo del ciclo
+ */
+void batterySocAddTx(uint32_t airtimeMs);
+
+/**
+ * @brief Cierra el consumo del despertar y anota el inicio del sueño
+ *
+ * Llamar justo antes de retainedSealAll() en cada camino a sueño profundo.
+ */
+void batterySocOnSleep();
+
+/**
+ * @brief Estado de carga para el payload y las políticas de energía
+ *
+ * @param voltage Tensión de batería, para el porcentaje lineal si no hay estimación
+ * @return Porcentaje 0-100
+ */
+uint8_t batterySocPercent(float voltage);
+
+/**
+ * @brief Origen del valor que devuelve batterySocPercent()
+ */
+battery_soc_source_t batterySocSource();
+
+#endif // BATTERY_SOC_H
@@ -0,0 +1,55 @@
+/**
+ * @file      clock_calibration.h
+ * @brief     Calibración del error de reloj para dimensionar las ventanas RX1/RX2
+ *
+ * Mide el desfase real entre el inicio esperado de un downlink (txend +
+ * retardo de la ventana) y el inicio observado por la radio, lo convierte
+ * al formato de LMIC_setClockError() y lo guarda en NVS por dispositivo.
+ * Las ventanas de recepción se dimensionan a partir de esa medida con un
+ * margen de seguridad en lugar de asumir un 1% fijo. También informa del
+ * tiempo que el receptor ha estado encendido en cada ciclo.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef CLOCK_CALIBRATION_H
+#define CLOCK_CALIBRATION_H
+
+#include <stdint.h>
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Carga de NVS el error de reloj calibrado
+ */
+void clockCalInit();
+
+/**
+ * @brief Aplica el error de reloj a LMIC (llamar después de LMIC_reset())
+ */
+void clockCalApply();
+
+/**
+ * @brief Actualiza la calibración con el downlink recién recibido
+ *
+ * Llamar en EV_JOINED y en EV_TXCOMPLETE cuando se haya recibido una trama.
+ */
+void clockCalOnDownlink();
+
+/**
+ * @brief Ensancha las ventanas tras un ciclo de join sin respuesta
+ */
+void clockCalOnJoinFailed();
+
+/**
+ * @brief Imprime el tiempo de receptor encendido acumulado y lo reinicia
+ * @param label Etiqueta del ciclo (join, uplink...)
+ * @return Milisegundos con el receptor encendido
+ */
+uint32_t clockCalReportRxOn(const char* label);
+
+#endif // CLOCK_CALIBRATION_H
@@ -0,0 +1,73 @@
+/**
+ * @file      cpu_phase.h
+ * @brief     Frecuencia de CPU según la fase del despertar
+ *
+ * Casi todo el despertar es espera: la conversión del DS18B20, el bucle
+ * de muestreo del pH, el join y las ventanas RX. Con CPU_PM_ENABLE el
+ * gestor de energía de ESP-IDF (esp_pm) deja la CPU en CPU_PM_MIN_MHZ y
+ * solo sube a CPU_PM_MAX_MHZ mientras alguna fase de cálculo está activa:
+ *
+ *   - CPU_PHASE_LMIC: el HAL de LMIC la abre cuando hay un trabajo
+ *     ejecutable o a punto de vencer, o un flanco en DIO (cifrado AES,
+ *     MIC y arranque de TX/RX), y la cierra cuando LMIC queda ocioso.
+ *   - CPU_PHASE_ENCODE: codificación del payload en la adquisición.
+ *
+ * Los tiempos de LMIC no dependen de la frecuencia: micros() y
+ * delayMicroseconds() van sobre esp_timer, que no cambia con el reloj de
+ * la CPU. Con CPU_PM_LIGHT_SLEEP el sueño ligero automático se cuenta
+ * como tiempo a frecuencia mínima.
+ *
+ * Si el SDK no trae CONFIG_PM_ENABLE se cambia la frecuencia con
+ * setCpuFrequencyMhz() en las mismas transiciones.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef CPU_PHASE_H
+#define CPU_PHASE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config/config.h"
+
+/**
+ * @brief Fases que necesitan la frecuencia máxima
+ */
+typedef enum {
+    CPU_PHASE_LMIC = 0,     /**< Trabajos de LMIC (solo desde el HAL) */
+    CPU_PHASE_ENCODE,       /**< Codificación del payload */
+    CPU_PHASE_COUNT
+} cpu_phase_t;
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Configura el gestor de energía y baja a la frecuencia mínima
+ *
+ * Llamar una vez al principio de setup(), con Serial ya iniciado.
+ */
+void cpuPhaseInit();
+
+/**
+ * @brief Abre una fase de cálculo (frecuencia máxima mientras dure)
+ *
+ * Cada fase se abre y se cierra desde una sola tarea; repetir la llamada
+ * con la fase ya abierta no hace nada.
+ */
+void cpuPhaseBegin(cpu_phase_t phase);
+
+/**
+ * @brief Cierra una fase de cálculo
+ */
+void cpuPhaseEnd(cpu_phase_t phase);
+
+/**
+ * @brief Imprime el tiempo pasado a cada frecuencia desde cpuPhaseInit()
+ */
+void cpuPhaseReport();
+
+#endif // CPU_PHASE_H
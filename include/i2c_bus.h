@@ -0,0 +1,135 @@
+/**
+ * @file      i2c_bus.h
+ * @brief     Gestor del bus I2C compartido por el PMU, el BME280 y el OLED
+ *
+ * Los tres dispositivos comparten Wire (GPIO21/22) y cada librería lanzaba
+ * sus transacciones sin coordinarse y al reloj que le tocara. El gestor:
+ *
+ *   - Serializa los accesos con un mutex recursivo; cada dispositivo tiene
+ *     su velocidad de reloj y Wire.setClock() solo se llama al cambiar.
+ *   - Ofrece lecturas/escrituras en ráfaga de registros consecutivos
+ *     (repeated start, una sola transacción), que usan las callbacks de
+ *     XPowersLib para el PMU.
+ *   - Encola las escrituras del display (callback de bytes de U8g2): una
+ *     tarea las vacía en segundo plano, así que sendBuffer() vuelve al
+ *     momento y una lectura de sensor se intercala entre dos bloques en
+ *     vez de esperar al refresco completo de 1 KB.
+ *
+ * Con I2C_BUS_ENABLE a false, o antes de i2cBusBegin(), todas las funciones
+ * operan directamente sobre Wire sin bloqueo ni cola.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config/config.h"
+
+class TwoWire;
+struct u8x8_struct;
+
+// Dispositivos con velocidad de reloj propia
+#define I2C_BUS_MAX_DEVICES 8
+
+// Bytes por escritura encolada (U8g2 parte los datos en bloques de 24)
+#define I2C_BUS_JOB_BYTES 32
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Toma el control del bus y arranca la tarea de escrituras en cola
+ *
+ * @param wire Bus ya inicializado con Wire.begin()
+ * @return true si el gestor queda activo
+ */
+bool i2cBusBegin(TwoWire& wire);
+
+/**
+ * @brief true si el gestor está activo sobre este bus
+ */
+bool i2cBusOwns(const TwoWire* wire);
+
+/**
+ * @brief Fija la velocidad de reloj de un dispositivo
+ *
+ * @param address Dirección de 7 bits
+ * @param clockHz Frecuencia de SCL
+ */
+void i2cBusSetClock(uint8_t address, uint32_t clockHz);
+
+/**
+ * @brief Reserva el bus para una secuencia de transacciones con un dispositivo
+ *
+ * Recursivo: se puede anidar desde la misma tarea. Aplica el reloj del
+ * dispositivo si lo tiene registrado.
+ *
+ * @param address Dirección de 7 bits (0 = no cambiar el reloj)
+ * @return false si el bus no quedó libre en I2C_BUS_TIMEOUT_MS
+ */
+bool i2cBusLock(uint8_t address);
+
+/**
+ * @brief Libera una reserva de i2cBusLock()
+ */
+void i2cBusUnlock();
+
+/**
+ * @brief Lee registros consecutivos en una sola transacción
+ *
+ * @return true si el dispositivo respondió con todos los bytes
+ */
+bool i2cBusReadRegs(uint8_t address, uint8_t reg, uint8_t* buf, uint8_t len);
+
+/**
+ * @brief Escribe registros consecutivos en una sola transacción
+ */
+bool i2cBusWriteRegs(uint8_t address, uint8_t reg, const uint8_t* buf, uint8_t len);
+
+/**
+ * @brief Encola una escritura sin esperar a que se transmita
+ *
+ * Si la cola está llena espera hueco hasta I2C_BUS_TIMEOUT_MS.
+ *
+ * @param len Como máximo I2C_BUS_JOB_BYTES
+ */
+bool i2cBusWriteAsync(uint8_t address, const uint8_t* data, uint8_t len);
+
+/**
+ * @brief Espera a que se vacíe la cola de escrituras (antes de dormir)
+ *
+ * @return false si no se vació en timeoutMs
+ */
+bool i2cBusFlush(uint32_t timeoutMs);
+
+/**
+ * @brief Tiempo acumulado de transacciones en el bus desde el arranque (us)
+ */
+uint32_t i2cBusTimeUs();
+
+/**
+ * @brief Callback de lectura para XPowersLib (iic_fptr_t)
+ *
+ * @return 0 si la lectura fue correcta, -1 en caso contrario
+ */
+int i2cBusReadCallback(uint8_t address, uint8_t reg, uint8_t* data, uint8_t len);
+
+/**
+ * @brief Callback de escritura para XPowersLib (iic_fptr_t)
+ */
+int i2cBusWriteCallback(uint8_t address, uint8_t reg, uint8_t* data, uint8_t len);
+
+/**
+ * @brief Callback de bytes de U8g2 que encola cada transferencia del display
+ *
+ * Sustituye a u8x8_byte_arduino_hw_i2c (u8x8->byte_cb).
+ */
+uint8_t i2cBusU8x8Byte(struct u8x8_struct* u8x8, uint8_t msg, uint8_t argInt, void* argPtr);
+
+#endif // I2C_BUS_H
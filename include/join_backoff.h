@@ -0,0 +1,66 @@
+/**
+ * @file      join_backoff.h
+ * @brief     Máquina de estados de reintentos de join OTAA persistida en RTC
+ *
+ * Guarda en memoria RTC (sobrevive al sueño profundo y a reinicios por
+ * watchdog) el estado de los reintentos de join: número de ciclos fallidos,
+ * DR en curso, DevNonce y tiempo en aire acumulado. Calcula el siguiente
+ * backoff exponencial con jitter respetando los límites de join-request de
+ * LoRaWAN 1.0.x (36 s/h la primera hora, 36 s/10 h hasta la hora 11 y
+ * 8.7 s/24 h a partir de entonces).
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef JOIN_BACKOFF_H
+#define JOIN_BACKOFF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Valida el estado RTC al arrancar (lo reinicia tras un power-on)
+ */
+void joinBackoffInit();
+
+/**
+ * @brief Aplica el estado persistido a LMIC tras LMIC_reset()/LMIC_startJoining()
+ *
+ * Restaura el DevNonce y, si el ciclo anterior quedó interrumpido, salta
+ * un DevNonce (el guardado pudo llegar a enviarse) y reanuda el join en el
+ * último DR usado en lugar del DR inicial ya fijado en LMIC.
+ */
+void joinBackoffApply();
+
+/**
+ * @brief Registra el DR y DevNonce en curso mientras LMIC está haciendo join
+ *
+ * Barato: solo escribe en RTC cuando alguno de los valores cambia. No hace
+ * nada hasta joinBackoffApply(), para no pisar el DevNonce guardado en un
+ * arranque que no llega a hacer join.
+ */
+void joinBackoffTrack();
+
+/**
+ * @brief Procesa un EV_JOIN_FAILED y calcula el tiempo de sueño profundo
+ * @return Segundos a dormir antes del siguiente ciclo de join
+ */
+uint32_t joinBackoffOnFailed();
+
+/**
+ * @brief Procesa un EV_JOINED: reinicia contadores manteniendo el DevNonce
+ */
+void joinBackoffOnJoined();
+
+/**
+ * @brief Número de ciclos de join fallidos consecutivos
+ */
+uint8_t joinBackoffAttempts();
+
+#endif // JOIN_BACKOFF_H
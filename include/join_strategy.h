@@ -0,0 +1,49 @@
+/**
+ * @file      join_strategy.h
+ * @brief     Aprendizaje del data rate de join OTAA persistido en NVS
+ *
+ * Recuerda el DR y el canal con los que se obtuvo el último EV_JOINED,
+ * junto con el RSSI/SNR del join-accept, para empezar el siguiente join en
+ * frío directamente en ese DR en vez de recorrer SF7..SF12. Una política de
+ * decaimiento prueba de vez en cuando un DR más rápido y olvida el DR
+ * aprendido tras varios ciclos fallidos.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef JOIN_STRATEGY_H
+#define JOIN_STRATEGY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Carga de NVS el último join exitoso
+ */
+void joinStrategyInit();
+
+/**
+ * @brief Ajusta DR y canal de LMIC tras LMIC_startJoining()
+ *
+ * Debe llamarse después de LMIC_startJoining(), que fija SF7 y un canal
+ * aleatorio, y antes de que se ejecute el primer trabajo de LMIC.
+ */
+void joinStrategyApply();
+
+/**
+ * @brief Registra en NVS el DR, canal, RSSI y SNR del join exitoso
+ */
+void joinStrategyOnJoined();
+
+/**
+ * @brief Registra un ciclo de join fallido (política de olvido)
+ */
+void joinStrategyOnFailed();
+
+#endif // JOIN_STRATEGY_H
@@ -0,0 +1,77 @@
+/**
+ * @file      net_time.h
+ * @brief     Hora UTC de red (DeviceTimeReq) conservada durante el sueño profundo
+ *
+ * La hora se pide a la red con el comando MAC DeviceTimeReq (LoRaWAN 1.0.3)
+ * y se fija en el reloj del sistema, que sigue contando con el RTC durante
+ * el sueño profundo. Tras cada sincronización se acota el error acumulado
+ * por la deriva del reloj lento; solo se vuelve a pedir la hora cuando esa
+ * cota supera NET_TIME_MAX_ERROR_MS, así que la mayoría de los uplinks no
+ * llevan comandos MAC adicionales.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef NET_TIME_H
+#define NET_TIME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Marca compacta de una muestra sin hora de red
+#define NET_TIME_COMPACT_UNKNOWN 0xFFFF
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Valida el estado RTC de la hora de red al arrancar
+ */
+void netTimeInit();
+
+/**
+ * @brief Indica si el próximo uplink debe pedir la hora a la red
+ *
+ * @return true si nunca se sincronizó o la cota de error supera el límite
+ */
+bool netTimeNeedsSync();
+
+/**
+ * @brief Procesa la respuesta DeviceTimeAns tras un uplink
+ *
+ * Llamar en EV_TXCOMPLETE. Ajusta el reloj del sistema e informa del error
+ * corregido al planificador de despertares.
+ *
+ * @return true si se recibió hora de red en este uplink
+ */
+bool netTimeOnTxComplete();
+
+/**
+ * @brief Hora UTC actual
+ *
+ * @return Segundos desde 1970 (0 si aún no hay hora de red)
+ */
+uint32_t netTimeNow();
+
+/**
+ * @brief Cota del error de la hora actual
+ *
+ * @return Error máximo estimado en ms (UINT32_MAX si no hay hora de red)
+ */
+uint32_t netTimeErrorMs();
+
+/**
+ * @brief Codifica una hora UTC en 2 bytes para el payload
+ *
+ * Unidades de 2 s módulo 65535 (ventana de ~36 h). El servidor reconstruye
+ * la hora completa tomando el valor más cercano a la hora de recepción.
+ *
+ * @param utc Segundos desde 1970 (0 = desconocida)
+ * @return Marca compacta, o NET_TIME_COMPACT_UNKNOWN
+ */
+uint16_t netTimeCompact(uint32_t utc);
+
+#endif // NET_TIME_H
@@ -0,0 +1,123 @@
+/**
+ * @file      onewire_rmt.h
+ * @brief     Bus OneWire sobre el periférico RMT del ESP32
+ *
+ * Sustituye al bit-banging de la librería OneWire, que deshabilita las
+ * interrupciones en cada slot: un reset + MATCH ROM + lectura del
+ * scratchpad bloqueaba la CPU varios milisegundos y podía retrasar a LMIC.
+ * Aquí cada transacción se codifica entera (onewire_rmt_codec) y se entrega
+ * al canal TX del RMT, que genera los tiempos por hardware; un canal RX en
+ * el mismo GPIO captura la línea y la transacción se decodifica al
+ * terminar. Mientras tanto la CPU queda libre y las interrupciones activas.
+ *
+ * owRmtStart() lanza la transacción y vuelve de inmediato; owRmtFinish()
+ * espera su fin (bloqueando solo la tarea, sobre el ringbuffer del RX).
+ *
+ * DallasTemperatureRmt ofrece el subconjunto de DallasTemperature que usa
+ * src/sensor/sensor_ds18b20.cpp para que el driver no cambie.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef ONEWIRE_RMT_H
+#define ONEWIRE_RMT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config/config.h"
+
+#ifndef DEVICE_DISCONNECTED_C
+#define DEVICE_DISCONNECTED_C -127  // Mismo valor que DallasTemperature
+#endif
+
+// Dispositivos como máximo en la búsqueda del bus
+#define OW_RMT_MAX_DEVICES 4
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Configura los canales RMT TX/RX sobre el pin en drenador abierto
+ *
+ * @param pin GPIO del bus (con pull-up externo de 4.7K)
+ * @return true si los canales quedaron instalados
+ */
+bool owRmtBegin(uint8_t pin);
+
+/**
+ * @brief Lanza una transacción sin esperar a que termine
+ *
+ * @param reset Si empieza con un pulso de reset
+ * @param tx Bytes a escribir
+ * @param txBits Bits de tx a escribir (normalmente 8 * bytes)
+ * @param readBits Slots de lectura tras la escritura
+ * @return false si el bus no está listo, hay otra en curso o no cabe
+ */
+bool owRmtStart(bool reset, const uint8_t* tx, uint16_t txBits, uint16_t readBits);
+
+/**
+ * @brief Espera el fin de la transacción en curso y decodifica la lectura
+ *
+ * @param rx Búfer para los bits leídos (LSB primero); NULL si no hay lecturas
+ * @param presence Resultado del presence pulse si hubo reset; puede ser NULL
+ * @return true si la captura es completa
+ */
+bool owRmtFinish(uint8_t* rx, bool* presence);
+
+/**
+ * @brief true si hay una transacción lanzada pendiente de owRmtFinish()
+ */
+bool owRmtBusy();
+
+/**
+ * @brief Transacción completa (owRmtStart() + owRmtFinish())
+ *
+ * @param reset Si empieza con un pulso de reset
+ * @param tx Bytes a escribir
+ * @param txLen Número de bytes a escribir
+ * @param rx Búfer para los bytes leídos
+ * @param rxLen Número de bytes a leer
+ * @return true si hubo presence pulse (cuando hay reset) y la captura es completa
+ */
+bool owRmtTransaction(bool reset, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen);
+
+/**
+ * @brief Busca los dispositivos del bus (SEARCH ROM)
+ *
+ * @param roms Direcciones encontradas
+ * @param maxDevices Capacidad de roms
+ * @return Número de dispositivos con CRC de ROM válido
+ */
+uint8_t owRmtSearch(uint8_t roms[][8], uint8_t maxDevices);
+
+/**
+ * @brief Subconjunto de DallasTemperature sobre el bus RMT
+ *
+ * Mismos nombres y semántica que la librería para las llamadas del driver
+ * DS18B20: las lecturas fallidas devuelven DEVICE_DISCONNECTED_C.
+ */
+class DallasTemperatureRmt {
+public:
+    explicit DallasTemperatureRmt(uint8_t pin);
+
+    void begin();
+    uint8_t getDeviceCount();
+    bool setResolution(uint8_t bits);
+    void setWaitForConversion(bool wait);
+    void requestTemperatures();
+    float getTempCByIndex(uint8_t index);
+
+private:
+    bool selectAndSend(int8_t index, uint8_t command);
+
+    uint8_t pin;
+    uint8_t resolution;
+    bool waitForConversion;
+    uint8_t deviceCount;
+    uint8_t roms[OW_RMT_MAX_DEVICES][8];
+};
+
+#endif // ONEWIRE_RMT_H
@@ -0,0 +1,109 @@
+/**
+ * @file      onewire_rmt_codec.h
+ * @brief     Codificación de transacciones OneWire como símbolos del periférico RMT
+ *
+ * Una transacción OneWire (reset opcional + bytes escritos + slots de
+ * lectura) se traduce a una secuencia de símbolos RMT con la misma
+ * disposición de bits que rmt_item32_t: cada símbolo es un pulso bajo
+ * seguido de la liberación de la línea. Con el pin en drenador abierto el
+ * canal RX, conectado al mismo GPIO, captura la línea real y la
+ * decodificación solo tiene que medir la duración de cada pulso bajo:
+ *
+ *   - El primer pulso tras un reset (60-240 us) es el presence pulse.
+ *   - Un slot de escritura/lectura de '1' baja la línea 6 us; si el esclavo
+ *     responde '0' la mantiene baja y el pulso medido supera
+ *     OW_RMT_READ_THRESHOLD_US.
+ *
+ * No depende de ESP-IDF: se puede compilar y probar en el host.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef ONEWIRE_RMT_CODEC_H
+#define ONEWIRE_RMT_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Tiempos de velocidad estándar en microsegundos (1 tick RMT = 1 us)
+#define OW_RMT_RESET_LOW_US       480   // Pulso de reset
+#define OW_RMT_RESET_RELEASE_US   480   // Espera del presence pulse y recuperación
+#define OW_RMT_SLOT_US            70    // Duración total de un slot
+#define OW_RMT_WRITE1_LOW_US      6     // Bajo para escribir '1' o iniciar una lectura
+#define OW_RMT_WRITE0_LOW_US      60    // Bajo para escribir '0'
+#define OW_RMT_READ_THRESHOLD_US  15    // Pulso más largo que esto en una lectura = '0'
+#define OW_RMT_RESET_MIN_US       400   // Pulso que se reconoce como reset propio
+#define OW_RMT_PRESENCE_MIN_US    60    // Presence pulse válido
+#define OW_RMT_PRESENCE_MAX_US    300
+#define OW_RMT_PRESENCE_WINDOW_US 300   // El presence pulse empieza antes de esto tras el reset
+
+/**
+ * @brief Símbolo RMT (misma disposición que rmt_item32_t)
+ */
+typedef struct {
+    uint32_t duration0 : 15;
+    uint32_t level0 : 1;
+    uint32_t duration1 : 15;
+    uint32_t level1 : 1;
+} onewire_rmt_item_t;
+
+/**
+ * @brief Resultado de decodificar la captura de una transacción
+ */
+typedef struct {
+    bool presence;      /**< Algún dispositivo respondió al reset */
+    uint16_t slots;     /**< Slots reconocidos después del reset */
+} onewire_rmt_decode_t;
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Símbolos necesarios para una transacción
+ *
+ * @param reset Si empieza con un pulso de reset
+ * @param txBits Bits a escribir
+ * @param readBits Slots de lectura a continuación
+ */
+size_t owRmtItemCount(bool reset, size_t txBits, size_t readBits);
+
+/**
+ * @brief Codifica una transacción completa
+ *
+ * @param reset Si empieza con un pulso de reset
+ * @param tx Bits a escribir empaquetados en bytes (LSB primero, como en el bus)
+ * @param txBits Número de bits a escribir
+ * @param readBits Slots de lectura a añadir tras la escritura
+ * @param out Búfer de símbolos
+ * @param maxItems Capacidad de out
+ * @return Símbolos escritos; 0 si no caben
+ */
+size_t owRmtEncode(bool reset, const uint8_t* tx, size_t txBits, size_t readBits,
+                   onewire_rmt_item_t* out, size_t maxItems);
+
+/**
+ * @brief Decodifica la captura RX de una transacción
+ *
+ * @param items Símbolos capturados por el canal RX
+ * @param count Número de símbolos
+ * @param reset Si la transacción empezó con un reset
+ * @param skipSlots Slots de escritura a saltar antes de las lecturas
+ * @param rx Bytes leídos (LSB primero); puede ser NULL si readBits es 0
+ * @param readBits Slots de lectura esperados
+ * @param result Presence pulse y slots reconocidos
+ * @return true si la captura contiene todos los slots esperados
+ */
+bool owRmtDecode(const onewire_rmt_item_t* items, size_t count, bool reset,
+                 size_t skipSlots, uint8_t* rx, size_t readBits,
+                 onewire_rmt_decode_t* result);
+
+/**
+ * @brief CRC-8 de Dallas/Maxim (polinomio x^8 + x^5 + x^4 + 1)
+ */
+uint8_t owCrc8(const uint8_t* data, size_t len);
+
+#endif // ONEWIRE_RMT_CODEC_H
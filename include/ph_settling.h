@@ -0,0 +1,65 @@
+/**
+ * @file      ph_settling.h
+ * @brief     Detección de estabilización del electrodo de pH tras encenderlo
+ *
+ * Tras alimentar la sonda, su tensión deriva hasta estabilizarse. En lugar
+ * de esperar siempre PH_POWER_ON_DELAY_MS, el driver toma una muestra cada
+ * PH_SETTLE_SAMPLE_INTERVAL_MS y este detector ajusta una recta por mínimos
+ * cuadrados a las últimas PH_SETTLE_WINDOW muestras. La lectura se da por
+ * estable cuando lo que avanza la recta a lo largo de la ventana y la
+ * dispersión de las muestras respecto a ella bajan de PH_SETTLE_MAX_DRIFT_MV
+ * y PH_SETTLE_MAX_NOISE_MV, pasado al menos PH_SETTLE_MIN_MS.
+ * PH_POWER_ON_DELAY_MS queda como límite duro.
+ *
+ * Se compara la deriva acumulada en la ventana y no la pendiente sola
+ * porque con una ventana de pocos segundos el ruido del ADC domina la
+ * pendiente por minuto, aunque la sonda ya no se mueva.
+ *
+ * Solo cálculo, sin acceso al hardware.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef PH_SETTLING_H
+#define PH_SETTLING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config/config.h"
+
+/**
+ * @brief Ventana deslizante de muestras (tiempo, tensión)
+ */
+typedef struct {
+    uint32_t timeMs[PH_SETTLE_WINDOW];   /**< Instante de cada muestra desde el encendido */
+    float millivolts[PH_SETTLE_WINDOW];
+    uint8_t count;                       /**< Muestras válidas (hasta PH_SETTLE_WINDOW) */
+    uint8_t next;                        /**< Posición de la próxima muestra */
+    float slopeMvPerMin;                 /**< Pendiente del último ajuste */
+    float noiseMv;                       /**< Desviación típica de los residuos */
+} ph_settling_t;
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Vacía la ventana (llamar al encender la sonda)
+ */
+void phSettlingReset(ph_settling_t* s);
+
+/**
+ * @brief Añade una muestra y evalúa la estabilidad
+ *
+ * Las muestras no numéricas (NAN) se ignoran.
+ *
+ * @param elapsedMs Tiempo desde el encendido
+ * @param millivolts Tensión de la sonda
+ * @return true si la ventana está llena, ha pasado PH_SETTLE_MIN_MS y la
+ *         deriva y el ruido están por debajo de los umbrales
+ */
+bool phSettlingAdd(ph_settling_t* s, uint32_t elapsedMs, float millivolts);
+
+#endif // PH_SETTLING_H
@@ -0,0 +1,63 @@
+/**
+ * @file      pmu_telemetry.h
+ * @brief     Instantánea de los registros del PMU leída en ráfaga
+ *
+ * Cada getter de XPowersLib es una transacción I2C por registro y varios
+ * leen además el estado para validar: una tensión de batería son tres
+ * transacciones, isVbusIn() dos. Aquí se leen de una vez, en dos ráfagas
+ * del AXP2101 (estado 0x00-0x01 y ADC + IRQ 0x34-0x4A), la batería, VBUS,
+ * la tensión del sistema, la temperatura del chip, el estado de carga y
+ * los registros de interrupción. Los consumidores (tensión de batería,
+ * carga solar) leen de la instantánea, que se reutiliza mientras no
+ * supere la antigüedad pedida.
+ *
+ * Con el AXP192 (PMU_MODEL o detectado) la instantánea se llena con los
+ * getters de XPowersLib; el formato para los consumidores es el mismo.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef PMU_TELEMETRY_H
+#define PMU_TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config/config.h"
+
+/**
+ * @brief Lecturas del PMU en un instante
+ */
+typedef struct {
+    uint32_t takenMs;           /**< millis() de la lectura */
+    uint16_t batteryMv;         /**< 0 sin batería */
+    uint16_t vbusMv;            /**< 0 sin VBUS */
+    uint16_t systemMv;
+    float dieTempC;             /**< Temperatura del chip (NAN si no disponible) */
+    bool batteryPresent;
+    bool vbusIn;
+    bool charging;
+    uint8_t chargerStatus;      /**< xpowers_chg_status_t del AXP2101 (0 con AXP192) */
+    uint32_t irqStatus;         /**< Registros de interrupción (INTSTS1..3) */
+} pmu_telemetry_t;
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Instantánea del PMU, releída si tiene más de maxAgeMs
+ *
+ * @param out Copia de la instantánea
+ * @param maxAgeMs Antigüedad máxima aceptada (0 = leer siempre)
+ * @return false si no hay PMU o la lectura falló
+ */
+bool pmuTelemetryRead(pmu_telemetry_t* out, uint32_t maxAgeMs);
+
+/**
+ * @brief Descarta la instantánea (tras cambiar la configuración del PMU)
+ */
+void pmuTelemetryInvalidate();
+
+#endif // PMU_TELEMETRY_H
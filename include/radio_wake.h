@@ -0,0 +1,38 @@
+/**
+ * @file      radio_wake.h
+ * @brief     Arranque en caliente del SX1276 tras un despertar por temporizador
+ *
+ * El SX1276 sigue alimentado durante el sueño profundo del ESP32. Si se deja
+ * en modo sleep antes de dormir, conserva sus registros y al despertar no
+ * hace falta resetearlo ni recalibrarlo: basta con comprobar el registro de
+ * versión y que la temperatura no haya derivado desde la última calibración.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef RADIO_WAKE_H
+#define RADIO_WAKE_H
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Inicializa LMIC y la radio (sustituye a os_init())
+ *
+ * Tras un despertar por temporizador con la radio aparcada usa
+ * os_init_warm(); en cualquier otro caso hace el arranque completo y
+ * registra la temperatura de calibración.
+ */
+void radioWakeInit();
+
+/**
+ * @brief Deja la radio aparcada en sleep para el próximo arranque en caliente
+ *
+ * Llamar justo antes de esp_deep_sleep_start(), con LMIC ya parado.
+ */
+void radioWakePark();
+
+#endif // RADIO_WAKE_H
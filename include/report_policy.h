@@ -0,0 +1,48 @@
+/**
+ * @file      report_policy.h
+ * @brief     Envío por excepción: decide si una lectura merece un uplink
+ *
+ * Compara cada canal con el último valor entregado (guardado en memoria RTC)
+ * usando una banda muerta por canal. Si ningún canal la supera se omite el
+ * join y el uplink de ese ciclo, salvo que se alcance el silencio máximo
+ * (latido) o que el pH cruce los umbrales de alarma, que fuerzan el envío.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef REPORT_POLICY_H
+#define REPORT_POLICY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config/config.h"
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Valida el estado RTC de la política al arrancar
+ */
+void reportPolicyInit();
+
+/**
+ * @brief Decide si la lectura del ciclo debe enviarse
+ *
+ * Si no se envía cuenta el ciclo como silencioso para el latido.
+ *
+ * @param data Lectura del ciclo
+ * @return true si hay que hacer uplink
+ */
+bool reportPolicyShouldSend(const sensor_data_t* data);
+
+/**
+ * @brief Registra como entregada la lectura pasada a reportPolicyShouldSend()
+ *
+ * Llamar en EV_TXCOMPLETE.
+ */
+void reportPolicyOnSent();
+
+#endif // REPORT_POLICY_H
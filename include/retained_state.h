@@ -0,0 +1,119 @@
+/**
+ * @file      retained_state.h
+ * @brief     Registro de bloques de estado en memoria RTC con versión y CRC
+ *
+ * Cada módulo que conserva estado durante el sueño profundo declara un
+ * retained_block_t<T> con RETAINED_STATE() y lo registra al arrancar con
+ * retainedRegister(). El registro valida la cabecera (identificador,
+ * versión de formato, tamaño y CRC-32) y, si no coincide o el arranque es
+ * un power-on, deja el estado a cero para que el módulo fije sus valores
+ * por defecto.
+ *
+ * Los bloques viven en memoria RTC sin inicializar (RTC_NOINIT_ATTR): el
+ * bootloader no la recarga desde flash, así que se conserva en el sueño
+ * profundo y también tras un reinicio por software, watchdog o brown-out.
+ * Los módulos escriben su estado directamente; el CRC se recalcula para
+ * todos los bloques registrados justo antes de dormir (retainedSealAll()).
+ * Un bloque que deba sobrevivir a un reinicio por watchdog a mitad de ciclo
+ * lo sella además con retainedCommit() cuando cambia. No hay accesos a
+ * NVS/flash en el arranque.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef RETAINED_STATE_H
+#define RETAINED_STATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_attr.h>
+
+/**
+ * @brief Identificadores de los bloques registrados (índice en el registro)
+ */
+typedef enum {
+    RETAINED_JOIN_BACKOFF = 0,
+    RETAINED_WAKE_SCHEDULER,
+    RETAINED_RADIO_WAKE,
+    RETAINED_NET_TIME,
+    RETAINED_REPORT_POLICY,
+    RETAINED_WINDOW_STATS,
+    RETAINED_SD_LOGGER,
+    RETAINED_SENSOR_HEALTH,
+    RETAINED_BATTERY_SOC,
+    RETAINED_ID_COUNT
+} retained_id_t;
+
+/**
+ * @brief Cabecera de un bloque retenido
+ */
+typedef struct {
+    uint32_t magic;     /**< RETAINED_MAGIC si la cabecera se escribió alguna vez */
+    uint16_t id;        /**< retained_id_t del bloque */
+    uint16_t version;   /**< Versión del formato del estado */
+    uint16_t size;      /**< sizeof() del estado */
+    uint16_t reserved;
+    uint32_t crc;       /**< CRC-32 de la cabecera (sin este campo) y del estado */
+} retained_header_t;
+
+/**
+ * @brief Bloque retenido: cabecera + estado del módulo
+ */
+template <typename T>
+struct retained_block_t {
+    retained_header_t header;
+    T state;
+};
+
+/**
+ * @brief Declara un bloque retenido en memoria RTC sin inicializar
+ *
+ * Su contenido es indefinido hasta retainedRegister(): no se pone a cero al
+ * arrancar.
+ */
+#define RETAINED_STATE(type, name) static RTC_NOINIT_ATTR retained_block_t<type> name
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Registra un bloque sin tipo (usar retainedRegister())
+ *
+ * @return true si el estado se recuperó; false si se reinició a cero
+ */
+bool retainedRegisterRaw(retained_id_t id, retained_header_t* header, void* state,
+                         uint16_t size, uint16_t version);
+
+/**
+ * @brief Registra un bloque y valida su contenido
+ *
+ * Idempotente: las llamadas siguientes en el mismo arranque devuelven el
+ * resultado de la primera en tiempo constante.
+ *
+ * @param id Identificador del bloque
+ * @param block Bloque declarado con RETAINED_STATE()
+ * @param version Versión del formato; cambiarla descarta el estado guardado
+ * @return true si el estado se recuperó; false si se reinició a cero
+ */
+template <typename T>
+inline bool retainedRegister(retained_id_t id, retained_block_t<T>& block, uint16_t version) {
+    static_assert(sizeof(T) <= UINT16_MAX, "Estado retenido demasiado grande");
+    return retainedRegisterRaw(id, &block.header, &block.state, sizeof(T), version);
+}
+
+/**
+ * @brief Recalcula el CRC de un bloque tras modificarlo
+ */
+void retainedCommit(retained_id_t id);
+
+/**
+ * @brief Recalcula el CRC de todos los bloques registrados
+ *
+ * Llamar justo antes de esp_deep_sleep_start().
+ */
+void retainedSealAll();
+
+#endif // RETAINED_STATE_H
@@ -0,0 +1,47 @@
+/**
+ * @file      sd_logger.h
+ * @brief     Archivo binario de lecturas en la tarjeta SD por bloques de 512 bytes
+ *
+ * Cada lectura se añade como un registro binario de tamaño fijo a un bloque
+ * en memoria RTC; la tarjeta solo se enciende cuando el bloque está lleno y
+ * se escribe de una vez en su sector dentro de un archivo preasignado, que
+ * se usa como buffer circular. Así no hay actualizaciones de la FAT ni
+ * reescrituras parciales de sector por registro.
+ *
+ * Formato de bloque (little-endian, 512 bytes):
+ *   u32 magic "BLOG", u32 secuencia, u8 versión, u8 tamaño de registro,
+ *   u8 número de registros, u8 reservado, u32 reservado,
+ *   registros de SD_LOG_RECORD_SIZE bytes, relleno a 0,
+ *   u32 CRC-32 (IEEE) de los 508 bytes anteriores.
+ *
+ * Tras un corte de alimentación el siguiente bloque se localiza buscando la
+ * secuencia más alta con CRC válido. tools/sd_archive_to_csv.py convierte
+ * el archivo a CSV.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef SD_LOGGER_H
+#define SD_LOGGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config/config.h"
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Añade una lectura al bloque en curso y lo escribe si se llena
+ *
+ * Sin escritura el coste es una copia a memoria RTC; con escritura, un
+ * único bloque de 512 bytes.
+ *
+ * @param data Lectura a archivar
+ */
+void sdLogAppend(const sensor_data_t* data);
+
+#endif // SD_LOGGER_H
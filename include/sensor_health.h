@@ -0,0 +1,93 @@
+/**
+ * @file      sensor_health.h
+ * @brief     Estado de salud de cada sensor y re-sondeo con backoff exponencial
+ *
+ * Cada sensor del registro (por su posición en SensorRegistry) pasa por
+ * tres estados según sus fallos consecutivos de inicialización o lectura:
+ *
+ *   SANO      -> sin fallos
+ *   DEGRADADO -> entre 1 y SENSOR_HEALTH_FAIL_THRESHOLD - 1 fallos seguidos
+ *   CAÍDO     -> SENSOR_HEALTH_FAIL_THRESHOLD fallos seguidos o más
+ *
+ * Un sensor caído no se inicializa ni se lee (sin escaneo I2C, búsqueda
+ * OneWire ni calentamiento) hasta que pasan 1, 2, 4... ciclos de envío,
+ * con un máximo de SENSOR_HEALTH_BACKOFF_MAX_CYCLES; una lectura correcta
+ * lo devuelve a sano. El estado vive en memoria RTC (retained_state).
+ *
+ * Byte de salud del payload (SENSOR_HEALTH_IN_PAYLOAD): 2 bits por sensor
+ * en el orden del registro (bits 0-1 el primero), con el valor de
+ * sensor_health_t. Un sensor sano cuya lectura del ciclo se tomó sin
+ * estabilizar (la sonda de pH al agotar PH_POWER_ON_DELAY_MS) figura como
+ * degradado, sin contar como fallo.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef SENSOR_HEALTH_H
+#define SENSOR_HEALTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config/config.h"
+
+// Sensores como máximo con seguimiento de salud
+#define SENSOR_HEALTH_MAX 8
+
+/**
+ * @brief Estado de salud de un sensor
+ */
+typedef enum {
+    SENSOR_HEALTHY = 0,    /**< Última lectura correcta */
+    SENSOR_DEGRADED = 1,   /**< Fallos recientes, se sigue leyendo cada ciclo */
+    SENSOR_FAILED = 2      /**< Caído: solo se re-sondea al vencer el backoff */
+} sensor_health_t;
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Sensores a sondear en este ciclo de envío
+ *
+ * Llamar una vez por ciclo: descuenta un ciclo del backoff de los sensores
+ * caídos e incluye los que ya deben re-sondearse.
+ *
+ * @param count Número de sensores del registro
+ * @return Máscara con un bit por sensor
+ */
+uint32_t sensorHealthProbeMask(uint8_t count);
+
+/**
+ * @brief Sensores no caídos (para reintentos y despertares de muestreo)
+ *
+ * @param count Número de sensores del registro
+ * @return Máscara con un bit por sensor
+ */
+uint32_t sensorHealthUsableMask(uint8_t count);
+
+/**
+ * @brief Actualiza la salud con el resultado de un ciclo
+ *
+ * @param attempted Sensores que se intentaron leer
+ * @param ok Sensores que devolvieron al menos un valor válido
+ */
+void sensorHealthUpdate(uint32_t attempted, uint32_t ok);
+
+/**
+ * @brief Estado de un sensor
+ *
+ * @param index Posición del sensor en el registro
+ */
+sensor_health_t sensorHealthState(uint8_t index);
+
+/**
+ * @brief Estado de los cuatro primeros sensores empaquetado para el payload
+ *
+ * @param unstable Sensores leídos en este ciclo sin estabilizar (un bit por sensor)
+ * @return 2 bits por sensor, el primero en los bits 0-1
+ */
+uint8_t sensorHealthBits(uint32_t unstable);
+
+#endif // SENSOR_HEALTH_H
@@ -3,7 +3,8 @@
  * @brief     Interfaz genérica para sensores
  *
  * Esta interfaz define las funciones que debe implementar cada sensor,
- * permitiendo cambiar de sensor sin modificar el código principal.
+ * permitiendo cambiar de sensor sin modificar el código principal. Los
+ * sensores se enumeran en sensor_registry.h.
  *
  * Las estructuras de datos están definidas en config.h para facilitar
  * la personalización por parte del usuario.
@@ -26,76 +27,6 @@
 // FUNCIONES DE LA INTERFAZ DEL SENSOR
 // ============================================================================
 
-/**
- * @brief Inicializa el sensor DHT22
- */
-bool sensor_dht22_init(void);
-
-/**
- * @brief Verifica si el sensor DHT22 está disponible
- */
-bool sensor_dht22_is_available(void);
-
-/**
- * @brief Intenta reinicializar el sensor DHT22
- */
-bool sensor_dht22_retry_init(void);
-
-/**
- * @brief Lee todos los datos del sensor DHT22
- */
-bool sensor_dht22_read_all(sensor_data_t* data);
-
-/**
- * @brief Obtiene el payload del sensor DHT22
- */
-uint8_t sensor_dht22_get_payload(payload_config_t* config);
-
-/**
- * @brief Obtiene el nombre del sensor DHT22
- */
-const char* sensor_dht22_get_name(void);
-
-/**
- * @brief Fuerza el estado del sensor DHT22 para testing
- */
-void sensor_dht22_set_available_for_testing(bool available);
-
-/**
- * @brief Inicializa el sensor DHT11
- */
-bool sensor_dht11_init(void);
-
-/**
- * @brief Verifica si el sensor DHT11 está disponible
- */
-bool sensor_dht11_is_available(void);
-
-/**
- * @brief Intenta reinicializar el sensor DHT11
- */
-bool sensor_dht11_retry_init(void);
-
-/**
- * @brief Lee todos los datos del sensor DHT11
- */
-bool sensor_dht11_read_all(sensor_data_t* data);
-
-/**
- * @brief Obtiene el payload del sensor DHT11
- */
-uint8_t sensor_dht11_get_payload(payload_config_t* config);
-
-/**
- * @brief Obtiene el nombre del sensor DHT11
- */
-const char* sensor_dht11_get_name(void);
-
-/**
- * @brief Fuerza el estado del sensor DHT11 para testing
- */
-void sensor_dht11_set_available_for_testing(bool available);
-
 /**
  * @brief Inicializa el sensor DS18B20
  */
@@ -171,6 +102,23 @@ void sensor_ph_set_available_for_testing(bool available);
  */
 void sensor_ph_set_temperature(float temp);
 
+/**
+ * @brief Convierte a pH una lectura cruda de 12 bits del ADC de la sonda
+ *
+ * @return pH compensado en temperatura; NAN si el sensor no está disponible
+ */
+float sensor_ph_from_raw(uint16_t raw);
+
+/**
+ * @brief Tiempo que tardó la sonda de pH en estabilizarse al encenderla (ms)
+ */
+uint32_t sensor_ph_settling_ms(void);
+
+/**
+ * @brief true si la última lectura de pH se tomó con la sonda estabilizada
+ */
+bool sensor_ph_is_stable(void);
+
 /**
  * @brief Inicializa el sensor BME280
  */
@@ -206,76 +154,6 @@ const char* sensor_bme280_get_name(void);
  */
 void sensor_bme280_set_available_for_testing(bool available);
 
-/**
- * @brief Inicializa el sensor HC-SR04
- */
-bool sensor_hcsr04_init(void);
-
-/**
- * @brief Verifica si el sensor HC-SR04 está disponible
- */
-bool sensor_hcsr04_is_available(void);
-
-/**
- * @brief Intenta reinicializar el sensor HC-SR04
- */
-bool sensor_hcsr04_retry_init(void);
-
-/**
- * @brief Lee todos los datos del sensor HC-SR04
- */
-bool sensor_hcsr04_read_all(sensor_data_t* data);
-
-/**
- * @brief Obtiene el payload del sensor HC-SR04
- */
-uint8_t sensor_hcsr04_get_payload(payload_config_t* config);
-
-/**
- * @brief Obtiene el nombre del sensor HC-SR04
- */
-const char* sensor_hcsr04_get_name(void);
-
-/**
- * @brief Fuerza el estado del sensor HC-SR04 para testing
- */
-void sensor_hcsr04_set_available_for_testing(bool available);
-
-/**
- * @brief Inicializa el sensor NONE
- */
-bool sensor_none_init(void);
-
-/**
- * @brief Verifica si el sensor NONE está disponible
- */
-bool sensor_none_is_available(void);
-
-/**
- * @brief Intenta reinicializar el sensor NONE
- */
-bool sensor_none_retry_init(void);
-
-/**
- * @brief Lee todos los datos del sensor NONE
- */
-bool sensor_none_read_all(sensor_data_t* data);
-
-/**
- * @brief Obtiene el payload del sensor NONE
- */
-uint8_t sensor_none_get_payload(payload_config_t* config);
-
-/**
- * @brief Obtiene el nombre del sensor NONE
- */
-const char* sensor_none_get_name(void);
-
-/**
- * @brief Fuerza el estado del sensor NONE para testing
- */
-void sensor_none_set_available_for_testing(bool available);
-
 /**
  * @brief Inicializa todos los sensores habilitados
  */
@@ -296,11 +174,21 @@ bool sensors_retry_init_all(void);
  */
 bool sensors_read_all(sensor_data_t* data);
 
+/**
+ * @brief Lee solo los sensores de agua (DS18B20 y pH) para el muestreo rápido
+ */
+bool sensors_read_water(sensor_data_t* data);
+
 /**
  * @brief Construye el payload con datos de todos los sensores
  */
 uint8_t sensors_get_payload(payload_config_t* config);
 
+/**
+ * @brief Construye el payload a partir de una lectura ya hecha (sin releer sensores)
+ */
+uint8_t sensors_build_payload(const sensor_data_t* data, payload_config_t* config);
+
 /**
  * @brief Obtiene el nombre de los sensores activos
  */
@@ -0,0 +1,456 @@
+/**
+ * @file      sensor_registry.h
+ * @brief     Registro de sensores en tiempo de compilación
+ *
+ * Cada sensor se describe con una estructura de rasgos (traits) que declara
+ * su nombre, los campos de sensor_data_t que rellena, su posición en el
+ * payload, sus tiempos y su alimentación, y que despacha a las funciones
+ * sensor_<nombre>_*() del driver. SensorRegistry es la lista de sensores
+ * habilitados; los bucles de sensor.cpp se generan a partir de ella por
+ * recursión de plantillas, sin llamadas virtuales ni cadenas de #ifdef.
+ * La tabla de campos del payload ordenada por posición (SensorPayload) es
+ * constexpr y su tamaño se comprueba contra PAYLOAD_SIZE_BYTES.
+ *
+ * Cada sensor declara también su periodo y desfase en ciclos de envío; con
+ * SENSOR_MULTIRATE_ENABLE un ciclo solo inicializa y lee los sensores que
+ * tocan, y el calendario se repite cada HYPERPERIOD ciclos (mínimo común
+ * múltiplo de los periodos).
+ *
+ * Para añadir un sensor: escribir su driver (src/sensor/), sus rasgos aquí
+ * y añadir una línea a SensorRegistry.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef SENSOR_REGISTRY_H
+#define SENSOR_REGISTRY_H
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <math.h>
+#include "../config/config.h"
+#include "sensor_interface.h"
+
+/**
+ * @brief Campo de sensor_data_t producido por un sensor
+ *
+ * Todos los campos ocupan 2 bytes en el payload (little-endian).
+ */
+typedef struct {
+    const char* label;    /**< Nombre para el log */
+    size_t offset;        /**< Posición del valor en sensor_data_t */
+    float error;          /**< Valor de lectura fallida */
+    float scale;          /**< Factor de escala al entero del payload */
+    bool isSigned;        /**< true: int16, false: uint16 */
+    bool inPayload;       /**< true si el campo se envía (SYSTEM_HAS_*) */
+    uint8_t slot;         /**< Posición en el payload tras la batería (1 = primero) */
+} sensor_field_t;
+
+// Máscara con todos los sensores del registro
+#define SENSOR_MASK_ALL 0xFFFFFFFFUL
+
+/**
+ * @brief Máximo común divisor (para el hiperperiodo del calendario)
+ */
+constexpr uint32_t sensorGcd(uint32_t a, uint32_t b) {
+    return b == 0 ? a : sensorGcd(b, a % b);
+}
+
+/**
+ * @brief Mínimo común múltiplo de dos periodos
+ */
+constexpr uint32_t sensorLcm(uint32_t a, uint32_t b) {
+    return a / sensorGcd(a, b) * b;
+}
+
+/**
+ * @brief Menor de dos posiciones del payload
+ */
+constexpr uint8_t sensorMinSlot(uint8_t a, uint8_t b) {
+    return a < b ? a : b;
+}
+
+/**
+ * @brief Periodo en ciclos de envío, redondeado y como mínimo uno
+ */
+constexpr uint32_t sensorPeriodCycles(uint32_t seconds) {
+    return seconds < SEND_INTERVAL_SECONDS * 3 / 2 ? 1 : (seconds + SEND_INTERVAL_SECONDS / 2) / SEND_INTERVAL_SECONDS;
+}
+
+/**
+ * @brief Valor de un campo dentro de una lectura
+ */
+inline float sensorFieldValue(const sensor_data_t* data, const sensor_field_t* field) {
+    return *(const float*)((const uint8_t*)data + field->offset);
+}
+
+/**
+ * @brief Secuencia 1..N de índices en tiempo de compilación
+ */
+template <uint8_t... N>
+struct SensorSeq {};
+
+template <uint8_t N, uint8_t... Rest>
+struct SensorSeqUpTo : SensorSeqUpTo<N - 1, N, Rest...> {};
+
+template <uint8_t... Rest>
+struct SensorSeqUpTo<0, Rest...> {
+    typedef SensorSeq<Rest...> type;
+};
+
+/**
+ * @brief Campos de un sensor como tabla, a partir de S::field()
+ */
+template <typename S, typename Seq = typename SensorSeqUpTo<S::FIELD_COUNT>::type>
+struct SensorFields;
+
+template <typename S, uint8_t... N>
+struct SensorFields<S, SensorSeq<N...> > {
+    static constexpr sensor_field_t TABLE[sizeof...(N)] = { S::field(N - 1)... };
+};
+
+template <typename S, uint8_t... N>
+constexpr sensor_field_t SensorFields<S, SensorSeq<N...> >::TABLE[sizeof...(N)];
+
+// ============================================================================
+// RASGOS DE CADA SENSOR
+// ============================================================================
+// Miembros obligatorios:
+//   name(), field(i) (constexpr, i < FIELD_COUNT), FIELD_COUNT, PAYLOAD_BYTES, WARMUP_MS, READ_MS,
+//   POWER_PIN (-1 = alimentación permanente), WATER (se lee en los
+//   despertares de muestreo), PERIOD_CYCLES y PHASE_CYCLES (calendario
+//   multifrecuencia), init(), isAvailable(), retryInit(),
+//   prepare() (antes de leer, con la lectura acumulada), read(),
+//   stable() (la última lectura se tomó con el sensor estabilizado),
+//   setAvailableForTesting()
+
+#ifdef ENABLE_SENSOR_BME280
+struct SensorBme280 {
+    static const uint8_t FIELD_COUNT = 3;
+    static const uint8_t PAYLOAD_BYTES = 2 * (SYSTEM_HAS_TEMPERATURE + SYSTEM_HAS_HUMIDITY + SYSTEM_HAS_PRESSURE);
+    static const uint32_t WARMUP_MS = 100;
+    static const uint32_t READ_MS = 10;
+    static const int8_t POWER_PIN = -1;
+    static const bool WATER = false;
+    static const uint32_t PERIOD_CYCLES = sensorPeriodCycles(SENSOR_PERIOD_BME280_SECONDS);
+    static const uint32_t PHASE_CYCLES = SENSOR_PHASE_BME280_CYCLES;
+
+    static const char* name() { return "BME280"; }
+    static constexpr sensor_field_t field(uint8_t i) {
+        return i == 0 ? sensor_field_t{ "Temperatura exterior (°C)", offsetof(sensor_data_t, temperature), SENSOR_ERROR_TEMPERATURE, 100.0f, true,  SYSTEM_HAS_TEMPERATURE, 2 }
+             : i == 1 ? sensor_field_t{ "Humedad (%)",               offsetof(sensor_data_t, humidity),    SENSOR_ERROR_HUMIDITY,    100.0f, true,  SYSTEM_HAS_HUMIDITY,    4 }
+             :          sensor_field_t{ "Presion (hPa)",             offsetof(sensor_data_t, pressure),    SENSOR_ERROR_PRESSURE,    10.0f,  false, SYSTEM_HAS_PRESSURE,    5 };
+    }
+    static bool init() { return sensor_bme280_init(); }
+    static bool isAvailable() { return sensor_bme280_is_available(); }
+    static bool retryInit() { return sensor_bme280_retry_init(); }
+    static void prepare(const sensor_data_t*) {}
+    static bool read(sensor_data_t* out) { return sensor_bme280_read_all(out); }
+    static bool stable() { return true; }
+    static void setAvailableForTesting(bool available) { sensor_bme280_set_available_for_testing(available); }
+};
+#endif
+
+#ifdef ENABLE_SENSOR_DS18B20
+struct SensorDs18b20 {
+    static const uint8_t FIELD_COUNT = 1;
+    static const uint8_t PAYLOAD_BYTES = 2 * SYSTEM_HAS_TEMP_1M;
+    static const uint32_t WARMUP_MS = DS18B20_USE_POWER_CONTROL ? DS18B20_POWER_ON_DELAY_MS : 100;
+    static const uint32_t READ_MS = DS18B20_CONVERSION_DELAY_MS;
+    static const int8_t POWER_PIN = DS18B20_USE_POWER_CONTROL ? DS18B20_POWER_PIN : -1;
+    static const bool WATER = true;
+    static const uint32_t PERIOD_CYCLES = sensorPeriodCycles(SENSOR_PERIOD_DS18B20_SECONDS);
+    static const uint32_t PHASE_CYCLES = SENSOR_PHASE_DS18B20_CYCLES;
+
+    static const char* name() { return "DS18B20"; }
+    static constexpr sensor_field_t field(uint8_t) {
+        return sensor_field_t{ "Temperatura agua 1m (°C)", offsetof(sensor_data_t, temperature_1m), SENSOR_ERROR_TEMPERATURE, 100.0f, true, SYSTEM_HAS_TEMP_1M, 3 };
+    }
+    static bool init() { return sensor_ds18b20_init(); }
+    static bool isAvailable() { return sensor_ds18b20_is_available(); }
+    static bool retryInit() { return sensor_ds18b20_retry_init(); }
+    static void prepare(const sensor_data_t*) {}
+    static bool read(sensor_data_t* out) { return sensor_ds18b20_read_all(out); }
+    static bool stable() { return true; }
+    static void setAvailableForTesting(bool available) { sensor_ds18b20_set_available_for_testing(available); }
+};
+#endif
+
+#ifdef ENABLE_SENSOR_PH
+struct SensorPh {
+    static const uint8_t FIELD_COUNT = 1;
+    static const uint8_t PAYLOAD_BYTES = 2 * SYSTEM_HAS_PH;
+    static const uint32_t WARMUP_MS = PH_USE_POWER_CONTROL ? PH_POWER_ON_DELAY_MS : 100;
+    static const uint32_t READ_MS = PH_READ_SAMPLES * PH_READ_DELAY_MS;
+    static const int8_t POWER_PIN = PH_USE_POWER_CONTROL ? PH_POWER_PIN : -1;
+    static const bool WATER = true;
+    static const uint32_t PERIOD_CYCLES = sensorPeriodCycles(SENSOR_PERIOD_PH_SECONDS);
+    static const uint32_t PHASE_CYCLES = SENSOR_PHASE_PH_CYCLES;
+
+    static const char* name() { return "pH"; }
+    static constexpr sensor_field_t field(uint8_t) {
+        return sensor_field_t{ "pH", offsetof(sensor_data_t, ph), SENSOR_ERROR_PH, 100.0f, false, SYSTEM_HAS_PH, 1 };
+    }
+    static bool init() { return sensor_ph_init(); }
+    static bool isAvailable() { return sensor_ph_is_available(); }
+    static bool retryInit() { return sensor_ph_retry_init(); }
+    // Compensación de temperatura: la exterior si se leyó (como hasta ahora), si no la del agua
+    static void prepare(const sensor_data_t* acc) {
+        float temp = acc->temperature != SENSOR_ERROR_TEMPERATURE && !isnan(acc->temperature)
+                         ? acc->temperature : acc->temperature_1m;
+        if (temp != SENSOR_ERROR_TEMPERATURE && !isnan(temp)) {
+            sensor_ph_set_temperature(temp);
+        }
+    }
+    static bool read(sensor_data_t* out) { return sensor_ph_read_all(out); }
+    // Sonda sin estabilizar al agotar PH_POWER_ON_DELAY_MS (ph_settling)
+    static bool stable() { return sensor_ph_is_stable(); }
+    static void setAvailableForTesting(bool available) { sensor_ph_set_available_for_testing(available); }
+};
+#endif
+
+// ============================================================================
+// LISTA DE SENSORES
+// ============================================================================
+
+/**
+ * @brief Marca de fin de la lista de sensores
+ */
+struct SensorListEnd {};
+
+/**
+ * @brief Copia a la lectura acumulada los campos válidos de un sensor
+ *
+ * @return true si al menos un campo era válido
+ */
+inline bool sensorMergeFields(const char* name, const sensor_field_t* fields, uint8_t count,
+                              const sensor_data_t* from, sensor_data_t* to) {
+    bool any = false;
+    for (uint8_t i = 0; i < count; i++) {
+        float value = sensorFieldValue(from, &fields[i]);
+        if (value != fields[i].error) {
+            *(float*)((uint8_t*)to + fields[i].offset) = value;
+            Serial.printf("DEBUG: %s %s = %.2f\n", name, fields[i].label, value);
+            any = true;
+        }
+    }
+    return any;
+}
+
+/**
+ * @brief Marca como no leídos (NAN) los campos de un sensor fuera de turno
+ */
+inline void sensorMarkNotRead(const sensor_field_t* fields, uint8_t count, sensor_data_t* data) {
+    for (uint8_t i = 0; i < count; i++) {
+        *(float*)((uint8_t*)data + fields[i].offset) = NAN;
+    }
+}
+
+template <typename... Sensors>
+struct SensorList;
+
+template <>
+struct SensorList<SensorListEnd> {
+    static const uint8_t COUNT = 0;
+    static const uint8_t FIELD_COUNT = 0;
+    static const uint8_t PAYLOAD_BYTES = 0;
+    static const uint32_t WARMUP_MS = 0;
+    static const uint32_t READ_MS = 0;
+    static const uint32_t HYPERPERIOD = 1;
+    static const uint32_t WATER_MASK = 0;
+
+    static uint32_t dueMask(uint32_t) { return 0; }
+    static uint32_t initAll(uint32_t) { return 0; }
+    static bool anyAvailable() { return false; }
+    static bool retryAll(uint32_t) { return false; }
+    static uint32_t readAll(sensor_data_t*, bool, uint32_t, uint32_t) { return 0; }
+    static uint32_t unstableMask(uint32_t) { return 0; }
+    static const char* nameAt(uint8_t) { return "?"; }
+    static constexpr uint8_t payloadFieldCount() { return 0; }
+    static constexpr sensor_field_t payloadField(uint8_t) {
+        return sensor_field_t{ NULL, 0, 0.0f, 0.0f, false, false, 0 };
+    }
+    static constexpr uint8_t nextPayloadSlot(uint8_t) { return 0xFF; }
+    static void appendNames(char*, size_t) {}
+    static void setAvailableForTesting(bool) {}
+};
+
+template <typename S, typename... Rest>
+struct SensorList<S, Rest...> {
+    typedef SensorList<Rest...> Next;
+
+    static const uint8_t COUNT = 1 + Next::COUNT;
+    static const uint8_t FIELD_COUNT = S::FIELD_COUNT + Next::FIELD_COUNT;
+    static const uint8_t PAYLOAD_BYTES = S::PAYLOAD_BYTES + Next::PAYLOAD_BYTES;
+    // Calentamiento en paralelo (el más largo) y lecturas en serie
+    static const uint32_t WARMUP_MS = S::WARMUP_MS > Next::WARMUP_MS ? S::WARMUP_MS : Next::WARMUP_MS;
+    static const uint32_t READ_MS = S::READ_MS + Next::READ_MS;
+    static const uint32_t HYPERPERIOD = sensorLcm(S::PERIOD_CYCLES, Next::HYPERPERIOD);
+    static const uint32_t WATER_MASK = (S::WATER ? 1UL : 0UL) | (Next::WATER_MASK << 1);
+
+    // Las máscaras llevan un bit por sensor, en el orden de la lista (bit 0 = S)
+
+    /**
+     * @brief Sensores que tocan en un ciclo del calendario
+     */
+    static uint32_t dueMask(uint32_t cycle) {
+        uint32_t due = cycle % S::PERIOD_CYCLES == S::PHASE_CYCLES % S::PERIOD_CYCLES ? 1 : 0;
+        return due | (Next::dueMask(cycle) << 1);
+    }
+
+    /**
+     * @brief Inicializa los sensores de la máscara
+     * @return Máscara de los que se inicializaron
+     */
+    static uint32_t initAll(uint32_t mask) {
+        uint32_t ok = 0;
+        if ((mask & 1) && S::init()) {
+            Serial.printf("%s inicializado\n", S::name());
+            ok = 1;
+        }
+        return ok | (Next::initAll(mask >> 1) << 1);
+    }
+
+    static bool anyAvailable() {
+        return S::isAvailable() || Next::anyAvailable();
+    }
+
+    static bool retryAll(uint32_t mask) {
+        bool ok = (mask & 1) && S::retryInit();
+        return Next::retryAll(mask >> 1) || ok;
+    }
+
+    /**
+     * @brief Lee cada sensor en orden y acumula sus campos en data
+     *
+     * @param initFirst true: inicializar cada sensor antes de leerlo
+     * @param dueMask Sensores que tocan; los demás quedan a NAN
+     * @param readMask Sensores que se leen; los que tocan y no se leen
+     *                 (caídos) quedan con su valor de error
+     * @return Máscara de los sensores con al menos un campo válido
+     */
+    static uint32_t readAll(sensor_data_t* data, bool initFirst, uint32_t dueMask, uint32_t readMask) {
+        uint32_t ok = 0;
+        if (!(dueMask & 1)) {
+            sensorMarkNotRead(SensorFields<S>::TABLE, S::FIELD_COUNT, data);
+        } else if (readMask & 1) {
+            sensor_data_t reading = *data;
+            S::prepare(data);
+            if ((!initFirst || S::init()) && S::read(&reading) &&
+                sensorMergeFields(S::name(), SensorFields<S>::TABLE, S::FIELD_COUNT, &reading, data)) {
+                ok = 1;
+            }
+        }
+        return ok | (Next::readAll(data, initFirst, dueMask >> 1, readMask >> 1) << 1);
+    }
+
+    /**
+     * @brief Sensores de la máscara cuya última lectura no estaba estabilizada
+     */
+    static uint32_t unstableMask(uint32_t mask) {
+        uint32_t unstable = (mask & 1) && !S::stable() ? 1 : 0;
+        return unstable | (Next::unstableMask(mask >> 1) << 1);
+    }
+
+    static const char* nameAt(uint8_t index) {
+        return index == 0 ? S::name() : Next::nameAt(index - 1);
+    }
+
+    /**
+     * @brief Campos que van en el payload (constexpr)
+     */
+    static constexpr uint8_t payloadFieldCount(uint8_t i = 0) {
+        return i >= S::FIELD_COUNT ? Next::payloadFieldCount()
+                                   : (S::field(i).inPayload ? 1 : 0) + payloadFieldCount(i + 1);
+    }
+
+    /**
+     * @brief Campo del payload en una posición (constexpr; label NULL si no hay)
+     */
+    static constexpr sensor_field_t payloadField(uint8_t slot, uint8_t i = 0) {
+        return i >= S::FIELD_COUNT ? Next::payloadField(slot)
+             : S::field(i).inPayload && S::field(i).slot == slot ? S::field(i)
+             : payloadField(slot, i + 1);
+    }
+
+    /**
+     * @brief Menor posición ocupada del payload mayor que after (constexpr; 0xFF si no hay)
+     */
+    static constexpr uint8_t nextPayloadSlot(uint8_t after, uint8_t i = 0) {
+        return i >= S::FIELD_COUNT ? Next::nextPayloadSlot(after)
+             : sensorMinSlot(S::field(i).inPayload && S::field(i).slot > after ? S::field(i).slot : 0xFF,
+                             nextPayloadSlot(after, i + 1));
+    }
+
+    static void appendNames(char* buffer, size_t size) {
+        strncat(buffer, S::name(), size - strlen(buffer) - 1);
+        strncat(buffer, " ", size - strlen(buffer) - 1);
+        Next::appendNames(buffer, size);
+    }
+
+    static void setAvailableForTesting(bool available) {
+        S::setAvailableForTesting(available);
+        Next::setAvailableForTesting(available);
+    }
+};
+
+/**
+ * @brief Sensores habilitados, en orden de lectura
+ *
+ * El pH va después de los sensores de temperatura para compensarse con ellos.
+ */
+typedef SensorList<
+#ifdef ENABLE_SENSOR_BME280
+    SensorBme280,
+#endif
+#ifdef ENABLE_SENSOR_DS18B20
+    SensorDs18b20,
+#endif
+#ifdef ENABLE_SENSOR_PH
+    SensorPh,
+#endif
+    SensorListEnd> SensorRegistry;
+
+/**
+ * @brief Posición n-ésima ocupada del payload (1 = la primera; 0xFF si no hay)
+ *
+ * Las posiciones de los campos que no se envían quedan libres: la máscara
+ * de presencia usa el bit (posición - 1).
+ */
+template <typename List>
+constexpr uint8_t sensorPayloadSlot(uint8_t n) {
+    return n == 0 ? 0 : List::nextPayloadSlot(sensorPayloadSlot<List>(n - 1));
+}
+
+/**
+ * @brief Campos del payload ordenados por posición, en tiempo de compilación
+ *
+ * FIELDS[i] es el campo de la posición ocupada i + 1; la tabla termina con
+ * un campo de label NULL.
+ */
+template <typename List, typename Seq = typename SensorSeqUpTo<List::payloadFieldCount()>::type>
+struct SensorPayloadLayout;
+
+template <typename List, uint8_t... N>
+struct SensorPayloadLayout<List, SensorSeq<N...> > {
+    static const uint8_t COUNT = sizeof...(N);
+    static constexpr sensor_field_t FIELDS[sizeof...(N) + 1] = {
+        List::payloadField(sensorPayloadSlot<List>(N))..., List::payloadField(0)
+    };
+};
+
+template <typename List, uint8_t... N>
+constexpr sensor_field_t SensorPayloadLayout<List, SensorSeq<N...> >::FIELDS[sizeof...(N) + 1];
+
+typedef SensorPayloadLayout<SensorRegistry> SensorPayload;
+
+static_assert(sensorPayloadSlot<SensorRegistry>(SensorPayload::COUNT) != 0xFF,
+              "Dos campos del payload con la misma posición");
+// El payload generado desde el registro debe coincidir con el de config.h
+static_assert(PAYLOAD_SIZE_BATTERY + PAYLOAD_SIZE_PRESENCE + 2 * SensorPayload::COUNT +
+              PAYLOAD_SIZE_TIMESTAMP + PAYLOAD_SIZE_HEALTH == PAYLOAD_SIZE_BYTES,
+              "SensorPayload y PAYLOAD_SIZE_BYTES no coinciden");
+
+#endif // SENSOR_REGISTRY_H
@@ -0,0 +1,92 @@
+/**
+ * @file      soc_estimator.h
+ * @brief     Estimación del estado de carga: curva OCV y recuento de carga
+ *
+ * La tensión en bornes de una celda Li-Ion bajo carga no es su tensión en
+ * circuito abierto (OCV): cae I·R_int, y R_int crece con el frío. Con
+ * 45 mA y 150 mΩ son ~7 mV, con los picos de TX bastante más, y en la
+ * zona plana de la curva (40-70 %) 7 mV son varios puntos de carga.
+ *
+ * Cada paso del estimador:
+ *
+ *   1. Resta la carga consumida desde el paso anterior (mAh estimados por
+ *      fase) respecto a la capacidad nominal.
+ *   2. Compensa la tensión medida con la corriente en el momento de la
+ *      lectura y R_int a la temperatura dada, y la convierte en porcentaje
+ *      con la curva OCV.
+ *   3. Acerca el recuento a la OCV con un peso que baja en la zona plana,
+ *      donde la tensión dice poco de la carga, y que es 1 en el primer
+ *      paso o tras una carga (resincronización).
+ *
+ * No depende de Arduino y se compila en el host para probarlo con curvas
+ * de descarga (de momento sintéticas, ver test/test_soc_estimator).
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef SOC_ESTIMATOR_H
+#define SOC_ESTIMATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Parámetros de la celda
+ */
+typedef struct {
+    uint16_t capacityMah;       /**< Capacidad nominal */
+    uint16_t internalResMohm;   /**< Resistencia interna a 25 °C */
+    float ocvWeight;            /**< Peso de la OCV en la zona de mayor pendiente (0-1) */
+} soc_params_t;
+
+/**
+ * @brief Estado del estimador (se conserva entre ciclos)
+ */
+typedef struct {
+    float percent;              /**< Estado de carga estimado (0-100) */
+    bool valid;                 /**< false hasta el primer paso o tras resincronizar */
+} soc_estimate_t;
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Estado de carga de la curva OCV (interpolación lineal por tramos)
+ *
+ * @param ocvVolts Tensión en circuito abierto
+ * @return Porcentaje 0-100
+ */
+float socFromOcv(float ocvVolts);
+
+/**
+ * @brief Pendiente de la curva OCV en un estado de carga (V por punto)
+ */
+float socOcvSlope(float percent);
+
+/**
+ * @brief Tensión en circuito abierto a partir de la tensión bajo carga
+ *
+ * @param volts Tensión medida en bornes
+ * @param loadMa Corriente en el momento de la medida
+ * @param tempC Temperatura de la celda (NAN = 25 °C; se limita a -20..60 °C)
+ * @param internalResMohm Resistencia interna a 25 °C
+ */
+float socCompensateOcv(float volts, float loadMa, float tempC, uint16_t internalResMohm);
+
+/**
+ * @brief Un paso del estimador
+ *
+ * @param est Estado; si no es válido se toma la OCV tal cual
+ * @param params Parámetros de la celda
+ * @param consumedMah Carga consumida desde el paso anterior
+ * @param volts Tensión medida en bornes (<= 0 = sin lectura, solo recuento)
+ * @param loadMa Corriente durante la medida
+ * @param tempC Temperatura de la celda (NAN = 25 °C)
+ */
+void socEstimatorStep(soc_estimate_t* est, const soc_params_t* params, float consumedMah,
+                      float volts, float loadMa, float tempC);
+
+#endif // SOC_ESTIMATOR_H
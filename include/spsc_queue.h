@@ -0,0 +1,83 @@
+/**
+ * @file      spsc_queue.h
+ * @brief     Cola sin bloqueos de un productor y un consumidor entre núcleos
+ *
+ * Anillo de N huecos (N - 1 útiles) en el que solo el productor escribe
+ * head y solo el consumidor escribe tail. El productor copia el elemento
+ * y después publica head con semántica release; el consumidor lee head
+ * con acquire antes de copiar. En el ESP32 las barreras se traducen en
+ * MEMW y no hace falta ni sección crítica ni mutex: ningún lado puede
+ * bloquear al otro, así que la tarea de la MAC nunca espera a la de
+ * adquisición.
+ *
+ * No depende de ESP-IDF: se puede compilar y probar en el host.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Cola de N huecos de elementos T
+ */
+template <typename T, uint8_t N>
+struct spsc_queue_t {
+    T items[N];
+    uint8_t head;   /**< Próximo hueco a escribir (solo el productor) */
+    uint8_t tail;   /**< Próximo hueco a leer (solo el consumidor) */
+};
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Vacía la cola (antes de arrancar productor y consumidor)
+ */
+template <typename T, uint8_t N>
+inline void spscReset(spsc_queue_t<T, N>& q) {
+    __atomic_store_n(&q.head, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&q.tail, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Encola una copia del elemento (solo desde el productor)
+ *
+ * @return false si la cola está llena
+ */
+template <typename T, uint8_t N>
+inline bool spscPush(spsc_queue_t<T, N>& q, const T& item) {
+    static_assert(N >= 2, "La cola necesita al menos dos huecos");
+    uint8_t head = __atomic_load_n(&q.head, __ATOMIC_RELAXED);
+    uint8_t next = (uint8_t)((head + 1) % N);
+    if (next == __atomic_load_n(&q.tail, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    q.items[head] = item;
+    __atomic_store_n(&q.head, next, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * @brief Desencola el elemento más antiguo (solo desde el consumidor)
+ *
+ * @return false si la cola está vacía
+ */
+template <typename T, uint8_t N>
+inline bool spscPop(spsc_queue_t<T, N>& q, T* item) {
+    uint8_t tail = __atomic_load_n(&q.tail, __ATOMIC_RELAXED);
+    if (tail == __atomic_load_n(&q.head, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    *item = q.items[tail];
+    __atomic_store_n(&q.tail, (uint8_t)((tail + 1) % N), __ATOMIC_RELEASE);
+    return true;
+}
+
+#endif // SPSC_QUEUE_H
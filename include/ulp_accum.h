@@ -0,0 +1,167 @@
+/**
+ * @file      ulp_accum.h
+ * @brief     Acumulación del muestreo ULP: disposición en memoria RTC y programa
+ *
+ * El programa del coprocesador ULP trabaja con palabras de 16 bits en la
+ * memoria RTC lenta. Este módulo fija esa disposición (parámetros que
+ * escribe la CPU, acumuladores que escribe el ULP) y el propio programa,
+ * que en cada muestra hace:
+ *
+ *   1. Batería: última lectura, mínimo, máximo y suma de 32 bits.
+ *   2. pH: lo mismo, más la lectura en el registro de muestras
+ *      (ULP_ACC_W_LOG_BASE + número de muestra).
+ *   3. Cuenta de muestras compartida.
+ *   4. Despierta a la CPU si el pH sale de [PH_LO, PH_HI] (motivo
+ *      ULP_WAKE_THRESHOLD) o si la cuenta llega a WINDOW
+ *      (ULP_WAKE_WINDOW).
+ *
+ * El programa se escribe una sola vez, como tabla de operaciones
+ * (ulpAccumProgram): ulp_sampler.cpp traduce cada una a su macro de
+ * esp32/ulp.h y ulpAccumStep() la interpreta en el host con la aritmética
+ * del ULP (16 bits; las comparaciones son restas cuyo préstamo activa el
+ * flag de desbordamiento). ulpAccumReset() y ulpAccumChannel() los usa
+ * también el firmware para preparar y leer el bloque.
+ *
+ * En el ESP32 el ULP escribe en los 16 bits altos de cada palabra datos de
+ * su PC: toda lectura se enmascara con 0xFFFF.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef ULP_ACCUM_H
+#define ULP_ACCUM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Bloque de datos del ULP en palabras de 32 bits desde el inicio de la memoria RTC lenta,
+// dentro de la zona reservada al coprocesador y detrás del programa
+#define ULP_ACC_DATA_WORD     100
+#define ULP_ACC_PROGRAM_WORDS ULP_ACC_DATA_WORD   // Tamaño máximo del programa
+
+// Palabras del bloque de datos (desplazamiento desde ULP_ACC_DATA_WORD)
+#define ULP_ACC_W_PH_LO      0    // Parámetro: pH crudo mínimo sin despertar
+#define ULP_ACC_W_PH_HI      1    // Parámetro: pH crudo máximo sin despertar
+#define ULP_ACC_W_WINDOW     2    // Parámetro: muestras hasta cerrar la ventana
+#define ULP_ACC_W_LOG_BASE   3    // Parámetro: palabra absoluta del registro de muestras de pH
+#define ULP_ACC_W_COUNT      4    // Muestras tomadas
+#define ULP_ACC_W_REASON     5    // Motivo del último despertar (ulp_wake_reason_t)
+#define ULP_ACC_W_BATTERY    6    // Canal de batería (ULP_ACC_CH_* palabras)
+#define ULP_ACC_W_PH         11   // Canal de pH (ULP_ACC_CH_* palabras)
+#define ULP_ACC_WORDS        16
+
+// Palabras de un canal (desplazamiento desde ULP_ACC_W_BATTERY o ULP_ACC_W_PH)
+#define ULP_ACC_CH_LAST      0
+#define ULP_ACC_CH_MIN       1
+#define ULP_ACC_CH_MAX       2
+#define ULP_ACC_CH_SUM_LO    3
+#define ULP_ACC_CH_SUM_HI    4
+
+// Registros del ULP
+#define ULP_ACC_R0           0
+#define ULP_ACC_R1           1
+#define ULP_ACC_R2           2
+#define ULP_ACC_R3           3
+
+// Canales del ADC de ULP_OP_ADC
+#define ULP_ACC_ADC_BATTERY  0
+#define ULP_ACC_ADC_PH       1
+
+// Etiquetas a partir de esta quedan libres para la traducción
+#define ULP_ACC_LABEL_FREE   64
+
+/**
+ * @brief Operaciones del programa (subconjunto de esp32/ulp.h)
+ */
+typedef enum {
+    ULP_OP_MOVI,    /**< I_MOVI(rd, imm) */
+    ULP_OP_LD,      /**< I_LD(rd, rs, imm): rd = mem[rs + imm] */
+    ULP_OP_ST,      /**< I_ST(rd, rs, imm): mem[rs + imm] = rd */
+    ULP_OP_ADDR,    /**< I_ADDR(rd, rs, rt) */
+    ULP_OP_SUBR,    /**< I_SUBR(rd, rs, rt) */
+    ULP_OP_ADDI,    /**< I_ADDI(rd, rs, imm) */
+    ULP_OP_ADC,     /**< I_ADC(rd, ...) del canal imm (ULP_ACC_ADC_*) */
+    ULP_OP_LABEL,   /**< M_LABEL(imm) */
+    ULP_OP_BX,      /**< M_BX(imm) */
+    ULP_OP_BXF,     /**< M_BXF(imm): salta si la última operación de la ALU desbordó */
+    ULP_OP_WAKE,    /**< Espera a que la CPU duerma, I_WAKE() e I_END() */
+    ULP_OP_HALT     /**< I_HALT() */
+} ulp_op_code_t;
+
+/**
+ * @brief Una operación del programa
+ */
+typedef struct {
+    uint8_t code;       /**< ulp_op_code_t */
+    uint8_t rd;
+    uint8_t rs;
+    uint8_t rt;
+    uint16_t imm;       /**< Inmediato, desplazamiento, canal o etiqueta */
+} ulp_op_t;
+
+/**
+ * @brief Motivo por el que el ULP despertó a la CPU
+ */
+typedef enum {
+    ULP_WAKE_NONE = 0,
+    ULP_WAKE_WINDOW,      /**< Ventana completa (registro de muestras lleno) */
+    ULP_WAKE_THRESHOLD    /**< El pH salió de la banda de alarma */
+} ulp_wake_reason_t;
+
+/**
+ * @brief Resumen de un canal leído del bloque
+ */
+typedef struct {
+    uint16_t count;
+    uint16_t min;       /**< Lectura cruda mínima (0xFFFF sin muestras) */
+    uint16_t max;
+    uint32_t sum;
+    uint16_t last;
+} ulp_accum_channel_t;
+
+// Programa del ULP (ulp_accum.cpp)
+extern const ulp_op_t ulpAccumProgram[];
+extern const size_t ulpAccumProgramLength;
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Prepara el bloque para una ventana nueva
+ *
+ * @param slowMem Inicio de la memoria RTC lenta (palabras de 32 bits)
+ * @param phLo Lectura cruda mínima del pH sin despertar (0 = sin umbral)
+ * @param phHi Lectura cruda máxima del pH sin despertar (0xFFFF = sin umbral)
+ * @param window Muestras hasta cerrar la ventana (1..tamaño del registro)
+ * @param logBase Palabra absoluta del registro de muestras de pH
+ */
+void ulpAccumReset(uint32_t* slowMem, uint16_t phLo, uint16_t phHi, uint16_t window, uint16_t logBase);
+
+/**
+ * @brief Interpreta una ejecución de ulpAccumProgram en el host
+ *
+ * Cada ST deja, como el ULP, datos del PC en los 16 bits altos.
+ *
+ * @param slowMem Memoria RTC lenta completa (el programa escribe en
+ *                ULP_ACC_DATA_WORD.. y en el registro de muestras)
+ * @return Motivo de despertar (ULP_WAKE_NONE si sigue durmiendo)
+ */
+ulp_wake_reason_t ulpAccumStep(uint32_t* slowMem, uint16_t batteryRaw, uint16_t phRaw);
+
+/**
+ * @brief Lee el resumen de un canal
+ *
+ * @param channelWord ULP_ACC_W_BATTERY o ULP_ACC_W_PH
+ */
+void ulpAccumChannel(const uint32_t* slowMem, uint8_t channelWord, ulp_accum_channel_t* out);
+
+/**
+ * @brief Motivo del último despertar registrado en el bloque
+ */
+ulp_wake_reason_t ulpAccumReason(const uint32_t* slowMem);
+
+#endif // ULP_ACCUM_H
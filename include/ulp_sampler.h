@@ -0,0 +1,68 @@
+/**
+ * @file      ulp_sampler.h
+ * @brief     Muestreo de pH y batería con el coprocesador ULP durante el sueño profundo
+ *
+ * Con ULP_SAMPLER_ENABLE la CPU duerme la ventana completa hasta el
+ * uplink y el coprocesador ULP despierta cada ULP_SAMPLER_PERIOD_SECONDS,
+ * convierte el pH y la batería con el SAR ADC, acumula mínimo, máximo y
+ * suma por canal y guarda cada lectura de pH en un registro en memoria
+ * RTC (ver ulp_accum.h). La CPU solo despierta:
+ *
+ *   - por el temporizador del uplink, como siempre;
+ *   - cuando el registro de muestras se llena antes del uplink (se
+ *     atiende como un despertar de muestreo de window_stats);
+ *   - cuando el pH cruza REPORT_PH_ALARM_LOW/HIGH, para enviar la alarma.
+ *
+ * El arranque completo vuelca el registro en la ventana de estadísticas
+ * con la calibración de la sonda, igual que las muestras del wake stub.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef ULP_SAMPLER_H
+#define ULP_SAMPLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config/config.h"
+#include "ulp_accum.h"
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Carga el programa ULP y lo pone a muestrear hasta el próximo uplink
+ *
+ * Llamar antes de esp_deep_sleep_start(), con el sensor de pH ya
+ * inicializado (los umbrales se calculan con su calibración).
+ *
+ * @param untilFullBootSeconds Segundos hasta el despertar del uplink
+ * @return true si el ULP quedó en marcha
+ */
+bool ulpSamplerArm(uint32_t untilFullBootSeconds);
+
+/**
+ * @brief Detiene el temporizador del ULP
+ */
+void ulpSamplerStop();
+
+/**
+ * @brief Motivo del despertar si lo provocó el ULP
+ *
+ * @return ULP_WAKE_NONE si el despertar no fue del ULP
+ */
+ulp_wake_reason_t ulpSamplerWakeReason();
+
+/**
+ * @brief Detiene el ULP y extrae las lecturas de pH de la ventana
+ *
+ * @param raw Buffer de salida (lecturas de 12 bits)
+ * @param maxCount Capacidad del buffer
+ * @return Muestras copiadas
+ */
+uint8_t ulpSamplerTake(uint16_t* raw, uint8_t maxCount);
+
+#endif // ULP_SAMPLER_H
@@ -0,0 +1,72 @@
+/**
+ * @file      wake_scheduler.h
+ * @brief     Alineación de los despertares a ranuras de reloj por dispositivo
+ *
+ * En lugar de dormir un tiempo fijo tras cada transmisión (lo que hace que
+ * la fase de cada boya derive de forma arbitraria), calcula el próximo
+ * despertar para que el uplink caiga en una ranura de reloj:
+ *
+ *   t_uplink = k * SEND_INTERVAL_SECONDS + desfase(DevEUI)
+ *
+ * El desfase se deriva del DevEUI para repartir la flota dentro del
+ * intervalo. Se descuenta el tiempo aprendido entre despertar y uplink y
+ * se corrige la deriva del reloj lento del RTC (recalibración frente al
+ * cristal antes de dormir y estimación de deriva con la hora de red).
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef WAKE_SCHEDULER_H
+#define WAKE_SCHEDULER_H
+
+#include <stdint.h>
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Valida el estado RTC del planificador al arrancar
+ */
+void wakeSchedulerInit();
+
+/**
+ * @brief Registra el instante del uplink para aprender el retardo de arranque
+ *
+ * Llamar justo antes de LMIC_setTxData2().
+ */
+void wakeSchedulerMarkUplink();
+
+/**
+ * @brief Calcula cuánto dormir para que el próximo uplink caiga en su ranura
+ *
+ * Recalibra el reloj lento del RTC y aplica la deriva estimada.
+ *
+ * @return Segundos de sueño profundo
+ */
+uint32_t wakeSchedulerNextSleepSeconds();
+
+/**
+ * @brief Índice de la ranura de envío más cercana a la hora actual
+ *
+ * Cuenta intervalos de SEND_INTERVAL_SECONDS con el reloj del sistema, así
+ * que avanza también durante los ciclos perdidos (backoff de join, envíos
+ * omitidos). Llamar tras wakeSchedulerInit().
+ *
+ * @return Número de ciclo (k de k * intervalo + desfase)
+ */
+uint32_t wakeSchedulerCycleIndex();
+
+/**
+ * @brief Informa de una sincronización con la hora de red
+ *
+ * Estima la deriva del reloj local a partir del error acumulado desde la
+ * sincronización anterior.
+ *
+ * @param localMinusNetworkMs Error del reloj local (local - red) antes de corregirlo
+ */
+void wakeSchedulerOnTimeSync(int32_t localMinusNetworkMs);
+
+#endif // WAKE_SCHEDULER_H
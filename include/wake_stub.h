@@ -0,0 +1,69 @@
+/**
+ * @file      wake_stub.h
+ * @brief     Despertares de solo muestreo resueltos en el wake stub de sueño profundo
+ *
+ * Con resúmenes por ventana (STATS_ENABLE) la mayoría de despertares solo
+ * leen el agua y vuelven a dormir, pero cada uno paga el arranque completo
+ * de IDF/Arduino. Con WAKE_STUB_ENABLE esos despertares los atiende
+ * esp_wake_deep_sleep(), que la ROM ejecuta desde la memoria RTC rápida
+ * antes del bootloader: lee el pH crudo del ADC, lo guarda en un buffer
+ * en memoria RTC, reprograma el temporizador RTC y vuelve a dormir, en
+ * menos de un milisegundo.
+ *
+ * El stub deja seguir el arranque completo cuando se acerca el uplink,
+ * cuando el buffer está lleno o cuando el despertar no es del
+ * temporizador. El arranque completo vacía el buffer en la ventana de
+ * estadísticas (windowStatsAdd()) con la calibración de la sonda.
+ *
+ * El stub no puede encender la sonda ni esperar su estabilización: con
+ * PH_USE_POWER_CONTROL la lectura del stub sería de la sonda apagada.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef WAKE_STUB_H
+#define WAKE_STUB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config/config.h"
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Prepara el stub para los despertares intermedios del próximo sueño
+ *
+ * Configura el canal ADC del pH para leerlo desde el controlador RTC y
+ * mantiene alimentados los periféricos RTC durante el sueño. Llamar
+ * antes de esp_deep_sleep_start().
+ *
+ * @param sampleSeconds Periodo entre muestras del stub
+ * @param untilFullBootSeconds Segundos hasta el despertar que necesita arranque completo
+ * @return true si el stub queda armado
+ */
+bool wakeStubArm(uint32_t sampleSeconds, uint32_t untilFullBootSeconds);
+
+/**
+ * @brief Desarma el stub: el próximo despertar será un arranque completo
+ */
+void wakeStubDisarm();
+
+/**
+ * @brief Extrae las muestras crudas acumuladas por el stub
+ *
+ * @param raw Buffer de salida (lecturas de 12 bits)
+ * @param maxCount Capacidad del buffer
+ * @return Muestras copiadas; el buffer queda vacío
+ */
+uint8_t wakeStubTake(uint16_t* raw, uint8_t maxCount);
+
+/**
+ * @brief Despertares atendidos por el stub desde el último arranque completo
+ */
+uint32_t wakeStubWakeCount();
+
+#endif // WAKE_STUB_H
@@ -0,0 +1,85 @@
+/**
+ * @file      window_stats.h
+ * @brief     Resúmenes estadísticos por ventana de envío (min/max/media/desviación)
+ *
+ * Entre dos uplinks el dispositivo despierta cada STATS_SAMPLE_INTERVAL_SECONDS
+ * solo para muestrear el agua (DS18B20 y pH), sin radio ni pantalla, y
+ * acumula en memoria RTC estadísticas de Welford por canal. Al final de la
+ * ventana se envía un único uplink de resumen en el puerto STATS_FPORT con
+ * mínimo, máximo, media, desviación típica y número de muestras por canal.
+ *
+ * Los despertares de muestreo pueden evitarse: con WAKE_STUB_ENABLE los
+ * atiende el wake stub (wake_stub.h) y con ULP_SAMPLER_ENABLE el
+ * coprocesador ULP muestrea durante el sueño (ulp_sampler.h). En ambos
+ * casos las lecturas de pH se vuelcan en la ventana en windowStatsAdd().
+ *
+ * Payload del resumen (little-endian):
+ *   Byte 0:        Batería (%)
+ *   Por canal (pH, temperatura agua 1m), 9 bytes:
+ *     u8  número de muestras
+ *     i16 mínimo x100, i16 máximo x100, i16 media x100, u16 desviación x100
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef WINDOW_STATS_H
+#define WINDOW_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../config/config.h"
+
+// ============================================================================
+// FUNCIONES PÚBLICAS
+// ============================================================================
+
+/**
+ * @brief Indica si este arranque es solo de muestreo
+ *
+ * @return true si se despertó por temporizador antes del próximo uplink
+ */
+bool windowStatsIsSampleWake();
+
+/**
+ * @brief Muestrea el agua, acumula la muestra y vuelve a dormir
+ *
+ * No retorna. Llamar al principio de setup(), antes de inicializar la placa.
+ */
+void windowStatsSampleAndSleep();
+
+/**
+ * @brief Acumula una lectura completa en la ventana en curso
+ *
+ * @param data Lectura del ciclo (los canales con error se ignoran)
+ */
+void windowStatsAdd(const sensor_data_t* data);
+
+/**
+ * @brief Construye el payload de resumen de la ventana
+ *
+ * @param buffer Buffer de salida (al menos STATS_PAYLOAD_SIZE bytes)
+ * @param maxSize Tamaño del buffer
+ * @param battery Voltaje de batería en V
+ * @return Bytes escritos (0 si el buffer no alcanza)
+ */
+uint8_t windowStatsBuildPayload(uint8_t* buffer, uint8_t maxSize, float battery);
+
+/**
+ * @brief Cierra la ventana tras entregar el resumen (EV_TXCOMPLETE)
+ */
+void windowStatsOnSent();
+
+/**
+ * @brief Planifica el sueño con despertares intermedios de muestreo
+ *
+ * Registra cuándo toca el próximo uplink y devuelve el sueño hasta el
+ * siguiente despertar, sea de muestreo o de envío.
+ *
+ * @param untilUplinkSeconds Segundos hasta el próximo ciclo con uplink
+ * @return Segundos a dormir ahora
+ */
+uint32_t windowStatsPlanSleep(uint32_t untilUplinkSeconds);
+
+#endif // WINDOW_STATS_H
@@ -13,6 +13,11 @@
 #include "../lmic.h"
 #include "hal.h"
 #include <stdio.h>
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
 
 // -----------------------------------------------------------------------------
 // I/O
@@ -24,11 +29,15 @@ static void hal_io_init ()
     ASSERT(lmic_pins.dio[0] != LMIC_UNUSED_PIN);
     ASSERT(lmic_pins.dio[1] != LMIC_UNUSED_PIN || lmic_pins.dio[2] != LMIC_UNUSED_PIN);
 
+    // deselect the radio before the pin becomes an output so a warm
+    // start does not glitch NSS; RST stays floating (radio running) and
+    // is only driven by radio_init() through hal_pin_rst()
+    digitalWrite(lmic_pins.nss, HIGH);
     pinMode(lmic_pins.nss, OUTPUT);
     if (lmic_pins.rxtx != LMIC_UNUSED_PIN)
         pinMode(lmic_pins.rxtx, OUTPUT);
     if (lmic_pins.rst != LMIC_UNUSED_PIN)
-        pinMode(lmic_pins.rst, OUTPUT);
+        pinMode(lmic_pins.rst, INPUT);
 
     pinMode(lmic_pins.dio[0], INPUT);
     if (lmic_pins.dio[1] != LMIC_UNUSED_PIN)
@@ -69,8 +78,11 @@ static void hal_io_check()
 
         if (dio_states[i] != digitalRead(lmic_pins.dio[i])) {
             dio_states[i] = !dio_states[i];
-            if (dio_states[i])
+            if (dio_states[i]) {
+                if (hal_cpu_busy)
+                    hal_cpu_busy();
                 radio_irq_handler(i);
+            }
         }
     }
 }
@@ -109,6 +121,31 @@ u1_t hal_spi (u1_t out)
     return res;
 }
 
+// perform burst SPI transaction with radio
+void hal_spi_block (u1_t addr, u1_t* buf, u1_t len, u1_t dir)
+{
+    hal_pin_nss(0);
+    if (dir == HAL_SPI_WRITE) {
+        SPI.transfer(addr | 0x80);
+#if defined(ARDUINO_ARCH_ESP32)
+        SPI.writeBytes(buf, len);
+#else
+        for (u1_t i = 0; i < len; i++)
+            SPI.transfer(buf[i]);
+#endif
+    } else {
+        SPI.transfer(addr & 0x7F);
+#if defined(ARDUINO_ARCH_ESP32)
+        // full duplex in place: the radio ignores MOSI during a read burst
+        SPI.transferBytes(buf, buf, len);
+#else
+        for (u1_t i = 0; i < len; i++)
+            buf[i] = SPI.transfer(0x00);
+#endif
+    }
+    hal_pin_nss(1);
+}
+
 // -----------------------------------------------------------------------------
 // TIME
 
@@ -183,15 +220,56 @@ void hal_waitUntil (u4_t time)
         delayMicroseconds(delta * US_PER_OSTICK);
 }
 
+// Raise the CPU clock this long before a timed job expires, so the job
+// (TX start, RX window setup) never runs during a frequency switch
+#define HAL_CPU_BUSY_GUARD ms2osticks(5)
+
+// Set by hal_checkTimer() when the next timed job is within the guard;
+// tells the hal_sleep() that follows in the same runloop pass to stay busy
+static bool cpu_job_due = false;
+
 // check and rewind for target time
 u1_t hal_checkTimer (u4_t time)
 {
+    s4_t delta = delta_time(time);
+    if (hal_cpu_busy && delta <= (s4_t)HAL_CPU_BUSY_GUARD) {
+        cpu_job_due = true;
+        hal_cpu_busy();
+    }
     // No need to schedule wakeup, since we're not sleeping
-    return delta_time(time) <= 0;
+    return delta <= 0;
 }
 
 static uint8_t irqlevel = 0;
 
+#if defined(ARDUINO_ARCH_ESP32)
+// On the dual-core ESP32, noInterrupts() only masks the calling core, so
+// it does not keep a task on the other core out of the LMIC state. No ISR
+// touches that state either (DIO lines are polled in hal_io_check()), so
+// a recursive mutex is enough: it serializes LMIC between tasks on both
+// cores, nests like the old irqlevel counter and never masks the radio,
+// SPI or I2C interrupts that other tasks depend on.
+static SemaphoreHandle_t lmic_mutex = NULL;
+
+void hal_disableIRQs ()
+{
+    // First call comes from os_init() in setup(), before any other task
+    // can reach LMIC
+    if (lmic_mutex == NULL)
+        lmic_mutex = xSemaphoreCreateRecursiveMutex();
+    xSemaphoreTakeRecursive(lmic_mutex, portMAX_DELAY);
+    irqlevel++;
+}
+
+void hal_enableIRQs ()
+{
+    // Poll the DIO lines while still owning LMIC, so the radio IRQ
+    // handler cannot race a job running on the other core
+    if (--irqlevel == 0)
+        hal_io_check();
+    xSemaphoreGiveRecursive(lmic_mutex);
+}
+#else
 void hal_disableIRQs ()
 {
     noInterrupts();
@@ -214,10 +292,34 @@ void hal_enableIRQs ()
         hal_io_check();
     }
 }
+#endif
+
+void hal_jobReady ()
+{
+    // Jobs posted with os_setCallback() (join request, do_send) build
+    // frames and run AES/MIC right away, at full speed like timed jobs
+    if (hal_cpu_busy)
+        hal_cpu_busy();
+}
 
 void hal_sleep ()
 {
-    // Not implemented
+    // Not implemented; only lowers the CPU clock while nothing is due
+    if (hal_cpu_idle && !cpu_job_due)
+        hal_cpu_idle();
+    cpu_job_due = false;
+}
+
+u1_t hal_entropy (u1_t* buf, u1_t len)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    esp_fill_random(buf, len);
+    return 1;
+#else
+    (void)buf;
+    (void)len;
+    return 0;
+#endif
 }
 
 // -----------------------------------------------------------------------------
@@ -26,4 +26,11 @@ const u1_t LMIC_UNUSED_PIN = 0xff;
 // Declared here, to be defined an initialized by the application
 extern const lmic_pinmap lmic_pins;
 
+// Optional hooks for a CPU frequency policy, defined by the application.
+// hal_cpu_busy() is called when LMIC has work due (a runnable job, a timed
+// job about to expire or a DIO edge) and hal_cpu_idle() when it goes idle
+// again. Both are called often and must return quickly.
+void hal_cpu_busy () __attribute__((weak));
+void hal_cpu_idle () __attribute__((weak));
+
 #endif // _hal_hal_h_
@@ -50,6 +50,7 @@
 //#define DISABLE_MCMD_DCAP_REQ // duty cycle cap
 //#define DISABLE_MCMD_DN2P_SET // 2nd DN window param
 //#define DISABLE_MCMD_SNCH_REQ // set new channel
+//#define DISABLE_MCMD_DEVT_REQ // device time request (LoRaWAN 1.0.3)
 // Class B
 //#define DISABLE_MCMD_PING_SET // set ping freq, automatically disabled by DISABLE_PING
 //#define DISABLE_MCMD_BCNI_ANS // next beacon start, automatical disabled by DISABLE_BEACON
@@ -43,6 +43,22 @@ void hal_pin_rst (u1_t val);
  */
 u1_t hal_spi (u1_t outval);
 
+/*
+ * perform a burst SPI transaction with radio (one NSS assertion).
+ *   - send register address 'addr' with the write bit set if 'dir' is HAL_SPI_WRITE
+ *   - write 'len' bytes from 'buf' or read 'len' bytes into 'buf'
+ *   - the radio auto-increments the address (except for the FIFO register)
+ */
+#define HAL_SPI_READ  0
+#define HAL_SPI_WRITE 1
+void hal_spi_block (u1_t addr, u1_t* buf, u1_t len, u1_t dir);
+
+/*
+ * fill buffer with random bytes from a fast entropy source.
+ *   - return 0 if none is available (radio noise is used instead)
+ */
+u1_t hal_entropy (u1_t* buf, u1_t len);
+
 /*
  * disable all CPU interrupts.
  *   - might be invoked nested
@@ -60,6 +76,13 @@ void hal_enableIRQs (void);
  */
 void hal_sleep (void);
 
+/*
+ * a runnable job is about to be executed.
+ *   - lets the HAL leave any low-power CPU state before the job runs
+ *   - the next hal_sleep() call returns to it
+ */
+void hal_jobReady (void);
+
 /*
  * return 32-bit system time in ticks.
  */
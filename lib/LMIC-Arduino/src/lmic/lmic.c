@@ -1224,6 +1224,17 @@ static bit_t decodeFrame (void) {
             oidx += 6;
             continue;
         }
+        case MCMD_DEVT_ANS: {
+#if !defined(DISABLE_MCMD_DEVT_REQ)
+            // Network time at the end of the UP frame carrying the request
+            LMIC.devTimeSecs = os_rlsbf4(&opts[oidx+1]);
+            LMIC.devTimeFrac = opts[oidx+5];
+            LMIC.devTimeRef  = LMIC.txend;
+            LMIC.devTimeAns  = 1;
+#endif // !DISABLE_MCMD_DEVT_REQ
+            oidx += 6;
+            continue;
+        }
         case MCMD_PING_SET: {
 #if !defined(DISABLE_MCMD_PING_SET) && !defined(DISABLE_PING)
             u4_t freq = convFreq(&opts[oidx+1]);
@@ -1350,9 +1361,17 @@ static void setupRx2 (void) {
 }
 
 
+// Nominal start of the downlink for the last scheduled RX1/RX2 window
+// (used by the application to measure the real clock error)
+static ostime_t rxNominalStart;
+static ostime_t rxNominalDelay;
+
 static void schedRx12 (ostime_t delay, osjobcb_t func, u1_t dr) {
     ostime_t hsym = dr2hsym(dr);
 
+    rxNominalStart = LMIC.txend + delay;
+    rxNominalDelay = delay;
+
     LMIC.rxsyms = MINRX_SYMS;
 
     // If a clock error is specified, compensate for it by extending the
@@ -1682,6 +1701,13 @@ static void buildDataFrame (void) {
         LMIC.snchAns = 0;
     }
 #endif // !DISABLE_MCMD_SNCH_REQ
+#if !defined(DISABLE_MCMD_DEVT_REQ)
+    if( LMIC.devTimeReq ) {
+        LMIC.frame[end] = MCMD_DEVT_REQ;
+        end += 1;
+        LMIC.devTimeReq = 0;
+    }
+#endif // !DISABLE_MCMD_DEVT_REQ
     ASSERT(end <= OFF_DAT_OPTS+16);
 
     u1_t flen = end + (txdata ? 5+dlen : 4);
@@ -2380,3 +2406,32 @@ void LMIC_setLinkCheckMode (bit_t enabled) {
 void LMIC_setClockError(u2_t error) {
     LMIC.clockError = error;
 }
+
+ostime_t LMIC_getRxNominalStart(void) {
+    return rxNominalStart;
+}
+
+ostime_t LMIC_getRxNominalDelay(void) {
+    return rxNominalDelay;
+}
+
+#if !defined(DISABLE_MCMD_DEVT_REQ)
+// Piggyback a DeviceTimeReq on the next UP frame. The answer can only
+// come in a downlink to that same frame; ask again if none arrived.
+void LMIC_requestNetworkTime (void) {
+    LMIC.devTimeReq = 1;
+}
+
+// Returns 1 once per received DeviceTimeAns. The answer gives GPS time
+// (seconds since 1980-01-06, no leap seconds) at the local instant
+// *reference, i.e. the end of the UP frame that carried the request.
+bit_t LMIC_getNetworkTime (u4_t* gpsSeconds, u1_t* fraction, ostime_t* reference) {
+    if( !LMIC.devTimeAns )
+        return 0;
+    *gpsSeconds = LMIC.devTimeSecs;
+    *fraction   = LMIC.devTimeFrac;
+    *reference  = LMIC.devTimeRef;
+    LMIC.devTimeAns = 0;
+    return 1;
+}
+#endif // !DISABLE_MCMD_DEVT_REQ
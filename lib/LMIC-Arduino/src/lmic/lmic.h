@@ -222,6 +222,13 @@ struct lmic_t {
 #endif
 #if !defined(DISABLE_MCMD_SNCH_REQ)
     u1_t        snchAns;      // answer set new channel
+#endif
+#if !defined(DISABLE_MCMD_DEVT_REQ)
+    bit_t       devTimeReq;   // device time request pending for next UP frame
+    bit_t       devTimeAns;   // device time answer received and not yet read
+    u1_t        devTimeFrac;  // fraction of second of the answer (1/256 s)
+    u4_t        devTimeSecs;  // GPS seconds of the answer
+    ostime_t    devTimeRef;   // end of the UP frame the answer refers to
 #endif
     // 2nd RX window (after up stream)
     u1_t        dn2Dr;
@@ -305,6 +312,12 @@ void  LMIC_tryRejoin     (void);
 void LMIC_setSession (u4_t netid, devaddr_t devaddr, xref2u1_t nwkKey, xref2u1_t artKey);
 void LMIC_setLinkCheckMode (bit_t enabled);
 void LMIC_setClockError(u2_t error);
+ostime_t LMIC_getRxNominalStart(void);   // when the gateway should start the last RX1/RX2 downlink
+ostime_t LMIC_getRxNominalDelay(void);   // delay from txend used for that window
+#if !defined(DISABLE_MCMD_DEVT_REQ)
+void  LMIC_requestNetworkTime (void);
+bit_t LMIC_getNetworkTime     (u4_t* gpsSeconds, u1_t* fraction, ostime_t* reference);
+#endif
 
 // Declare onEvent() function, to make sure any definition will have the
 // C conventions, even when in a C++ file.
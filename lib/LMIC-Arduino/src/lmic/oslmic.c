@@ -26,6 +26,19 @@ void os_init ()
     LMIC_init();
 }
 
+// like os_init(), but reuse the radio state kept in sleep mode if possible
+// (falls back to a full radio_init() and returns 0 otherwise)
+bit_t os_init_warm (s1_t caltemp, u1_t maxdrift)
+{
+    memset(&OS, 0x00, sizeof(OS));
+    lmic_hal_init();
+    bit_t warm = radio_init_warm(caltemp, maxdrift);
+    if( !warm )
+        radio_init();
+    LMIC_init();
+    return warm;
+}
+
 ostime_t os_getTime ()
 {
     return hal_ticks();
@@ -118,6 +131,7 @@ void os_runloop_once()
     if (OS.runnablejobs) {
         j = OS.runnablejobs;
         OS.runnablejobs = j->next;
+        hal_jobReady();
     } else if (OS.scheduledjobs && hal_checkTimer(OS.scheduledjobs->deadline)) { // check for expired timed jobs
         j = OS.scheduledjobs;
         OS.scheduledjobs = j->next;
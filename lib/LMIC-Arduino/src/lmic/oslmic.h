@@ -82,8 +82,11 @@ u1_t radio_rand1 (void);
 #define DECLARE_LMIC extern struct lmic_t LMIC
 
 void radio_init (void);
+bit_t radio_init_warm (s1_t caltemp, u1_t maxdrift);
+s1_t radio_temp (void);
 void radio_irq_handler (u1_t dio);
 void os_init (void);
+bit_t os_init_warm (s1_t caltemp, u1_t maxdrift);
 void os_runloop (void);
 void os_runloop_once (void);
 
@@ -119,6 +122,11 @@ typedef s4_t  ostime_t;
 #endif
 
 
+u4_t radio_rxOnTicks (void);          // ticks the receiver has been on since last clear
+void radio_clearRxOnTicks (void);
+ostime_t radio_rxFrameStart (void);    // start of the last received LoRa frame
+
+
 struct osjob_t;  // fwd decl.
 typedef void (*osjobcb_t) (struct osjob_t*);
 struct osjob_t {
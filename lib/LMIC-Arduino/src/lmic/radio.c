@@ -245,11 +245,18 @@
 #define RF_IMAGECAL_IMAGECAL_RUNNING                0x20
 #define RF_IMAGECAL_IMAGECAL_DONE                   0x00  // Default
 
+#define RF_IMAGECAL_TEMPMONITOR_OFF                 0x01
+
 
 // RADIO STATE
 // (initialized by radio_init(), used by radio_rand1())
 static u1_t randbuf[16];
 
+// Receiver-on time accounting and start of the last received LoRa frame
+static ostime_t rxOnStart;
+static u4_t rxOnTicks;
+static ostime_t rxFrameStart;
+
 
 #ifdef CFG_sx1276_radio
 #define LNA_RX_GAIN (0x20|0x1)
@@ -276,23 +283,19 @@ static u1_t readReg (u1_t addr) {
 }
 
 static void writeBuf (u1_t addr, xref2u1_t buf, u1_t len) {
-    hal_pin_nss(0);
-    hal_spi(addr | 0x80);
-    for (u1_t i=0; i<len; i++) {
-        hal_spi(buf[i]);
-    }
-    hal_pin_nss(1);
+    hal_spi_block(addr, buf, len, HAL_SPI_WRITE);
 }
 
 static void readBuf (u1_t addr, xref2u1_t buf, u1_t len) {
-    hal_pin_nss(0);
-    hal_spi(addr & 0x7F);
-    for (u1_t i=0; i<len; i++) {
-        buf[i] = hal_spi(0x00);
-    }
-    hal_pin_nss(1);
+    hal_spi_block(addr, buf, len, HAL_SPI_READ);
 }
 
+// write consecutive registers starting at addr in a single burst
+#define writeRegs(addr, ...) do { \
+        u1_t regs_[] = { __VA_ARGS__ }; \
+        writeBuf((addr), regs_, sizeof(regs_)); \
+    } while (0)
+
 static void opmode (u1_t mode) {
     writeReg(RegOpMode, (readReg(RegOpMode) & ~OPMODE_MASK) | mode);
 }
@@ -340,14 +343,12 @@ static void configLoraModem () {
             mc1 |= SX1276_MC1_IMPLICIT_HEADER_MODE_ON;
             writeReg(LORARegPayloadLength, getIh(LMIC.rps)); // required length
         }
-        // set ModemConfig1
-        writeReg(LORARegModemConfig1, mc1);
-
         mc2 = (SX1272_MC2_SF7 + ((sf-1)<<4));
         if (getNocrc(LMIC.rps) == 0) {
             mc2 |= SX1276_MC2_RX_PAYLOAD_CRCON;
         }
-        writeReg(LORARegModemConfig2, mc2);
+        // set ModemConfig1 and ModemConfig2 (consecutive registers)
+        writeRegs(LORARegModemConfig1, mc1, mc2);
 
         mc3 = SX1276_MC3_AGCAUTO;
         if ((sf == SF11 || sf == SF12) && getBw(LMIC.rps) == BW125) {
@@ -376,22 +377,31 @@ static void configLoraModem () {
             mc1 |= SX1272_MC1_IMPLICIT_HEADER_MODE_ON;
             writeReg(LORARegPayloadLength, getIh(LMIC.rps)); // required length
         }
-        // set ModemConfig1
-        writeReg(LORARegModemConfig1, mc1);
-
-        // set ModemConfig2 (sf, AgcAutoOn=1 SymbTimeoutHi=00)
-        writeReg(LORARegModemConfig2, (SX1272_MC2_SF7 + ((sf-1)<<4)) | 0x04);
+        // set ModemConfig1 and ModemConfig2 (sf, AgcAutoOn=1 SymbTimeoutHi=00)
+        writeRegs(LORARegModemConfig1, mc1, (SX1272_MC2_SF7 + ((sf-1)<<4)) | 0x04);
 #else
 #error Missing CFG_sx1272_radio/CFG_sx1276_radio
 #endif /* CFG_sx1272_radio */
 }
 
+// FSK bitrate (50kbps) and frequency deviation (+/- 25kHz), registers 0x02..0x05
+#define FSK_BITRATE_FDEV 0x02, 0x80, 0x01, 0x99
+
+// frequency register value: FQ = (FRF * 32 Mhz) / (2 ^ 19)
+static u4_t calcFrf () {
+    return (u4_t)(((uint64_t)LMIC.freq << 19) / 32000000);
+}
+
 static void configChannel () {
-    // set frequency: FQ = (FRF * 32 Mhz) / (2 ^ 19)
-    uint64_t frf = ((uint64_t)LMIC.freq << 19) / 32000000;
-    writeReg(RegFrfMsb, (u1_t)(frf>>16));
-    writeReg(RegFrfMid, (u1_t)(frf>> 8));
-    writeReg(RegFrfLsb, (u1_t)(frf>> 0));
+    u4_t frf = calcFrf();
+    writeRegs(RegFrfMsb, (u1_t)(frf>>16), (u1_t)(frf>> 8), (u1_t)(frf>> 0));
+}
+
+// FSK bitrate, frequency deviation and channel: registers 0x02..0x08 in one burst
+static void configFskChannel () {
+    u4_t frf = calcFrf();
+    writeRegs(FSKRegBitrateMsb, FSK_BITRATE_FDEV,
+              (u1_t)(frf>>16), (u1_t)(frf>> 8), (u1_t)(frf>> 0));
 }
 
 
@@ -429,23 +439,11 @@ static void txfsk () {
     ASSERT(readReg(RegOpMode) == 0x10);
     // enter standby mode (required for FIFO loading))
     opmode(OPMODE_STANDBY);
-    // set bitrate
-    writeReg(FSKRegBitrateMsb, 0x02); // 50kbps
-    writeReg(FSKRegBitrateLsb, 0x80);
-    // set frequency deviation
-    writeReg(FSKRegFdevMsb, 0x01); // +/- 25kHz
-    writeReg(FSKRegFdevLsb, 0x99);
-    // frame and packet handler settings
-    writeReg(FSKRegPreambleMsb, 0x00);
-    writeReg(FSKRegPreambleLsb, 0x05);
-    writeReg(FSKRegSyncConfig, 0x12);
-    writeReg(FSKRegPacketConfig1, 0xD0);
-    writeReg(FSKRegPacketConfig2, 0x40);
-    writeReg(FSKRegSyncValue1, 0xC1);
-    writeReg(FSKRegSyncValue2, 0x94);
-    writeReg(FSKRegSyncValue3, 0xC1);
-    // configure frequency
-    configChannel();
+    // set bitrate (50kbps), frequency deviation (+/- 25kHz) and frequency
+    configFskChannel();
+    // frame and packet handler settings: preamble, sync config, sync value (0x25..0x2A)
+    writeRegs(FSKRegPreambleMsb, 0x00, 0x05, 0x12, 0xC1, 0x94, 0xC1);
+    writeRegs(FSKRegPacketConfig1, 0xD0, 0x40);
     // configure output power
     configPower();
 
@@ -486,14 +484,11 @@ static void txlora () {
 
     // set the IRQ mapping DIO0=TxDone DIO1=NOP DIO2=NOP
     writeReg(RegDioMapping1, MAP_DIO0_LORA_TXDONE|MAP_DIO1_LORA_NOP|MAP_DIO2_LORA_NOP);
-    // clear all radio IRQ flags
-    writeReg(LORARegIrqFlags, 0xFF);
-    // mask all IRQs but TxDone
-    writeReg(LORARegIrqFlagsMask, ~IRQ_LORA_TXDONE_MASK);
+    // mask all IRQs but TxDone and clear all radio IRQ flags
+    writeRegs(LORARegIrqFlagsMask, (u1_t)~IRQ_LORA_TXDONE_MASK, 0xFF);
 
-    // initialize the payload size and address pointers
-    writeReg(LORARegFifoTxBaseAddr, 0x00);
-    writeReg(LORARegFifoAddrPtr, 0x00);
+    // initialize the payload size and address pointers (FifoAddrPtr, FifoTxBaseAddr)
+    writeRegs(LORARegFifoAddrPtr, 0x00, 0x00);
     writeReg(LORARegPayloadLength, LMIC.dataLen);
 
     // download buffer to the radio FIFO
@@ -570,10 +565,8 @@ static void rxlora (u1_t rxmode) {
 
     // configure DIO mapping DIO0=RxDone DIO1=RxTout DIO2=NOP
     writeReg(RegDioMapping1, MAP_DIO0_LORA_RXDONE|MAP_DIO1_LORA_RXTOUT|MAP_DIO2_LORA_NOP);
-    // clear all radio IRQ flags
-    writeReg(LORARegIrqFlags, 0xFF);
-    // enable required radio IRQs
-    writeReg(LORARegIrqFlagsMask, ~TABLE_GET_U1(rxlorairqmask, rxmode));
+    // enable required radio IRQs and clear all radio IRQ flags
+    writeRegs(LORARegIrqFlagsMask, (u1_t)~TABLE_GET_U1(rxlorairqmask, rxmode), 0xFF);
 
     // enable antenna switch for RX
     hal_pin_rxtx(0);
@@ -585,6 +578,7 @@ static void rxlora (u1_t rxmode) {
     } else { // continous rx (scan or rssi)
         opmode(OPMODE_RX);
     }
+    rxOnStart = os_getTime();
 
 #if LMIC_DEBUG_LEVEL > 0
     if (rxmode == RXMODE_RSSI) {
@@ -614,36 +608,23 @@ static void rxfsk (u1_t rxmode) {
     ASSERT((readReg(RegOpMode) & OPMODE_LORA) == 0);
     // enter standby mode (warm up))
     opmode(OPMODE_STANDBY);
-    // configure frequency
-    configChannel();
+    // set bitrate (50kbps), frequency deviation (+/- 25kHz) and frequency
+    configFskChannel();
     // set LNA gain
     //writeReg(RegLna, 0x20|0x03); // max gain, boost enable
     writeReg(RegLna, LNA_RX_GAIN);
     // configure receiver
     writeReg(FSKRegRxConfig, 0x1E); // AFC auto, AGC, trigger on preamble?!?
-    // set receiver bandwidth
-    writeReg(FSKRegRxBw, 0x0B); // 50kHz SSb
-    // set AFC bandwidth
-    writeReg(FSKRegAfcBw, 0x12); // 83.3kHz SSB
+    // set receiver bandwidth (50kHz SSB) and AFC bandwidth (83.3kHz SSB)
+    writeRegs(FSKRegRxBw, 0x0B, 0x12);
     // set preamble detection
     writeReg(FSKRegPreambleDetect, 0xAA); // enable, 2 bytes, 10 chip errors
-    // set sync config
-    writeReg(FSKRegSyncConfig, 0x12); // no auto restart, preamble 0xAA, enable, fill FIFO, 3 bytes sync
-    // set packet config
-    writeReg(FSKRegPacketConfig1, 0xD8); // var-length, whitening, crc, no auto-clear, no adr filter
-    writeReg(FSKRegPacketConfig2, 0x40); // packet mode
-    // set sync value
-    writeReg(FSKRegSyncValue1, 0xC1);
-    writeReg(FSKRegSyncValue2, 0x94);
-    writeReg(FSKRegSyncValue3, 0xC1);
+    // set sync config (no auto restart, preamble 0xAA, enable, fill FIFO, 3 bytes sync) and sync value
+    writeRegs(FSKRegSyncConfig, 0x12, 0xC1, 0x94, 0xC1);
+    // set packet config (var-length, whitening, crc, no auto-clear, no adr filter; packet mode)
+    writeRegs(FSKRegPacketConfig1, 0xD8, 0x40);
     // set preamble timeout
     writeReg(FSKRegRxTimeout2, 0xFF);//(LMIC.rxsyms+1)/2);
-    // set bitrate
-    writeReg(FSKRegBitrateMsb, 0x02); // 50kbps
-    writeReg(FSKRegBitrateLsb, 0x80);
-    // set frequency deviation
-    writeReg(FSKRegFdevMsb, 0x01); // +/- 25kHz
-    writeReg(FSKRegFdevLsb, 0x99);
 
     // configure DIO mapping DIO0=PayloadReady DIO1=NOP DIO2=TimeOut
     writeReg(RegDioMapping1, MAP_DIO0_FSK_READY|MAP_DIO1_FSK_NOP|MAP_DIO2_FSK_TIMEOUT);
@@ -654,6 +635,7 @@ static void rxfsk (u1_t rxmode) {
     // now instruct the radio to receive
     hal_waitUntil(LMIC.rxtime); // busy wait until exact rx time
     opmode(OPMODE_RX); // no single rx mode available in FSK
+    rxOnStart = os_getTime();
 }
 
 static void startrx (u1_t rxmode) {
@@ -667,6 +649,73 @@ static void startrx (u1_t rxmode) {
     // or timed out, and the corresponding IRQ will inform us about completion.
 }
 
+// read the radio temperature sensor (uncalibrated, 1 degree C per LSB)
+// (radio must be in sleep mode, it is left in FSK sleep mode)
+static s1_t readTemp () {
+    opmodeFSK();
+    // the sensor only runs while the synthesizer is on
+    opmode(OPMODE_FSRX);
+    writeReg(FSKRegImageCal, readReg(FSKRegImageCal) & ~RF_IMAGECAL_TEMPMONITOR_OFF);
+    hal_waitUntil(os_getTime()+us2osticksCeil(200)); // wait >140us
+    writeReg(FSKRegImageCal, readReg(FSKRegImageCal) | RF_IMAGECAL_TEMPMONITOR_OFF);
+    opmode(OPMODE_SLEEP);
+    u1_t raw = readReg(FSKRegTemp);
+    return (raw & 0x80) ? (s1_t)(255 - raw) : -(s1_t)raw;
+}
+
+s1_t radio_temp () {
+    hal_disableIRQs();
+    s1_t t = readTemp();
+    hal_enableIRQs();
+    return t;
+}
+
+// seed randbuf from the HAL entropy source, or from wideband noise rssi
+static void seedRand () {
+    if( !hal_entropy(randbuf+1, 15) ) {
+        rxlora(RXMODE_RSSI);
+        while( (readReg(RegOpMode) & OPMODE_MASK) != OPMODE_RX ); // continuous rx
+        for(int i=1; i<16; i++) {
+            for(int j=0; j<8; j++) {
+                u1_t b; // wait for two non-identical subsequent least-significant bits
+                while( (b = readReg(LORARegRssiWideband) & 0x01) == (readReg(LORARegRssiWideband) & 0x01) );
+                randbuf[i] = (randbuf[i] << 1) | b;
+            }
+        }
+        opmode(OPMODE_SLEEP);
+    }
+    randbuf[0] = 16; // set initial index
+}
+
+// warm start after a host sleep with the radio kept powered in sleep mode:
+// no reset and no calibration unless the temperature drifted more than maxdrift
+// since caltemp. Returns 0 if the radio state cannot be trusted.
+bit_t radio_init_warm (s1_t caltemp, u1_t maxdrift) {
+    hal_disableIRQs();
+
+    u1_t v = readReg(RegVersion);
+    u1_t mode = readReg(RegOpMode);
+#ifdef CFG_sx1276_radio
+    bit_t ok = (v == 0x12);
+#elif CFG_sx1272_radio
+    bit_t ok = (v == 0x22);
+#else
+#error Missing CFG_sx1272_radio/CFG_sx1276_radio
+#endif
+    ok = ok && (mode & OPMODE_MASK) == OPMODE_SLEEP;
+    if( ok ) {
+        s1_t t = readTemp();
+        s1_t drift = t > caltemp ? t - caltemp : caltemp - t;
+        ok = drift <= maxdrift;
+    }
+    if( ok ) {
+        seedRand();
+    }
+
+    hal_enableIRQs();
+    return ok;
+}
+
 // get random seed from wideband noise rssi
 void radio_init () {
     hal_disableIRQs();
@@ -692,17 +741,8 @@ void radio_init () {
 #else
 #error Missing CFG_sx1272_radio/CFG_sx1276_radio
 #endif
-    // seed 15-byte randomness via noise rssi
-    rxlora(RXMODE_RSSI);
-    while( (readReg(RegOpMode) & OPMODE_MASK) != OPMODE_RX ); // continuous rx
-    for(int i=1; i<16; i++) {
-        for(int j=0; j<8; j++) {
-            u1_t b; // wait for two non-identical subsequent least-significant bits
-            while( (b = readReg(LORARegRssiWideband) & 0x01) == (readReg(LORARegRssiWideband) & 0x01) );
-            randbuf[i] = (randbuf[i] << 1) | b;
-        }
-    }
-    randbuf[0] = 16; // set initial index
+    // seed 15-byte randomness (HAL entropy source or noise rssi)
+    seedRand();
 
 #ifdef CFG_sx1276mb1_board
     // chain calibration
@@ -742,6 +782,18 @@ u1_t radio_rand1 () {
     return v;
 }
 
+u4_t radio_rxOnTicks () {
+    return rxOnTicks;
+}
+
+void radio_clearRxOnTicks () {
+    rxOnTicks = 0;
+}
+
+ostime_t radio_rxFrameStart () {
+    return rxFrameStart;
+}
+
 u1_t radio_rssi () {
     hal_disableIRQs();
     u1_t r = readReg(LORARegRssiValue);
@@ -772,6 +824,8 @@ void radio_irq_handler (u1_t dio) {
             // save exact tx time
             LMIC.txend = now - us2osticks(43); // TXDONE FIXUP
         } else if( flags & IRQ_LORA_RXDONE_MASK ) {
+            ostime_t done = now;
+            rxOnTicks += now - rxOnStart;
             // save exact rx time
             if(getBw(LMIC.rps) == BW125) {
                 now -= TABLE_GET_U2(LORA_RXDONE_FIXUP, getSf(LMIC.rps));
@@ -784,10 +838,13 @@ void radio_irq_handler (u1_t dio) {
             writeReg(LORARegFifoAddrPtr, readReg(LORARegFifoRxCurrentAddr));
             // now read the FIFO
             readBuf(RegFifo, LMIC.frame, LMIC.dataLen);
+            // start of the frame (preamble) as seen by our clock
+            rxFrameStart = done - calcAirTime(LMIC.rps, LMIC.dataLen);
             // read rx quality parameters
             LMIC.snr  = readReg(LORARegPktSnrValue); // SNR [dB] * 4
             LMIC.rssi = readReg(LORARegPktRssiValue) - 125 + 64; // RSSI [dBm] (-196...+63)
         } else if( flags & IRQ_LORA_RXTOUT_MASK ) {
+            rxOnTicks += now - rxOnStart;
             // indicate timeout
             LMIC.dataLen = 0;
         }
@@ -802,6 +859,7 @@ void radio_irq_handler (u1_t dio) {
             // save exact tx time
             LMIC.txend = now;
         } else if( flags2 & IRQ_FSK2_PAYLOADREADY_MASK ) {
+            rxOnTicks += now - rxOnStart;
             // save exact rx time
             LMIC.rxtime = now;
             // read the PDU and inform the MAC that we received something
@@ -812,6 +870,7 @@ void radio_irq_handler (u1_t dio) {
             LMIC.snr  = 0; // determine snr
             LMIC.rssi = 0; // determine rssi
         } else if( flags1 & IRQ_FSK1_TIMEOUT_MASK ) {
+            rxOnTicks += now - rxOnStart;
             // indicate timeout
             LMIC.dataLen = 0;
         } else {
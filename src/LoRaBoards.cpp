@@ -16,8 +16,14 @@
  */
 
 #include "LoRaBoards.h"
+#include "i2c_bus.h"
+#include "adc_scan.h"
+#include "pmu_telemetry.h"
 
 #include "soc/rtc.h"
+#if defined(ARDUINO_ARCH_ESP32)
+#include "esp_private/esp_clk.h"
+#endif
 #ifdef ENABLE_BLE
 #include <BLEDevice.h>
 #include <BLEUtils.h>
@@ -48,8 +54,11 @@ DISPLAY_MODEL *u8g2 = NULL;
 static DevInfo_t  devInfo;
 
 #ifdef HAS_PMU
-XPowersLibInterface *PMU = NULL;
+PmuDriver *PMU = NULL;
 bool pmuInterrupt;
+#if PMU_MODEL != PMU_MODEL_PROBE
+static PmuDriver pmuInstance;   // Sin heap; PMU apunta aquí si init() tiene éxito
+#endif
 #endif
 
 #ifdef HAS_GPS
@@ -77,15 +86,42 @@ static void setPmuFlag()
 
 /**
  * @brief Inicializa el módulo de gestión de energía (PMU).
- *        Intenta inicializar AXP2101 primero, luego AXP192 si falla.
- *        Configura voltajes, interrupciones y LEDs según el modelo detectado.
+ *        Con PMU_MODEL fijo inicializa solo ese chip; con PMU_MODEL_PROBE
+ *        intenta AXP2101 primero, luego AXP192 si falla.
+ *        Configura voltajes, interrupciones y LEDs según el modelo.
  *
  * @return true si la inicialización es exitosa, false en caso contrario.
  */
 bool beginPower()
 {
+    // Con el gestor del bus los registros del PMU se leen por sus callbacks
+    bool busManaged = i2cBusOwns(&PMU_WIRE_PORT);
+    if (busManaged) {
+        i2cBusSetClock(AXP2101_SLAVE_ADDRESS, I2C_BUS_CLOCK_PMU_HZ);
+    }
+
+#if PMU_MODEL != PMU_MODEL_PROBE
+    if (!PMU) {
+        bool ok;
+        if (busManaged) {
+            ok = pmuInstance.begin(PMU_FIXED_ADDRESS, i2cBusReadCallback, i2cBusWriteCallback);
+        } else {
+            ok = pmuInstance.begin(PMU_WIRE_PORT, PMU_FIXED_ADDRESS, SDA, SCL);
+        }
+        if (!ok) {
+            Serial.println("Warning: Failed to find " PMU_FIXED_NAME " power management");
+        } else {
+            Serial.println(PMU_FIXED_NAME " PMU init succeeded (model fixed at build time)");
+            PMU = &pmuInstance;
+        }
+    }
+#else
     if (!PMU) {
-        PMU = new XPowersAXP2101(PMU_WIRE_PORT);
+        if (busManaged) {
+            PMU = new XPowersAXP2101(AXP2101_SLAVE_ADDRESS, i2cBusReadCallback, i2cBusWriteCallback);
+        } else {
+            PMU = new XPowersAXP2101(PMU_WIRE_PORT);
+        }
         if (!PMU->init()) {
             Serial.println("Warning: Failed to find AXP2101 power management");
             delete PMU;
@@ -96,7 +132,11 @@ bool beginPower()
     }
 
     if (!PMU) {
-        PMU = new XPowersAXP192(PMU_WIRE_PORT);
+        if (busManaged) {
+            PMU = new XPowersAXP192(AXP192_SLAVE_ADDRESS, i2cBusReadCallback, i2cBusWriteCallback);
+        } else {
+            PMU = new XPowersAXP192(PMU_WIRE_PORT);
+        }
         if (!PMU->init()) {
             Serial.println("Warning: Failed to find AXP192 power management");
             delete PMU;
@@ -105,6 +145,7 @@ bool beginPower()
             Serial.println("AXP192 PMU init succeeded, using AXP192 PMU");
         }
     }
+#endif
 
     if (!PMU) {
         return false;
@@ -117,7 +158,7 @@ bool beginPower()
     pinMode(PMU_IRQ, INPUT_PULLUP);
     attachInterrupt(PMU_IRQ, setPmuFlag, FALLING);
 
-    if (PMU->getChipModel() == XPOWERS_AXP192) {
+    if (PMU_IS_AXP192()) {
 
         PMU->setProtectedChannel(XPOWERS_DCDC3);
 
@@ -152,7 +193,7 @@ bool beginPower()
                        XPOWERS_AXP192_PKEY_SHORT_IRQ
                       );
 
-    } else if (PMU->getChipModel() == XPOWERS_AXP2101) {
+    } else if (PMU_IS_AXP2101()) {
 
 #if defined(CONFIG_IDF_TARGET_ESP32)
         //Unuse power channel
@@ -390,7 +431,7 @@ void disablePeripherals()
     PMU->disablePowerOutput(XPOWERS_ALDO1);
 #else
 
-    if (PMU->getChipModel() == XPOWERS_AXP2101) {
+    if (PMU_IS_AXP2101()) {
 
         // Disable all PMU interrupts
         PMU->disableIRQ(XPOWERS_AXP2101_ALL_IRQ);
@@ -420,7 +461,7 @@ void disablePeripherals()
         PMU->disablePowerOutput(XPOWERS_BLDO1);
         PMU->disablePowerOutput(XPOWERS_BLDO2);
 
-    } else if (PMU->getChipModel() == XPOWERS_AXP192) {
+    } else if (PMU_IS_AXP192()) {
 
         // Disable all PMU interrupts
         PMU->disableIRQ(XPOWERS_AXP192_ALL_IRQ);
@@ -438,10 +479,32 @@ void disablePeripherals()
 #endif
 }
 
+/**
+ * @brief Consulta una interrupción en el irqStatus de la telemetría del PMU.
+ *        pmu_telemetry empaqueta INTSTS1..3 del AXP2101 como getIrqStatus(),
+ *        con INTSTS1 en los bits 16-23, mientras que las constantes
+ *        XPOWERS_AXP2101_*_IRQ lo llevan en los bits 0-7; en el AXP192 el
+ *        orden ya coincide con el de sus constantes.
+ *
+ * @param irqStatus irqStatus de pmu_telemetry_t.
+ * @param axp2101 Máscara XPOWERS_AXP2101_*_IRQ.
+ * @param axp192 Máscara XPOWERS_AXP192_*_IRQ.
+ * @return true si la interrupción está activa.
+ */
+static bool pmuIrq(uint32_t irqStatus, uint32_t axp2101, uint32_t axp192)
+{
+    if (!PMU_IS_AXP2101()) {
+        return (irqStatus & axp192) != 0;
+    }
+    uint32_t ordered = ((irqStatus >> 16) & 0xFF) | (irqStatus & 0xFF00) | ((irqStatus & 0xFF) << 16);
+    return (ordered & axp2101) != 0;
+}
+
 /**
  * @brief Maneja el bucle de eventos del PMU.
  *        Verifica interrupciones y procesa eventos como inserción/remoción de batería,
- *        carga, y pulsaciones de tecla.
+ *        carga, y pulsaciones de tecla. El estado de interrupciones sale de una
+ *        lectura nueva de pmu_telemetry (misma ráfaga que la batería y VBUS).
  *
  * @param pressed_cb Callback opcional para pulsaciones cortas de tecla.
  */
@@ -456,41 +519,43 @@ void loopPMU(void (*pressed_cb)(void))
 
     pmuInterrupt = false;
     // Get PMU Interrupt Status Register
-    uint32_t status = PMU->getIrqStatus();
+    pmu_telemetry_t t;
+    uint32_t status = pmuTelemetryRead(&t, 0) ? t.irqStatus : 0;
     Serial.print("STATUS => HEX:");
     Serial.print(status, HEX);
     Serial.print(" BIN:");
     Serial.println(status, BIN);
 
-    if (PMU->isVbusInsertIrq()) {
+    if (pmuIrq(status, XPOWERS_AXP2101_VBUS_INSERT_IRQ, XPOWERS_AXP192_VBUS_INSERT_IRQ)) {
         Serial.println("isVbusInsert");
     }
-    if (PMU->isVbusRemoveIrq()) {
+    if (pmuIrq(status, XPOWERS_AXP2101_VBUS_REMOVE_IRQ, XPOWERS_AXP192_VBUS_REMOVE_IRQ)) {
         Serial.println("isVbusRemove");
     }
-    if (PMU->isBatInsertIrq()) {
+    if (pmuIrq(status, XPOWERS_AXP2101_BAT_INSERT_IRQ, XPOWERS_AXP192_BAT_INSERT_IRQ)) {
         Serial.println("isBatInsert");
     }
-    if (PMU->isBatRemoveIrq()) {
+    if (pmuIrq(status, XPOWERS_AXP2101_BAT_REMOVE_IRQ, XPOWERS_AXP192_BAT_REMOVE_IRQ)) {
         Serial.println("isBatRemove");
     }
-    if (PMU->isPekeyShortPressIrq()) {
+    if (pmuIrq(status, XPOWERS_AXP2101_PKEY_SHORT_IRQ, XPOWERS_AXP192_PKEY_SHORT_IRQ)) {
         Serial.println("isPekeyShortPress");
         if (pressed_cb) {
             pressed_cb();
         }
     }
-    if (PMU->isPekeyLongPressIrq()) {
+    if (pmuIrq(status, XPOWERS_AXP2101_PKEY_LONG_IRQ, XPOWERS_AXP192_PKEY_LONG_IRQ)) {
         Serial.println("isPekeyLongPress");
     }
-    if (PMU->isBatChargeDoneIrq()) {
+    if (pmuIrq(status, XPOWERS_AXP2101_BAT_CHG_DONE_IRQ, XPOWERS_AXP192_BAT_CHG_DONE_IRQ)) {
         Serial.println("isBatChargeDone");
     }
-    if (PMU->isBatChargeStartIrq()) {
+    if (pmuIrq(status, XPOWERS_AXP2101_BAT_CHG_START_IRQ, XPOWERS_AXP192_BAT_CHG_START_IRQ)) {
         Serial.println("isBatChargeStart");
     }
     // Clear PMU Interrupt Status Register
     PMU->clearIrqStatus();
+    pmuTelemetryInvalidate();
 }
 
 #ifdef DISPLAY_MODEL
@@ -507,6 +572,10 @@ bool beginDisplay()
     if (Wire.endTransmission() == 0) {
         Serial.printf("Find Display model at 0x%X address\n", DISPLAY_ADDR);
         u8g2 = new DISPLAY_MODEL(U8G2_R0, U8X8_PIN_NONE);
+        if (i2cBusOwns(&Wire)) {
+            // Las transferencias del display pasan a la cola del gestor del bus
+            u8g2->getU8x8()->byte_cb = i2cBusU8x8Byte;
+        }
         u8g2->begin();
         u8g2->clearBuffer();
 
@@ -909,6 +978,12 @@ void setupBoards(bool disable_u8g2 )
     pinMode(RADIO_DIO2_PIN, INPUT);
 #endif
 
+#if I2C_BUS_ENABLE && defined(I2C_SDA)
+    // El gestor del bus toma Wire antes de que lo usen el PMU, el BME280 o el display
+    Wire.begin(I2C_SDA, I2C_SCL);
+    i2cBusBegin(Wire);
+#endif
+
     beginPower();
 
     // Perform an I2C scan after power-on operation
@@ -1360,7 +1435,11 @@ float getTempForNTC()
 #ifdef NTC_PIN
     static uint32_t check_temperature = 0;
     if (millis() > check_temperature) {
+#if ADC_SCAN_ENABLE
+        float voltage = adcScanMillivolts(ADC_SCAN_NTC, ADC_SCAN_MAX_AGE_MS) / 1000.0;
+#else
         float voltage = analogReadMilliVolts(NTC_PIN) / 1000.0;
+#endif
         float resistance = SERIES_RESISTOR * ((3.3 / voltage) - 1); // Calculate the resistance of NTC
 
         // Calculate temperature using the Steinhart-Hart equation
@@ -1467,6 +1546,23 @@ static void enable_slow_clock()
     deviceOnline |= OSC32768_ONLINE;
 }
 
+/**
+ * @brief Recalibra el reloj lento del RTC frente al cristal principal.
+ *        El sistema usa esta calibración para contar el tiempo durante el
+ *        sueño profundo, así que conviene refrescarla justo antes de dormir
+ *        (el oscilador RC interno deriva con la temperatura).
+ *
+ * @return Periodo del reloj lento en formato de rtc_clk_cal() (us << 19), 0 si falla.
+ */
+uint32_t calibrateSlowClock()
+{
+    uint32_t cal = CALIBRATE_ONE(RTC_CAL_RTC_MUX);
+    if (cal != 0) {
+        esp_clk_slowclk_cal_set(cal);
+    }
+    return cal;
+}
+
 
 /**
  * @brief Escanea redes WiFi disponibles.
@@ -1530,9 +1626,9 @@ void scanWiFi()
 float readBatteryVoltage() {
 
 #ifdef HAS_PMU
-    if (PMU) {
-        float v = PMU->getBattVoltage() / 1000.0f;
-        Serial.printf("DEBUG: PMU battery voltage raw: %d mV, converted: %.3f V\n", PMU->getBattVoltage(), v);
+    pmu_telemetry_t pmu;
+    if (pmuTelemetryRead(&pmu, PMU_TELEMETRY_MAX_AGE_MS)) {
+        float v = pmu.batteryMv / 1000.0f;
         // Protección: solo valores razonables
         if (v > 2.5f && v < 4.5f) {
             Serial.printf("DEBUG: Using PMU voltage: %.3f V\n", v);
@@ -1547,10 +1643,16 @@ float readBatteryVoltage() {
 
 #ifdef ADC_PIN
     // Leer ADC y calcular voltaje usando divisor resistivo
+#if ADC_SCAN_ENABLE
+    // Tensión calibrada del barrido compartido con el pH y la NTC
+    float v_adc = adcScanMillivolts(ADC_SCAN_BATTERY, ADC_SCAN_MAX_AGE_MS) / 1000.0f;
+    int raw = isnan(v_adc) ? -1 : (int)(v_adc * 1000.0f);  // mV para el log
+#else
     uint16_t raw = analogRead(ADC_PIN);
     float vref = 3.3f; // Voltaje de referencia ESP32
     float adcMax = 4095.0f;
     float v_adc = (raw / adcMax) * vref;
+#endif
     float r1 = BAT_ADC_PULLUP_RES;
     float r2 = BAT_ADC_PULLDOWN_RES;
     float v_bat = v_adc * ((r1 + r2) / r2);
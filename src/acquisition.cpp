@@ -0,0 +1,124 @@
+/**
+ * @file      acquisition.cpp
+ * @brief     Implementación de la adquisición del ciclo en su propia tarea
+ *
+ * Cada ciclo produce un único resultado, así que basta una cola de dos
+ * huecos. El estado que la MAC consulta después (política de envío,
+ * ventana de estadísticas) se escribe antes de publicar el resultado y la
+ * semántica release/acquire de la cola lo hace visible en el otro núcleo
+ * sin más sincronización. Serial, las transacciones SPI de la SD y el bus
+ * I2C del BME280 ya tienen su propio bloqueo.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include "acquisition.h"
+#include "spsc_queue.h"
+#include "report_policy.h"
+#include "window_stats.h"
+#include "sd_logger.h"
+#include "cpu_phase.h"
+#include "battery_soc.h"
+
+#define ACQ_TASK_STACK 8192     // Lectura de sensores, SD y printf
+#define ACQ_TASK_PRIORITY 1     // La misma que loop()
+
+static spsc_queue_t<acquisition_result_t, 2> results;
+static acquisition_result_t produced;   // Fuera de la pila de la tarea
+static bool busy = false;
+
+/**
+ * @brief Lee, registra, decide y codifica el ciclo
+ */
+static void acquire(acquisition_result_t* r) {
+    uint32_t start = millis();
+
+    r->sensorsOk = sensors_init_all();
+    if (!r->sensorsOk) {
+        Serial.println("ADVERTENCIA: Sensor no disponible, el dispositivo continuará funcionando y enviará datos de error");
+    }
+
+    // Una sola lectura por ciclo; si nada cambió de forma significativa se
+    // vuelve a dormir sin join ni uplink
+    reportPolicyInit();
+    r->dataOk = sensors_read_all(&r->data);
+    batterySocUpdate(r->data.battery, r->data.temperature);
+    if (!r->dataOk) {
+        sensors_retry_init_all();
+    }
+    sdLogAppend(&r->data);
+
+#if STATS_ENABLE
+    // Con resúmenes por ventana se envía uno por ventana, con la última muestra incluida
+    windowStatsAdd(&r->data);
+    r->send = true;
+    r->port = STATS_FPORT;
+    cpuPhaseBegin(CPU_PHASE_ENCODE);
+    r->payloadSize = windowStatsBuildPayload(r->payload, sizeof(r->payload), r->data.battery);
+    cpuPhaseEnd(CPU_PHASE_ENCODE);
+#else
+    r->send = reportPolicyShouldSend(&r->data);
+    r->port = 1;
+    r->payloadSize = 0;
+    if (r->send) {
+        payload_config_t payload_config = {
+            .buffer = r->payload,
+            .max_size = sizeof(r->payload),
+            .written = 0
+        };
+        cpuPhaseBegin(CPU_PHASE_ENCODE);
+        r->payloadSize = sensors_build_payload(&r->data, &payload_config);
+        cpuPhaseEnd(CPU_PHASE_ENCODE);
+    }
+#endif
+
+    r->elapsedMs = millis() - start;
+}
+
+/**
+ * @brief Adquiere y publica el resultado para la MAC
+ */
+static void produce() {
+    acquire(&produced);
+    spscPush(results, produced);
+    __atomic_store_n(&busy, false, __ATOMIC_RELEASE);
+}
+
+#if DUAL_CORE_ENABLE
+static void acquisitionTask(void* arg) {
+    (void)arg;
+    produce();
+    vTaskDelete(NULL);
+}
+#endif
+
+void acquisitionStart() {
+    spscReset(results);
+    __atomic_store_n(&busy, true, __ATOMIC_RELEASE);
+
+#if DUAL_CORE_ENABLE
+    if (xTaskCreatePinnedToCore(acquisitionTask, "adquisicion", ACQ_TASK_STACK, NULL,
+                                ACQ_TASK_PRIORITY, NULL, DUAL_CORE_ACQ_CORE) == pdPASS) {
+        Serial.printf("Adquisición: tarea en el núcleo %d, LMIC en el %d\n",
+                      DUAL_CORE_ACQ_CORE, xPortGetCoreID());
+        return;
+    }
+    Serial.println("Adquisición: ERROR - sin memoria para la tarea, lectura en este núcleo");
+#endif
+    produce();
+}
+
+bool acquisitionPoll(acquisition_result_t* result) {
+    return spscPop(results, result);
+}
+
+bool acquisitionBusy() {
+    return __atomic_load_n(&busy, __ATOMIC_ACQUIRE);
+}
+
+bool acquisitionMaySkipUplink() {
+    return REPORT_BY_EXCEPTION && !STATS_ENABLE;
+}
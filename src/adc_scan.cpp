@@ -0,0 +1,247 @@
+/**
+ * @file      adc_scan.cpp
+ * @brief     Implementación del barrido analógico calibrado
+ *
+ * El modo continuo con DMA del ESP32 solo admite el ADC1 y el pH está en
+ * GPIO25, que es el canal 8 del ADC2. Por eso el barrido usa lecturas
+ * one-shot de IDF (adc1_get_raw/adc2_get_raw) encadenadas sin esperas; con
+ * las muestras de todos los canales intercaladas el barrido completo dura
+ * unos pocos milisegundos. El ADC2 no está disponible con el WiFi
+ * encendido (en la boya siempre está apagado): esa entrada se da por no
+ * leída.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include <driver/adc.h>
+#include <esp_adc_cal.h>
+#include "adc_scan.h"
+#include "LoRaBoards.h"
+
+#define ADC_SCAN_DEFAULT_VREF 1100  // mV, solo si el eFuse no tiene calibración
+
+/**
+ * @brief Entrada analógica de la placa
+ */
+typedef struct {
+    const char* name;
+    int8_t gpio;            /**< -1 si la placa no la tiene */
+    adc_atten_t atten;
+} adc_scan_pin_t;
+
+// Mismo orden que adc_scan_input_t
+static const adc_scan_pin_t INPUTS[ADC_SCAN_INPUT_COUNT] = {
+#ifdef ENABLE_SENSOR_PH
+    { "pH", PH_ANALOG_PIN, ADC_ATTEN_DB_11 },
+#else
+    { "pH", -1, ADC_ATTEN_DB_11 },
+#endif
+#ifdef ADC_PIN
+    { "batería", ADC_PIN, ADC_ATTEN_DB_11 },
+#else
+    { "batería", -1, ADC_ATTEN_DB_11 },
+#endif
+#ifdef NTC_PIN
+    { "NTC", NTC_PIN, ADC_ATTEN_DB_11 },
+#else
+    { "NTC", -1, ADC_ATTEN_DB_11 },
+#endif
+};
+
+/**
+ * @brief Canal resuelto de una entrada
+ */
+typedef struct {
+    uint8_t unit;           /**< 1 o 2; 0 = sin canal ADC */
+    uint8_t channel;
+} adc_scan_route_t;
+
+static adc_scan_route_t routes[ADC_SCAN_INPUT_COUNT];
+static esp_adc_cal_characteristics_t calibration[2][ADC_ATTEN_MAX];
+static bool calibrated[2][ADC_ATTEN_MAX];
+static bool configured = false;
+
+static float results[ADC_SCAN_INPUT_COUNT];
+static uint32_t lastScanMs = 0;
+static bool haveScan = false;
+
+/**
+ * @brief Busca la unidad y el canal ADC de un GPIO
+ */
+static adc_scan_route_t routeFor(int8_t gpio) {
+    adc_scan_route_t route = { 0, 0 };
+    gpio_num_t io;
+    for (uint8_t ch = 0; ch < ADC1_CHANNEL_MAX; ch++) {
+        if (adc1_pad_get_io_num((adc1_channel_t)ch, &io) == ESP_OK && io == gpio) {
+            route.unit = 1;
+            route.channel = ch;
+            return route;
+        }
+    }
+    for (uint8_t ch = 0; ch < ADC2_CHANNEL_MAX; ch++) {
+        if (adc2_pad_get_io_num((adc2_channel_t)ch, &io) == ESP_OK && io == gpio) {
+            route.unit = 2;
+            route.channel = ch;
+            return route;
+        }
+    }
+    return route;
+}
+
+/**
+ * @brief Configura canales y calibración la primera vez
+ */
+static void configure() {
+    if (configured) {
+        return;
+    }
+    adc1_config_width(ADC_WIDTH_BIT_12);
+
+    for (uint8_t i = 0; i < ADC_SCAN_INPUT_COUNT; i++) {
+        routes[i].unit = 0;
+        if (INPUTS[i].gpio < 0) {
+            continue;
+        }
+        routes[i] = routeFor(INPUTS[i].gpio);
+        if (routes[i].unit == 0) {
+            Serial.printf("ADC: GPIO%d (%s) no es una entrada analógica\n", INPUTS[i].gpio, INPUTS[i].name);
+            continue;
+        }
+
+        adc_atten_t atten = INPUTS[i].atten;
+        if (routes[i].unit == 1) {
+            adc1_config_channel_atten((adc1_channel_t)routes[i].channel, atten);
+        } else {
+            adc2_config_channel_atten((adc2_channel_t)routes[i].channel, atten);
+        }
+
+        uint8_t u = routes[i].unit - 1;
+        if (!calibrated[u][atten]) {
+            esp_adc_cal_value_t source = esp_adc_cal_characterize(
+                routes[i].unit == 1 ? ADC_UNIT_1 : ADC_UNIT_2, atten, ADC_WIDTH_BIT_12,
+                ADC_SCAN_DEFAULT_VREF, &calibration[u][atten]);
+            calibrated[u][atten] = true;
+            Serial.printf("ADC: calibración ADC%u atenuación %d desde %s\n", routes[i].unit, atten,
+                          source == ESP_ADC_CAL_VAL_EFUSE_TP ? "eFuse (dos puntos)" :
+                          source == ESP_ADC_CAL_VAL_EFUSE_VREF ? "eFuse (Vref)" : "Vref por defecto");
+        }
+    }
+    configured = true;
+}
+
+/**
+ * @brief Lectura cruda de una entrada
+ */
+static bool readRaw(const adc_scan_route_t* route, uint16_t* raw) {
+    if (route->unit == 1) {
+        int value = adc1_get_raw((adc1_channel_t)route->channel);
+        if (value < 0) {
+            return false;
+        }
+        *raw = (uint16_t)value;
+        return true;
+    }
+    int value = 0;
+    if (adc2_get_raw((adc2_channel_t)route->channel, ADC_WIDTH_BIT_12, &value) != ESP_OK) {
+        return false;
+    }
+    *raw = (uint16_t)value;
+    return true;
+}
+
+/**
+ * @brief Media de la mitad central de las muestras (ordena el array)
+ */
+static uint32_t trimmedMean(uint16_t* samples, uint8_t count) {
+    for (uint8_t i = 1; i < count; i++) {
+        uint16_t v = samples[i];
+        int8_t j = i - 1;
+        while (j >= 0 && samples[j] > v) {
+            samples[j + 1] = samples[j];
+            j--;
+        }
+        samples[j + 1] = v;
+    }
+    uint8_t drop = count / 4;
+    uint32_t sum = 0;
+    for (uint8_t i = drop; i < count - drop; i++) {
+        sum += samples[i];
+    }
+    uint8_t kept = count - 2 * drop;
+    return (sum + kept / 2) / kept;
+}
+
+uint8_t adcScanRun() {
+    configure();
+
+    uint16_t samples[ADC_SCAN_INPUT_COUNT][ADC_SCAN_SAMPLES];
+    uint8_t counts[ADC_SCAN_INPUT_COUNT] = {0};
+
+    uint32_t start = micros();
+    for (uint8_t s = 0; s < ADC_SCAN_SAMPLES; s++) {
+        for (uint8_t i = 0; i < ADC_SCAN_INPUT_COUNT; i++) {
+            uint16_t raw;
+            if (routes[i].unit != 0 && readRaw(&routes[i], &raw)) {
+                samples[i][counts[i]++] = raw;
+            }
+        }
+    }
+    uint32_t elapsed = micros() - start;
+
+    uint8_t valid = 0;
+    for (uint8_t i = 0; i < ADC_SCAN_INPUT_COUNT; i++) {
+        // Con menos de la mitad de las muestras la entrada no es fiable
+        if (counts[i] < ADC_SCAN_SAMPLES / 2 || counts[i] == 0) {
+            results[i] = NAN;
+            continue;
+        }
+        uint32_t raw = trimmedMean(samples[i], counts[i]);
+        uint8_t u = routes[i].unit - 1;
+        results[i] = (float)esp_adc_cal_raw_to_voltage(raw, &calibration[u][INPUTS[i].atten]);
+        valid++;
+    }
+
+    lastScanMs = millis();
+    haveScan = true;
+    Serial.printf("ADC: barrido de %u entradas x %d muestras en %lu us\n",
+                  valid, ADC_SCAN_SAMPLES, (unsigned long)elapsed);
+    return valid;
+}
+
+float adcScanMillivolts(adc_scan_input_t input, uint32_t maxAgeMs) {
+    if (input >= ADC_SCAN_INPUT_COUNT) {
+        return NAN;
+    }
+    if (!haveScan || maxAgeMs == 0 || millis() - lastScanMs > maxAgeMs) {
+        adcScanRun();
+    }
+    return results[input];
+}
+
+bool adcScanChannel(adc_scan_input_t input, uint8_t* unit, uint8_t* channel) {
+    if (input >= ADC_SCAN_INPUT_COUNT) {
+        return false;
+    }
+    configure();
+    if (routes[input].unit == 0) {
+        return false;
+    }
+    *unit = routes[input].unit;
+    *channel = routes[input].channel;
+    return true;
+}
+
+float adcScanRawToMillivolts(adc_scan_input_t input, uint16_t raw) {
+    if (input >= ADC_SCAN_INPUT_COUNT) {
+        return NAN;
+    }
+    configure();
+    if (routes[input].unit == 0) {
+        return NAN;
+    }
+    uint8_t u = routes[input].unit - 1;
+    return (float)esp_adc_cal_raw_to_voltage(raw, &calibration[u][INPUTS[input].atten]);
+}
@@ -0,0 +1,203 @@
+/**
+ * @file      battery_soc.cpp
+ * @brief     Implementación del estado de carga de la batería
+ *
+ * El consumo de cada despertar (tiempo despierto y tiempo en aire) se
+ * cierra al dormir y queda pendiente en RTC junto con la hora de inicio
+ * del sueño; el siguiente batterySocUpdate() suma el sueño y aplica todo
+ * de una vez. Un despertar sin lectura de batería (muestreo de ventana)
+ * pasa su consumo al siguiente.
+ *
+ * La temperatura del chip del PMU está junto al portapilas y es mejor
+ * referencia para R_int que la exterior del BME280.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include <sys/time.h>
+#include "battery_soc.h"
+#include "soc_estimator.h"
+#include "retained_state.h"
+#include "pmu_telemetry.h"
+#include "i2c_bus.h"
+#include "LoRaBoards.h"
+
+#define BATTERY_SOC_VERSION 1
+#define SOC_MAX_SLEEP_MS (31LL * 24 * 3600 * 1000)  // Más que esto es un salto del reloj
+#define SOC_GAUGE_ENABLE_BIT 0x08                   // CHARGE_GAUGE_WDT_CTRL bit 3
+
+#if BATTERY_SOC_ENABLE
+/**
+ * @brief Estado de carga conservado durante el sueño profundo
+ */
+typedef struct {
+    float percent;          /**< Última estimación */
+    float pendingMah;       /**< Consumo de despertares anteriores aún sin aplicar */
+    int64_t sleepStartMs;   /**< Hora del sistema al dormir (0 = ya contado) */
+    uint8_t valid;          /**< percent tiene una estimación */
+    uint8_t source;         /**< battery_soc_source_t de percent */
+    uint8_t resync;         /**< Tomar la OCV tal cual en la próxima lectura */
+} battery_soc_state_t;
+
+RETAINED_STATE(battery_soc_state_t, socBlock);
+static battery_soc_state_t& socState = socBlock.state;
+
+static uint32_t txMs = 0;               // Tiempo en aire de este despertar
+static bool sleepRecorded = false;
+
+static const soc_params_t socParams = {
+    BATTERY_CAPACITY_MAH, BATTERY_INTERNAL_RES_MOHM, SOC_OCV_WEIGHT
+};
+
+/**
+ * @brief Valida el estado RTC (si no es válido queda a cero: sin estimación)
+ */
+static void ensureState() {
+    retainedRegister(RETAINED_BATTERY_SOC, socBlock, BATTERY_SOC_VERSION);
+}
+
+/**
+ * @brief Hora del sistema en ms (sigue contando en sueño profundo)
+ */
+static int64_t nowMs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+/**
+ * @brief Suma al consumo pendiente el último sueño, del inicio al arranque
+ */
+static void accrueSleep() {
+    if (socState.sleepStartMs == 0) {
+        return;
+    }
+    int64_t sleptMs = nowMs() - (int64_t)millis() - socState.sleepStartMs;
+    if (sleptMs > 0 && sleptMs < SOC_MAX_SLEEP_MS) {
+        socState.pendingMah += sleptMs / 3600000.0f * SOC_SLEEP_CURRENT_UA / 1000.0f;
+    }
+    socState.sleepStartMs = 0;
+}
+
+#ifdef HAS_PMU
+/**
+ * @brief Lee el medidor de carga del AXP2101 y lo activa si estaba apagado
+ */
+static bool readGauge(uint8_t* percent) {
+    static bool checked = false;
+    if (!checked) {
+        uint8_t ctrl;
+        if (i2cBusReadRegs(AXP2101_SLAVE_ADDRESS, XPOWERS_AXP2101_CHARGE_GAUGE_WDT_CTRL, &ctrl, 1) &&
+            !(ctrl & SOC_GAUGE_ENABLE_BIT)) {
+            ctrl |= SOC_GAUGE_ENABLE_BIT;
+            i2cBusWriteRegs(AXP2101_SLAVE_ADDRESS, XPOWERS_AXP2101_CHARGE_GAUGE_WDT_CTRL, &ctrl, 1);
+            Serial.println("Batería: medidor de carga del AXP2101 activado");
+        }
+        checked = true;
+    }
+    return i2cBusReadRegs(AXP2101_SLAVE_ADDRESS, XPOWERS_AXP2101_BAT_PERCENT_DATA, percent, 1) &&
+           *percent <= 100;
+}
+#endif
+#endif
+
+void batterySocUpdate(float volts, float tempC) {
+#if BATTERY_SOC_ENABLE
+    ensureState();
+    accrueSleep();
+    float consumedMah = socState.pendingMah;
+    socState.pendingMah = 0.0f;
+    bool charging = false;
+    if (tempC == SENSOR_ERROR_TEMPERATURE) {
+        tempC = NAN;  // BME280 ausente, caído o sin leer en este ciclo
+    }
+
+#ifdef HAS_PMU
+    pmu_telemetry_t pmu;
+    if (pmuTelemetryRead(&pmu, PMU_TELEMETRY_MAX_AGE_MS)) {
+        if (!isnan(pmu.dieTempC)) {
+            tempC = pmu.dieTempC;
+        }
+        charging = pmu.vbusIn && pmu.charging;
+
+        uint8_t gauge;
+        if (PMU_IS_AXP2101() && pmu.batteryPresent && readGauge(&gauge)) {
+            socState.percent = gauge;
+            socState.valid = true;
+            socState.source = BATTERY_SOC_GAUGE;
+            socState.resync = charging;
+            Serial.printf("Batería: %u %% (medidor del AXP2101)\n", gauge);
+            return;
+        }
+    }
+#endif
+
+    if (charging) {
+        // La tensión de carga no es la OCV y el consumo no sale de la batería
+        socState.resync = true;
+        Serial.println("Batería: cargando, se resincroniza con la OCV al terminar");
+        return;
+    }
+
+    soc_estimate_t est = { socState.percent, socState.valid && !socState.resync };
+    socEstimatorStep(&est, &socParams, consumedMah, volts, SOC_AWAKE_CURRENT_MA, tempC);
+    socState.percent = est.percent;
+    socState.valid = est.valid;
+    socState.source = est.valid ? BATTERY_SOC_ESTIMATED : BATTERY_SOC_NONE;
+    if (volts > 0.0f) {
+        socState.resync = false;
+    }
+    Serial.printf("Batería: %.1f %% (OCV y recuento, %.3f mAh consumidos, %.2f V, %.1f C)\n",
+                  socState.percent, consumedMah, volts, tempC);
+#else
+    (void)volts;
+    (void)tempC;
+#endif
+}
+
+void batterySocAddTx(uint32_t airtimeMs) {
+#if BATTERY_SOC_ENABLE
+    txMs += airtimeMs;
+#else
+    (void)airtimeMs;
+#endif
+}
+
+void batterySocOnSleep() {
+#if BATTERY_SOC_ENABLE
+    if (sleepRecorded) {
+        return;
+    }
+    ensureState();
+    accrueSleep();  // Despertar sin batterySocUpdate()
+
+    float awakeMs = (float)millis();
+    socState.pendingMah += (awakeMs * SOC_AWAKE_CURRENT_MA +
+                            txMs * (float)(SOC_TX_CURRENT_MA - SOC_AWAKE_CURRENT_MA)) / 3600000.0f;
+    socState.sleepStartMs = nowMs();
+    sleepRecorded = true;
+#endif
+}
+
+uint8_t batterySocPercent(float voltage) {
+#if BATTERY_SOC_ENABLE
+    ensureState();
+    if (socState.valid) {
+        return (uint8_t)(socState.percent + 0.5f);
+    }
+#endif
+    return batteryPercentFromVoltage(voltage);
+}
+
+battery_soc_source_t batterySocSource() {
+#if BATTERY_SOC_ENABLE
+    ensureState();
+    return socState.valid ? (battery_soc_source_t)socState.source : BATTERY_SOC_NONE;
+#else
+    return BATTERY_SOC_NONE;
+#endif
+}
@@ -0,0 +1,126 @@
+/**
+ * @file      clock_calibration.cpp
+ * @brief     Implementación de la calibración del error de reloj de LMIC
+ *
+ * El gateway emite el downlink exactamente txend + retardo después del fin
+ * del uplink. La diferencia con el inicio de trama observado por la radio
+ * (fin de recepción menos tiempo en aire) incluye la deriva del cristal y
+ * la latencia de sondeo de los DIO, que es lo que la ventana debe cubrir.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <lmic.h>
+#include "clock_calibration.h"
+#include "../config/config.h"
+
+#define CLOCK_CAL_NVS_NAMESPACE "clockcal"
+#define CLOCK_CAL_NVS_KEY       "err"
+
+// Conversión de ppm/porcentaje a unidades de LMIC_setClockError()
+#define CLOCK_ERROR_FROM_PPM(ppm)     ((uint32_t)(ppm) * MAX_CLOCK_ERROR / 1000000UL)
+#define CLOCK_ERROR_DEFAULT           ((uint32_t)MAX_CLOCK_ERROR * CLOCK_ERROR_DEFAULT_PERCENT / 100)
+#define CLOCK_ERROR_TO_PPM(err)       ((uint32_t)(err) * 1000000UL / MAX_CLOCK_ERROR)
+
+static uint16_t clockError = 0;   // Valor aplicado a LMIC
+static uint16_t storedError = 0;  // Valor guardado en NVS (0 = sin calibrar)
+
+/**
+ * @brief Guarda el error en NVS si cambió de forma apreciable
+ */
+static void saveIfChanged() {
+    uint16_t diff = clockError > storedError ? clockError - storedError : storedError - clockError;
+    if (storedError != 0 && diff <= storedError / 8) {
+        return;
+    }
+
+    Preferences prefs;
+    if (!prefs.begin(CLOCK_CAL_NVS_NAMESPACE, false)) {
+        Serial.println("Calibración reloj: no se pudo abrir NVS");
+        return;
+    }
+    prefs.putUShort(CLOCK_CAL_NVS_KEY, clockError);
+    prefs.end();
+    storedError = clockError;
+}
+
+void clockCalInit() {
+    clockError = CLOCK_ERROR_DEFAULT;
+    storedError = 0;
+
+    Preferences prefs;
+    if (prefs.begin(CLOCK_CAL_NVS_NAMESPACE, true)) {
+        storedError = prefs.getUShort(CLOCK_CAL_NVS_KEY, 0);
+        prefs.end();
+    }
+
+    if (storedError != 0) {
+        clockError = storedError;
+        Serial.printf("Calibración reloj: error guardado %lu ppm\n",
+                      (unsigned long)CLOCK_ERROR_TO_PPM(clockError));
+    } else {
+        Serial.printf("Calibración reloj: sin medida, usando %d%%\n", CLOCK_ERROR_DEFAULT_PERCENT);
+    }
+}
+
+void clockCalApply() {
+    LMIC_setClockError(clockError);
+    radio_clearRxOnTicks();
+}
+
+void clockCalOnDownlink() {
+    ostime_t delay = LMIC_getRxNominalDelay();
+    if (delay <= 0) {
+        return;
+    }
+
+    ostime_t offset = radio_rxFrameStart() - LMIC_getRxNominalStart();
+    uint32_t absOffset = offset < 0 ? -offset : offset;
+
+    // Error equivalente en unidades de LMIC, con margen de seguridad
+    uint32_t measured = (uint32_t)((uint64_t)absOffset * MAX_CLOCK_ERROR / delay);
+    uint32_t target = measured * CLOCK_ERROR_MARGIN_PERCENT / 100;
+    if (target < CLOCK_ERROR_FROM_PPM(CLOCK_ERROR_MIN_PPM)) {
+        target = CLOCK_ERROR_FROM_PPM(CLOCK_ERROR_MIN_PPM);
+    }
+    if (target > CLOCK_ERROR_DEFAULT) {
+        target = CLOCK_ERROR_DEFAULT;
+    }
+
+    // Ensanchar de inmediato, estrechar poco a poco
+    uint32_t updated = target;
+    if (storedError != 0 && target < clockError) {
+        updated = ((uint32_t)clockError * 3 + target) / 4;
+    }
+    clockError = (uint16_t)updated;
+
+    Serial.printf("Calibración reloj: desfase %ld us en %ld ms -> %lu ppm (aplicado %lu ppm)\n",
+                  (long)osticks2us(offset), (long)osticks2ms(delay),
+                  (unsigned long)CLOCK_ERROR_TO_PPM(measured),
+                  (unsigned long)CLOCK_ERROR_TO_PPM(clockError));
+    saveIfChanged();
+}
+
+void clockCalOnJoinFailed() {
+    if (storedError == 0 || clockError >= CLOCK_ERROR_DEFAULT) {
+        return;
+    }
+
+    // Quizá la ventana se quedó corta: duplicar hasta volver al valor por defecto
+    uint32_t widened = (uint32_t)clockError * 2;
+    clockError = widened > CLOCK_ERROR_DEFAULT ? CLOCK_ERROR_DEFAULT : widened;
+    Serial.printf("Calibración reloj: ensanchando ventanas a %lu ppm\n",
+                  (unsigned long)CLOCK_ERROR_TO_PPM(clockError));
+    saveIfChanged();
+}
+
+uint32_t clockCalReportRxOn(const char* label) {
+    uint32_t ms = osticks2ms(radio_rxOnTicks());
+    radio_clearRxOnTicks();
+    Serial.printf("Receptor encendido (%s): %lu ms\n", label, (unsigned long)ms);
+    return ms;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file      cpu_phase.cpp
+ * @brief     Implementación de la política de frecuencia de CPU por fase
+ *
+ * Un único bloqueo ESP_PM_CPU_FREQ_MAX se toma al abrir la primera fase y
+ * se suelta al cerrar la última; el mutex solo serializa esas
+ * transiciones entre el núcleo de LMIC y el de la adquisición. El tiempo
+ * a cada frecuencia se acumula en cada transición con esp_timer.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <lmic.h>
+#include <hal/hal.h>
+#include "cpu_phase.h"
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
+
+#if CPU_PM_ENABLE
+static SemaphoreHandle_t phaseMutex = NULL;
+static uint8_t activePhases = 0;    // Bit por cpu_phase_t; cada bit solo lo cambia su tarea
+static bool started = false;
+static int64_t lastChangeUs = 0;
+static int64_t fastUs = 0;
+static int64_t slowUs = 0;
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t fastLock = NULL;
+static bool pmConfigured = false;
+#endif
+
+/**
+ * @brief Cambia entre frecuencia máxima y mínima
+ */
+static void setFast(bool fast) {
+#if CONFIG_PM_ENABLE
+    if (pmConfigured) {
+        if (fast) {
+            esp_pm_lock_acquire(fastLock);
+        } else {
+            esp_pm_lock_release(fastLock);
+        }
+        return;
+    }
+#endif
+    setCpuFrequencyMhz(fast ? CPU_PM_MAX_MHZ : CPU_PM_MIN_MHZ);
+}
+
+/**
+ * @brief Suma el tramo desde la última transición a la frecuencia en curso
+ */
+static void account(bool fast) {
+    int64_t now = esp_timer_get_time();
+    if (fast) {
+        fastUs += now - lastChangeUs;
+    } else {
+        slowUs += now - lastChangeUs;
+    }
+    lastChangeUs = now;
+}
+
+// Ganchos del HAL de LMIC (declarados débiles en hal/hal.h)
+void hal_cpu_busy() {
+    cpuPhaseBegin(CPU_PHASE_LMIC);
+}
+
+void hal_cpu_idle() {
+    cpuPhaseEnd(CPU_PHASE_LMIC);
+}
+#endif
+
+void cpuPhaseInit() {
+#if CPU_PM_ENABLE
+    if (started) {
+        return;
+    }
+    phaseMutex = xSemaphoreCreateMutex();
+    if (phaseMutex == NULL) {
+        Serial.println("CPU: ERROR - sin memoria para la política de frecuencia, se queda fija");
+        return;
+    }
+
+#if CONFIG_PM_ENABLE
+    esp_pm_config_esp32_t config = {
+        .max_freq_mhz = CPU_PM_MAX_MHZ,
+        .min_freq_mhz = CPU_PM_MIN_MHZ,
+        .light_sleep_enable = CPU_PM_LIGHT_SLEEP
+    };
+    esp_err_t err = esp_pm_configure(&config);
+    if (err != ESP_OK && config.light_sleep_enable) {
+        Serial.println("CPU: sueño ligero automático no disponible, solo cambio de frecuencia");
+        config.light_sleep_enable = false;
+        err = esp_pm_configure(&config);
+    }
+    if (err == ESP_OK) {
+        err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "calculo", &fastLock);
+    }
+    pmConfigured = err == ESP_OK;
+    if (!pmConfigured) {
+        Serial.printf("CPU: esp_pm no disponible (%s), cambio con setCpuFrequencyMhz()\n", esp_err_to_name(err));
+        setFast(false);
+    }
+#else
+    setFast(false);
+#endif
+
+    lastChangeUs = esp_timer_get_time();
+    started = true;
+    Serial.printf("CPU: %d MHz en esperas, %d MHz en cálculo\n", CPU_PM_MIN_MHZ, CPU_PM_MAX_MHZ);
+#endif
+}
+
+void cpuPhaseBegin(cpu_phase_t phase) {
+#if CPU_PM_ENABLE
+    uint8_t bit = (uint8_t)(1 << phase);
+    if (!started || (__atomic_load_n(&activePhases, __ATOMIC_RELAXED) & bit)) {
+        return;
+    }
+    xSemaphoreTake(phaseMutex, portMAX_DELAY);
+    if (activePhases == 0) {
+        account(false);
+        setFast(true);
+    }
+    __atomic_store_n(&activePhases, (uint8_t)(activePhases | bit), __ATOMIC_RELAXED);
+    xSemaphoreGive(phaseMutex);
+#else
+    (void)phase;
+#endif
+}
+
+void cpuPhaseEnd(cpu_phase_t phase) {
+#if CPU_PM_ENABLE
+    uint8_t bit = (uint8_t)(1 << phase);
+    if (!started || !(__atomic_load_n(&activePhases, __ATOMIC_RELAXED) & bit)) {
+        return;
+    }
+    xSemaphoreTake(phaseMutex, portMAX_DELAY);
+    __atomic_store_n(&activePhases, (uint8_t)(activePhases & ~bit), __ATOMIC_RELAXED);
+    if (activePhases == 0) {
+        account(true);
+        setFast(false);
+    }
+    xSemaphoreGive(phaseMutex);
+#else
+    (void)phase;
+#endif
+}
+
+void cpuPhaseReport() {
+#if CPU_PM_ENABLE
+    if (!started) {
+        return;
+    }
+    xSemaphoreTake(phaseMutex, portMAX_DELAY);
+    account(activePhases != 0);
+    uint32_t fastMs = (uint32_t)(fastUs / 1000);
+    uint32_t slowMs = (uint32_t)(slowUs / 1000);
+    xSemaphoreGive(phaseMutex);
+
+    uint32_t totalMs = fastMs + slowMs;
+    Serial.printf("CPU: %lu ms a %d MHz, %lu ms a %d MHz (%lu%% a máxima)\n",
+                  (unsigned long)fastMs, CPU_PM_MAX_MHZ, (unsigned long)slowMs, CPU_PM_MIN_MHZ,
+                  (unsigned long)(totalMs > 0 ? fastMs * 100 / totalMs : 0));
+#endif
+}
@@ -0,0 +1,281 @@
+/**
+ * @file      i2c_bus.cpp
+ * @brief     Implementación del gestor del bus I2C compartido
+ *
+ * El controlador I2C del ESP32 no tiene DMA: Wire (driver i2c de IDF)
+ * completa cada transacción por interrupción y la tarea que la lanza queda
+ * bloqueada en un semáforo sin ocupar la CPU. Por eso la asincronía se
+ * consigue con una tarea propia que vacía la cola de escrituras; quien
+ * encola sigue trabajando mientras tanto.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "i2c_bus.h"
+#include "LoRaBoards.h"
+
+#define I2C_BUS_TASK_STACK 2048
+#define I2C_BUS_TASK_PRIORITY 1
+
+/**
+ * @brief Escritura en cola
+ */
+typedef struct {
+    uint8_t address;
+    uint8_t len;
+    uint8_t data[I2C_BUS_JOB_BYTES];
+} i2c_bus_job_t;
+
+/**
+ * @brief Velocidad de reloj de un dispositivo
+ */
+typedef struct {
+    uint8_t address;
+    uint32_t clockHz;
+} i2c_bus_clock_t;
+
+static TwoWire* bus = NULL;
+static SemaphoreHandle_t busMutex = NULL;
+static QueueHandle_t jobQueue = NULL;
+static portMUX_TYPE pendingMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint16_t pendingJobs = 0;  // Encoladas y aún no transmitidas
+
+static i2c_bus_clock_t clocks[I2C_BUS_MAX_DEVICES];
+static uint8_t clockCount = 0;
+static uint32_t currentClockHz = 0;
+static uint32_t busTimeUs = 0;
+
+/**
+ * @brief Bus sobre el que operar: el gestionado o Wire directamente
+ */
+static TwoWire* wire() {
+    return bus != NULL ? bus : &Wire;
+}
+
+/**
+ * @brief Transmite una escritura ya con el bus reservado
+ */
+static bool writeNow(uint8_t address, const uint8_t* data, uint8_t len) {
+    uint32_t start = micros();
+    wire()->beginTransmission(address);
+    wire()->write(data, len);
+    bool ok = wire()->endTransmission() == 0;
+    busTimeUs += micros() - start;
+    return ok;
+}
+
+/**
+ * @brief Tarea que vacía la cola de escrituras
+ */
+static void busWorker(void* arg) {
+    (void)arg;
+    i2c_bus_job_t job;
+    for (;;) {
+        if (xQueueReceive(jobQueue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        // Se reserva el bus por escritura: otros accesos se intercalan entre bloques
+        if (i2cBusLock(job.address)) {
+            writeNow(job.address, job.data, job.len);
+            i2cBusUnlock();
+        }
+        portENTER_CRITICAL(&pendingMux);
+        pendingJobs--;
+        portEXIT_CRITICAL(&pendingMux);
+    }
+}
+
+bool i2cBusBegin(TwoWire& wireBus) {
+#if I2C_BUS_ENABLE
+    if (bus != NULL) {
+        return bus == &wireBus;
+    }
+
+    busMutex = xSemaphoreCreateRecursiveMutex();
+    jobQueue = xQueueCreate(I2C_BUS_QUEUE_DEPTH, sizeof(i2c_bus_job_t));
+    if (busMutex == NULL || jobQueue == NULL ||
+        xTaskCreate(busWorker, "i2c_bus", I2C_BUS_TASK_STACK, NULL, I2C_BUS_TASK_PRIORITY, NULL) != pdPASS) {
+        Serial.println("Bus I2C: ERROR - sin memoria para el gestor, acceso directo a Wire");
+        return false;
+    }
+
+    bus = &wireBus;
+    currentClockHz = bus->getClock();
+    Serial.printf("Bus I2C: gestor activo (reloj inicial %lu Hz, cola de %d escrituras)\n",
+                  (unsigned long)currentClockHz, I2C_BUS_QUEUE_DEPTH);
+    return true;
+#else
+    (void)wireBus;
+    return false;
+#endif
+}
+
+bool i2cBusOwns(const TwoWire* wireBus) {
+    return bus != NULL && bus == wireBus;
+}
+
+void i2cBusSetClock(uint8_t address, uint32_t clockHz) {
+    for (uint8_t i = 0; i < clockCount; i++) {
+        if (clocks[i].address == address) {
+            clocks[i].clockHz = clockHz;
+            return;
+        }
+    }
+    if (clockCount < I2C_BUS_MAX_DEVICES) {
+        clocks[clockCount].address = address;
+        clocks[clockCount].clockHz = clockHz;
+        clockCount++;
+    }
+}
+
+bool i2cBusLock(uint8_t address) {
+    if (bus == NULL) {
+        return true;
+    }
+    if (xSemaphoreTakeRecursive(busMutex, pdMS_TO_TICKS(I2C_BUS_TIMEOUT_MS)) != pdTRUE) {
+        Serial.printf("Bus I2C: ERROR - bus ocupado, acceso a 0x%02X descartado\n", address);
+        return false;
+    }
+    for (uint8_t i = 0; address != 0 && i < clockCount; i++) {
+        if (clocks[i].address == address) {
+            if (clocks[i].clockHz != 0 && clocks[i].clockHz != currentClockHz) {
+                bus->setClock(clocks[i].clockHz);
+                currentClockHz = clocks[i].clockHz;
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+void i2cBusUnlock() {
+    if (bus != NULL) {
+        xSemaphoreGiveRecursive(busMutex);
+    }
+}
+
+bool i2cBusReadRegs(uint8_t address, uint8_t reg, uint8_t* buf, uint8_t len) {
+    if (!i2cBusLock(address)) {
+        return false;
+    }
+    uint32_t start = micros();
+    wire()->beginTransmission(address);
+    wire()->write(reg);
+    bool ok = wire()->endTransmission(false) == 0 &&
+              wire()->requestFrom(address, len) == len &&
+              wire()->readBytes(buf, len) == len;
+    busTimeUs += micros() - start;
+    i2cBusUnlock();
+    return ok;
+}
+
+bool i2cBusWriteRegs(uint8_t address, uint8_t reg, const uint8_t* buf, uint8_t len) {
+    if (!i2cBusLock(address)) {
+        return false;
+    }
+    uint32_t start = micros();
+    wire()->beginTransmission(address);
+    wire()->write(reg);
+    wire()->write(buf, len);
+    bool ok = wire()->endTransmission() == 0;
+    busTimeUs += micros() - start;
+    i2cBusUnlock();
+    return ok;
+}
+
+bool i2cBusWriteAsync(uint8_t address, const uint8_t* data, uint8_t len) {
+    if (len > I2C_BUS_JOB_BYTES) {
+        return false;
+    }
+    if (bus == NULL) {
+        return writeNow(address, data, len);
+    }
+
+    i2c_bus_job_t job;
+    job.address = address;
+    job.len = len;
+    memcpy(job.data, data, len);
+
+    portENTER_CRITICAL(&pendingMux);
+    pendingJobs++;
+    portEXIT_CRITICAL(&pendingMux);
+    if (xQueueSend(jobQueue, &job, pdMS_TO_TICKS(I2C_BUS_TIMEOUT_MS)) != pdTRUE) {
+        portENTER_CRITICAL(&pendingMux);
+        pendingJobs--;
+        portEXIT_CRITICAL(&pendingMux);
+        Serial.printf("Bus I2C: ERROR - cola llena, escritura a 0x%02X descartada\n", address);
+        return false;
+    }
+    return true;
+}
+
+bool i2cBusFlush(uint32_t timeoutMs) {
+    uint32_t start = millis();
+    while (pendingJobs > 0) {
+        if (millis() - start >= timeoutMs) {
+            Serial.printf("Bus I2C: %u escrituras sin vaciar\n", pendingJobs);
+            return false;
+        }
+        delay(1);
+    }
+    return true;
+}
+
+uint32_t i2cBusTimeUs() {
+    return busTimeUs;
+}
+
+int i2cBusReadCallback(uint8_t address, uint8_t reg, uint8_t* data, uint8_t len) {
+    return i2cBusReadRegs(address, reg, data, len) ? 0 : -1;
+}
+
+int i2cBusWriteCallback(uint8_t address, uint8_t reg, uint8_t* data, uint8_t len) {
+    return i2cBusWriteRegs(address, reg, data, len) ? 0 : -1;
+}
+
+#ifdef DISPLAY_MODEL
+// Transferencia del display en construcción (entre START y END)
+static i2c_bus_job_t displayJob;
+static bool displayOverflow = false;
+
+uint8_t i2cBusU8x8Byte(u8x8_t* u8x8, uint8_t msg, uint8_t argInt, void* argPtr) {
+    switch (msg) {
+    case U8X8_MSG_BYTE_INIT: {
+        uint32_t clockHz = I2C_BUS_CLOCK_DISPLAY_HZ;
+        if (clockHz == 0) {
+            clockHz = u8x8->bus_clock != 0 ? u8x8->bus_clock
+                                           : u8x8->display_info->i2c_bus_clock_100kHz * 100000UL;
+        }
+        i2cBusSetClock(u8x8_GetI2CAddress(u8x8) >> 1, clockHz);
+        break;
+    }
+    case U8X8_MSG_BYTE_SET_DC:
+        break;
+    case U8X8_MSG_BYTE_START_TRANSFER:
+        displayJob.address = u8x8_GetI2CAddress(u8x8) >> 1;
+        displayJob.len = 0;
+        displayOverflow = false;
+        break;
+    case U8X8_MSG_BYTE_SEND:
+        if (displayJob.len + argInt > I2C_BUS_JOB_BYTES) {
+            displayOverflow = true;
+            return 0;
+        }
+        memcpy(&displayJob.data[displayJob.len], argPtr, argInt);
+        displayJob.len += argInt;
+        break;
+    case U8X8_MSG_BYTE_END_TRANSFER:
+        if (!displayOverflow) {
+            i2cBusWriteAsync(displayJob.address, displayJob.data, displayJob.len);
+        }
+        break;
+    default:
+        return 0;
+    }
+    return 1;
+}
+#endif
@@ -0,0 +1,208 @@
+/**
+ * @file      join_backoff.cpp
+ * @brief     Implementación de los reintentos de join OTAA con backoff en sueño profundo
+ *
+ * El estado vive en memoria RTC para que el backoff pueda hacerse en sueño
+ * profundo (~10 µA) en lugar de sueño ligero dentro del callback de LMIC, y
+ * para que un reinicio por watchdog o brown-out a mitad de join no reutilice
+ * un DevNonce ni vuelva a barrer desde el DR inicial.
+ * El tiempo transcurrido desde el primer intento se mide con el reloj del
+ * sistema, que el ESP32 mantiene durante el sueño profundo.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include <lmic.h>
+#include <esp_system.h>
+#include <esp_attr.h>
+#include <sys/time.h>
+#include "join_backoff.h"
+#include "retained_state.h"
+#include "../config/config.h"
+
+// Versión del formato de join_backoff_state_t en memoria RTC
+#define JOIN_BACKOFF_VERSION 1
+
+// Intentos que LMIC hace en cada DR antes de bajar al siguiente
+#define JOIN_TRIES_PER_DR 2
+
+/**
+ * @brief Estado de reintentos de join conservado durante el sueño profundo
+ */
+typedef struct {
+    uint32_t firstAttempt;    /**< Segundos de reloj del primer intento fallido (0 = ninguno) */
+    uint32_t nextBackoff;     /**< Último backoff calculado en segundos */
+    uint16_t devNonce;        /**< Siguiente DevNonce a usar */
+    uint8_t  attempts;        /**< Ciclos de join fallidos consecutivos */
+    uint8_t  lastDr;          /**< DR en curso del ciclo de join */
+    uint8_t  cycleStartDr;    /**< DR con el que empezó el ciclo actual */
+    uint8_t  cycleActive;     /**< 1 si hay un ciclo de join en curso */
+    uint8_t  nonceValid;      /**< 1 si devNonce contiene un valor usado */
+} join_backoff_state_t;
+
+RETAINED_STATE(join_backoff_state_t, backoffBlock);
+static join_backoff_state_t& backoffState = backoffBlock.state;
+
+// true desde joinBackoffApply(): sin join en este arranque no hay nada que seguir
+static bool tracking = false;
+
+// Tiempo en aire (ms) de un JoinRequest de 23 bytes en EU868, BW125, CR4/5,
+// indexado por DR (DR_SF12 = 0 ... DR_SF7 = 5)
+static const uint16_t JOIN_AIRTIME_MS[] = { 1483, 823, 371, 206, 113, 62 };
+
+/**
+ * @brief Segundos de reloj del sistema (se mantiene durante el sueño profundo)
+ */
+static uint32_t nowSeconds() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint32_t)tv.tv_sec;
+}
+
+/**
+ * @brief Tiempo en aire de un ciclo de join completo desde startDr hasta SF12
+ */
+static uint32_t cycleAirtimeMs(uint8_t startDr) {
+    uint32_t total = 0;
+    for (uint8_t dr = DR_SF12; dr <= startDr && dr <= DR_SF7; dr++) {
+        total += (uint32_t)JOIN_AIRTIME_MS[dr] * JOIN_TRIES_PER_DR;
+    }
+    return total;
+}
+
+/**
+ * @brief Duty cycle permitido para join-requests en partes por 100000
+ *
+ * LoRaWAN 1.0.x: 36 s en la primera hora, 36 s cada 10 h hasta la hora 11
+ * y 8.7 s cada 24 h a partir de entonces.
+ */
+static uint32_t allowedDutyPer100k(uint32_t elapsedSeconds) {
+    if (elapsedSeconds < 3600UL) {
+        return 1000;  // 1%
+    } else if (elapsedSeconds < 11UL * 3600UL) {
+        return 100;   // 0.1%
+    }
+    return 10;        // ~0.01%
+}
+
+void joinBackoffInit() {
+    if (!retainedRegister(RETAINED_JOIN_BACKOFF, backoffBlock, JOIN_BACKOFF_VERSION)) {
+        backoffState.lastDr = DR_SF7;
+        backoffState.cycleStartDr = DR_SF7;
+        retainedCommit(RETAINED_JOIN_BACKOFF);
+        Serial.println("Estado de join RTC inicializado");
+    } else if (backoffState.attempts > 0) {
+        Serial.printf("Reanudando join tras %u ciclos fallidos\n", backoffState.attempts);
+    }
+}
+
+void joinBackoffApply() {
+    // Ciclo sin cerrar con EV_JOINED/EV_JOIN_FAILED: el arranque anterior se
+    // interrumpió (watchdog, brown-out) con el join en curso
+    bool interrupted = backoffState.cycleActive;
+
+    if (backoffState.nonceValid) {
+        // LMIC incrementa el DevNonce al construir el join-request y
+        // joinBackoffTrack() no lo sella hasta la siguiente pasada del bucle:
+        // tras una interrupción el valor guardado pudo haber salido ya al aire
+        LMIC.devNonce = (uint16_t)(backoffState.devNonce + (interrupted ? 1 : 0));
+    }
+
+    // Por defecto se respeta el DR fijado por LMIC_startJoining() o por join_strategy
+    uint8_t startDr = LMIC.datarate;
+    if (interrupted && backoffState.lastDr < startDr) {
+        // Continuar el ciclo interrumpido donde iba
+        startDr = backoffState.lastDr;
+        LMIC_setDrTxpow((dr_t)startDr, TX_POWER_DBM);
+        Serial.printf("Reanudando ciclo de join interrumpido en DR%u\n", startDr);
+    }
+
+    backoffState.cycleStartDr = startDr;
+    backoffState.lastDr = startDr;
+    backoffState.cycleActive = 1;
+    retainedCommit(RETAINED_JOIN_BACKOFF);
+    tracking = true;
+}
+
+void joinBackoffTrack() {
+    if (!tracking) {
+        return;
+    }
+    bool changed = false;
+    if ((LMIC.opmode & OP_JOINING) && backoffState.lastDr != LMIC.datarate) {
+        backoffState.lastDr = LMIC.datarate;
+        changed = true;
+    }
+    if (!backoffState.nonceValid || backoffState.devNonce != LMIC.devNonce) {
+        backoffState.devNonce = LMIC.devNonce;
+        backoffState.nonceValid = 1;
+        changed = true;
+    }
+    // Sellar al momento (un CRC de pocos bytes, solo cuando cambia): la memoria
+    // RTC sin inicializar conserva el bloque tras un watchdog o un brown-out
+    if (changed) {
+        retainedCommit(RETAINED_JOIN_BACKOFF);
+    }
+}
+
+uint32_t joinBackoffOnFailed() {
+    joinBackoffTrack();
+
+    uint32_t now = nowSeconds();
+    if (backoffState.attempts == 0 || backoffState.firstAttempt == 0) {
+        backoffState.firstAttempt = now;
+    }
+    if (backoffState.attempts < 255) {
+        backoffState.attempts++;
+    }
+    backoffState.cycleActive = 0;
+
+    // Backoff exponencial: inicial * 2^(intentos-1), limitado al máximo
+    uint32_t backoff = BACKOFF_INITIAL_SECONDS;
+    for (uint8_t i = 1; i < backoffState.attempts && backoff < BACKOFF_MAX_SECONDS; i++) {
+        backoff *= 2;
+    }
+    if (backoff > BACKOFF_MAX_SECONDS) {
+        backoff = BACKOFF_MAX_SECONDS;
+    }
+
+    // Jitter ±BACKOFF_JITTER_PERCENT para no sincronizar nodos que perdieron la red a la vez
+    uint32_t span = backoff * BACKOFF_JITTER_PERCENT / 100;
+    if (span > 0) {
+        backoff = backoff - span + (esp_random() % (2 * span + 1));
+    }
+
+    // Mínimo impuesto por el duty cycle de join-requests
+    uint32_t elapsed = now - backoffState.firstAttempt;
+    uint32_t airtime = cycleAirtimeMs(backoffState.cycleStartDr);
+    uint32_t dutyFloor = airtime * 100UL / allowedDutyPer100k(elapsed);
+    if (backoff < dutyFloor) {
+        backoff = dutyFloor;
+    }
+
+    backoffState.nextBackoff = backoff;
+    retainedCommit(RETAINED_JOIN_BACKOFF);
+    Serial.printf("Join fallido #%u: %lu ms en aire, backoff %lu s (mínimo duty %lu s)\n",
+                  backoffState.attempts, (unsigned long)airtime,
+                  (unsigned long)backoff, (unsigned long)dutyFloor);
+    return backoff;
+}
+
+void joinBackoffOnJoined() {
+    joinBackoffTrack();
+    backoffState.attempts = 0;
+    backoffState.firstAttempt = 0;
+    backoffState.nextBackoff = 0;
+    backoffState.cycleActive = 0;
+    backoffState.lastDr = DR_SF7;
+    backoffState.cycleStartDr = DR_SF7;
+    retainedCommit(RETAINED_JOIN_BACKOFF);
+    Serial.println("Contador de joins fallidos reseteado");
+}
+
+uint8_t joinBackoffAttempts() {
+    return backoffState.attempts;
+}
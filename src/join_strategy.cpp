@@ -0,0 +1,150 @@
+/**
+ * @file      join_strategy.cpp
+ * @brief     Implementación del aprendizaje del data rate de join OTAA
+ *
+ * El registro se guarda en NVS (Preferences) para sobrevivir a pérdidas de
+ * alimentación. Solo se escribe cuando cambia el DR o el canal, cuando el
+ * SNR varía de forma apreciable o cuando cambia el contador de fallos, para
+ * no desgastar la flash con un join por despertar.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <lmic.h>
+#include <esp_system.h>
+#include "join_strategy.h"
+#include "../config/config.h"
+
+#define JOIN_STRATEGY_NVS_NAMESPACE "joinstrat"
+#define JOIN_STRATEGY_NVS_KEY       "rec"
+#define JOIN_STRATEGY_VERSION       1
+
+// Variación de SNR (x4, como LMIC.snr) que justifica reescribir el registro
+#define JOIN_STRATEGY_SNR_HYSTERESIS (3 * 4)
+
+/**
+ * @brief Registro del último join exitoso guardado en NVS
+ */
+typedef struct {
+    uint8_t version;       /**< JOIN_STRATEGY_VERSION */
+    uint8_t dr;            /**< DR del join-accept (DR_NONE = sin aprender) */
+    uint8_t chnl;          /**< Canal de join (0..2) */
+    int8_t  rssi;          /**< LMIC.rssi del join-accept */
+    int8_t  snr;           /**< LMIC.snr del join-accept (dB x4) */
+    uint8_t failedCycles;  /**< Ciclos de join fallidos desde el último éxito */
+} join_strategy_record_t;
+
+static join_strategy_record_t record;
+static bool probing = false;  // true si este join prueba un DR más rápido que el aprendido
+
+// SNR mínimo de demodulación (dB x4) indexado por DR (DR_SF12 = 0 ... DR_SF7 = 5)
+static const int8_t SNR_FLOOR_X4[] = { -80, -70, -60, -50, -40, -30 };
+
+/**
+ * @brief Escribe el registro en NVS
+ */
+static void saveRecord() {
+    Preferences prefs;
+    if (!prefs.begin(JOIN_STRATEGY_NVS_NAMESPACE, false)) {
+        Serial.println("Join strategy: no se pudo abrir NVS");
+        return;
+    }
+    prefs.putBytes(JOIN_STRATEGY_NVS_KEY, &record, sizeof(record));
+    prefs.end();
+}
+
+void joinStrategyInit() {
+    memset(&record, 0, sizeof(record));
+    record.version = JOIN_STRATEGY_VERSION;
+    record.dr = DR_NONE;
+
+#if JOIN_STRATEGY_ENABLE
+    Preferences prefs;
+    if (prefs.begin(JOIN_STRATEGY_NVS_NAMESPACE, true)) {
+        join_strategy_record_t stored;
+        size_t len = prefs.getBytes(JOIN_STRATEGY_NVS_KEY, &stored, sizeof(stored));
+        prefs.end();
+        if (len == sizeof(stored) && stored.version == JOIN_STRATEGY_VERSION) {
+            record = stored;
+        }
+    }
+
+    if (record.dr <= DR_SF7) {
+        Serial.printf("Join strategy: último join en DR%u canal %u (rssi %d, snr %d.%02d dB)\n",
+                      record.dr, record.chnl, record.rssi,
+                      record.snr / 4, abs(record.snr % 4) * 25);
+    }
+#endif
+}
+
+void joinStrategyApply() {
+#if JOIN_STRATEGY_ENABLE
+    probing = false;
+    if (record.dr > DR_SF7) {
+        return;  // Nada aprendido: LMIC empieza en SF7 como siempre
+    }
+
+    uint8_t dr = record.dr;
+    if (dr < DR_SF7) {
+        // Decaimiento: subir un DR si sobró margen de SNR o, de vez en cuando, por sorteo
+        bool snrMargin = (record.snr - SNR_FLOOR_X4[dr]) >= JOIN_STRATEGY_SNR_MARGIN_DB * 4;
+        bool lottery = (esp_random() % JOIN_STRATEGY_PROBE_INTERVAL) == 0;
+        if (snrMargin || lottery) {
+            dr++;
+            probing = true;
+        }
+    }
+
+    LMIC_setDrTxpow((dr_t)dr, TX_POWER_DBM);
+    if (record.chnl < 3) {
+        LMIC.txChnl = record.chnl;
+    }
+    Serial.printf("Join strategy: empezando join en DR%u canal %u%s\n",
+                  dr, LMIC.txChnl, probing ? " (probando DR más rápido)" : "");
+#endif
+}
+
+void joinStrategyOnJoined() {
+#if JOIN_STRATEGY_ENABLE
+    uint8_t dr = LMIC.datarate;
+    uint8_t chnl = LMIC.txChnl;
+    bool changed = record.dr != dr || record.chnl != chnl || record.failedCycles != 0 ||
+                   abs(record.snr - LMIC.snr) >= JOIN_STRATEGY_SNR_HYSTERESIS;
+
+    if (probing && dr > record.dr) {
+        Serial.printf("Join strategy: DR%u funciona, se adopta\n", dr);
+    }
+
+    record.dr = dr;
+    record.chnl = chnl;
+    record.rssi = LMIC.rssi;
+    record.snr = LMIC.snr;
+    record.failedCycles = 0;
+
+    if (changed) {
+        saveRecord();
+    }
+#endif
+}
+
+void joinStrategyOnFailed() {
+#if JOIN_STRATEGY_ENABLE
+    if (record.dr > DR_SF7) {
+        return;
+    }
+    if (record.failedCycles < 255) {
+        record.failedCycles++;
+    }
+    if (record.failedCycles >= JOIN_STRATEGY_FORGET_AFTER) {
+        // El entorno cambió (fondeo, gateway): volver al barrido completo desde SF7
+        Serial.println("Join strategy: olvidando DR aprendido");
+        record.dr = DR_NONE;
+        record.failedCycles = 0;
+    }
+    saveRecord();
+#endif
+}
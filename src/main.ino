@@ -29,6 +29,8 @@
 #include "LoRaBoards.h"   // Configuración de hardware y pines
 #include "screen.h"       // Gestión de pantalla
 #include "ttn_decoder_generator.h"  // Generador de decoders TTN
+#include "window_stats.h" // Despertares solo de muestreo
+#include "cpu_phase.h"    // Frecuencia de CPU por fase
 #include <esp_task_wdt.h> // Watchdog timer para protección contra cuelgues
 
 /**
@@ -40,7 +42,13 @@
  */
 void setup()
 {
+    // Despertar solo de muestreo: leer el agua y volver a dormir sin radio ni pantalla
+    if (windowStatsIsSampleWake()) {
+        windowStatsSampleAndSleep();
+    }
+
     setupBoards(false);  // Configura pines y periféricos, mantiene display activo para gestión
+    cpuPhaseInit();      // Frecuencia mínima salvo en cálculo (CPU_PM_ENABLE)
     // Retraso necesario para estabilización de alimentación al encender
     delay(1500);
     Serial.println("Proyecto de Sensor LoRaWAN de Bajo Consumo Iniciando...");
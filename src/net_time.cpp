@@ -0,0 +1,128 @@
+/**
+ * @file      net_time.cpp
+ * @brief     Implementación de la hora de red con DeviceTimeReq
+ *
+ * La respuesta de la red da la hora GPS al final del uplink que llevaba la
+ * petición; se traslada al instante actual con el reloj de LMIC y se
+ * convierte a UTC. Las variables RTC_DATA_ATTR y el reloj del sistema solo
+ * se pierden con un reinicio por alimentación, y entonces se vuelve a pedir.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include <lmic.h>
+#include <esp_attr.h>
+#include <sys/time.h>
+#include "net_time.h"
+#include "wake_scheduler.h"
+#include "retained_state.h"
+#include "../config/config.h"
+
+#define NET_TIME_VERSION 1
+
+// Segundos entre la época Unix (1970-01-01) y la época GPS (1980-01-06)
+#define GPS_EPOCH_UNIX_OFFSET 315964800LL
+
+// Error de la propia sincronización: resolución de 1/256 s y latencia del DIO
+#define NET_TIME_SYNC_ERROR_MS 10UL
+
+/**
+ * @brief Estado de la hora de red conservado durante el sueño profundo
+ */
+typedef struct {
+    uint32_t syncUtc;   /**< Hora UTC de la última sincronización (0 = nunca) */
+} net_time_state_t;
+
+RETAINED_STATE(net_time_state_t, timeBlock);
+static net_time_state_t& timeState = timeBlock.state;
+
+/**
+ * @brief Milisegundos del reloj del sistema
+ */
+static int64_t nowMs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+void netTimeInit() {
+    // Sin estado válido syncUtc queda a 0: hora desconocida
+    retainedRegister(RETAINED_NET_TIME, timeBlock, NET_TIME_VERSION);
+}
+
+bool netTimeNeedsSync() {
+#if NET_TIME_ENABLE
+    return netTimeErrorMs() > NET_TIME_MAX_ERROR_MS;
+#else
+    return false;
+#endif
+}
+
+bool netTimeOnTxComplete() {
+#if NET_TIME_ENABLE
+    u4_t gpsSeconds;
+    u1_t fraction;
+    ostime_t reference;
+    if (!LMIC_getNetworkTime(&gpsSeconds, &fraction, &reference)) {
+        return false;
+    }
+
+    // Hora de red ahora = hora al final del uplink + tiempo transcurrido desde entonces
+    int64_t networkMs = ((int64_t)gpsSeconds + GPS_EPOCH_UNIX_OFFSET - NET_TIME_LEAP_SECONDS) * 1000
+                        + ((int64_t)fraction * 1000) / 256
+                        + osticks2ms(os_getTime() - reference);
+    int64_t errorMs = nowMs() - networkMs;
+    bool wasSynced = timeState.syncUtc != 0;
+
+    // Con hora previa el error medido es la deriva acumulada desde la última sincronización
+    if (wasSynced) {
+        int32_t clamped = errorMs > INT32_MAX ? INT32_MAX : errorMs < INT32_MIN ? INT32_MIN : (int32_t)errorMs;
+        wakeSchedulerOnTimeSync(clamped);
+        Serial.printf("Hora de red: error corregido %ld ms\n", (long)errorMs);
+    }
+
+    struct timeval tv;
+    tv.tv_sec = (time_t)(networkMs / 1000);
+    tv.tv_usec = (suseconds_t)((networkMs % 1000) * 1000);
+    settimeofday(&tv, NULL);
+    timeState.syncUtc = (uint32_t)tv.tv_sec;
+
+    // La primera vez solo se fija la referencia del planificador (sin error acumulado)
+    if (!wasSynced) {
+        wakeSchedulerOnTimeSync(0);
+    }
+
+    Serial.printf("Hora de red: UTC %lu\n", (unsigned long)timeState.syncUtc);
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint32_t netTimeNow() {
+    if (timeState.syncUtc == 0) {
+        return 0;
+    }
+    return (uint32_t)(nowMs() / 1000);
+}
+
+uint32_t netTimeErrorMs() {
+    uint32_t now = netTimeNow();
+    if (now == 0) {
+        return UINT32_MAX;
+    }
+    uint32_t elapsed = now > timeState.syncUtc ? now - timeState.syncUtc : 0;
+    uint64_t driftMs = (uint64_t)elapsed * NET_TIME_DRIFT_PPM / 1000;
+    uint64_t bound = NET_TIME_SYNC_ERROR_MS + driftMs;
+    return bound > UINT32_MAX ? UINT32_MAX : (uint32_t)bound;
+}
+
+uint16_t netTimeCompact(uint32_t utc) {
+    if (utc == 0) {
+        return NET_TIME_COMPACT_UNKNOWN;
+    }
+    return (uint16_t)((utc / 2) % 0xFFFFUL);
+}
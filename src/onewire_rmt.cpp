@@ -0,0 +1,351 @@
+/**
+ * @file      onewire_rmt.cpp
+ * @brief     Implementación del bus OneWire sobre el RMT (driver heredado de IDF 4.4)
+ *
+ * Ambos canales trabajan a 1 us por tick. El pin queda en drenador abierto
+ * con la salida del canal TX y la entrada del canal RX conectadas por la
+ * matriz GPIO, así que un '1' del TX es la línea liberada y el RX ve tanto
+ * los pulsos propios como los del esclavo. El RX da la captura por cerrada
+ * tras OW_RMT_RX_IDLE_US en alto, algo más que la liberación tras un reset.
+ *
+ * Una lectura del scratchpad se hace en dos transacciones (reset + ROM +
+ * comando y luego los 72 slots de lectura) para no pasar de
+ * DS18B20_RMT_MEM_BLOCKS bloques de memoria RMT; el esclavo no tiene
+ * límite de tiempo entre slots.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include "../config/config.h"
+
+#if defined(ENABLE_SENSOR_DS18B20) && DS18B20_USE_RMT
+
+#include <Arduino.h>
+#include <driver/rmt.h>
+#include <driver/gpio.h>
+#include <esp_rom_gpio.h>
+#include <soc/gpio_sig_map.h>
+#include <freertos/ringbuf.h>
+#include "onewire_rmt.h"
+#include "onewire_rmt_codec.h"
+
+#define OW_RMT_RX_IDLE_US   (OW_RMT_RESET_RELEASE_US + 20)
+#define OW_RMT_ITEM_CAPACITY (DS18B20_RMT_MEM_BLOCKS * 64 - 1)  // Deja sitio a la marca de fin
+#define OW_RMT_RX_RING_BYTES 1024
+#define OW_RMT_FILTER_TICKS 80   // Glitches de menos de 1 us (en ciclos de APB)
+
+// Comandos OneWire y DS18B20
+#define OW_CMD_SEARCH_ROM      0xF0
+#define OW_CMD_MATCH_ROM       0x55
+#define OW_CMD_SKIP_ROM        0xCC
+#define DS18B20_CMD_CONVERT    0x44
+#define DS18B20_CMD_READ_SP    0xBE
+#define DS18B20_CMD_WRITE_SP   0x4E
+
+static_assert(sizeof(onewire_rmt_item_t) == sizeof(rmt_item32_t), "Símbolo RMT con tamaño distinto");
+
+static const rmt_channel_t TX_CHANNEL = (rmt_channel_t)DS18B20_RMT_TX_CHANNEL;
+static const rmt_channel_t RX_CHANNEL = (rmt_channel_t)DS18B20_RMT_RX_CHANNEL;
+
+static bool busReady = false;
+static RingbufHandle_t rxRing = NULL;
+static rmt_item32_t txItems[OW_RMT_ITEM_CAPACITY];
+
+/**
+ * @brief Transacción lanzada y pendiente de owRmtFinish()
+ */
+static struct {
+    bool active;
+    bool capture;       /**< Se armó el canal RX */
+    bool reset;
+    uint16_t txBits;
+    uint16_t readBits;
+    uint32_t timeoutMs;
+} pending;
+
+bool owRmtBegin(uint8_t pin) {
+    if (busReady) {
+        return true;
+    }
+
+    rmt_config_t tx = RMT_DEFAULT_CONFIG_TX((gpio_num_t)pin, TX_CHANNEL);
+    tx.clk_div = 80;
+    tx.mem_block_num = DS18B20_RMT_MEM_BLOCKS;
+    tx.tx_config.idle_output_en = true;
+    tx.tx_config.idle_level = RMT_IDLE_LEVEL_HIGH;
+
+    rmt_config_t rx = RMT_DEFAULT_CONFIG_RX((gpio_num_t)pin, RX_CHANNEL);
+    rx.clk_div = 80;
+    rx.mem_block_num = DS18B20_RMT_MEM_BLOCKS;
+    rx.rx_config.filter_en = true;
+    rx.rx_config.filter_ticks_thresh = OW_RMT_FILTER_TICKS;
+    rx.rx_config.idle_threshold = OW_RMT_RX_IDLE_US;
+
+    if (rmt_config(&tx) != ESP_OK || rmt_driver_install(TX_CHANNEL, 0, 0) != ESP_OK) {
+        Serial.println("OneWire RMT: ERROR - no se pudo configurar el canal TX");
+        return false;
+    }
+    if (rmt_config(&rx) != ESP_OK || rmt_driver_install(RX_CHANNEL, OW_RMT_RX_RING_BYTES, 0) != ESP_OK ||
+        rmt_get_ringbuf_handle(RX_CHANNEL, &rxRing) != ESP_OK) {
+        Serial.println("OneWire RMT: ERROR - no se pudo configurar el canal RX");
+        rmt_driver_uninstall(TX_CHANNEL);
+        return false;
+    }
+
+    // Drenador abierto con TX y RX en el mismo pin: gpio_set_direction()
+    // devuelve el pin a GPIO simple, así que la matriz se conecta después
+    gpio_set_direction((gpio_num_t)pin, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_pull_mode((gpio_num_t)pin, GPIO_PULLUP_ONLY);
+    esp_rom_gpio_connect_out_signal(pin, RMT_SIG_OUT0_IDX + TX_CHANNEL, false, false);
+    esp_rom_gpio_connect_in_signal(pin, RMT_SIG_IN0_IDX + RX_CHANNEL, false);
+
+    busReady = true;
+    Serial.printf("OneWire RMT: bus en GPIO%u (TX canal %d, RX canal %d)\n",
+                  pin, DS18B20_RMT_TX_CHANNEL, DS18B20_RMT_RX_CHANNEL);
+    return true;
+}
+
+bool owRmtStart(bool reset, const uint8_t* tx, uint16_t txBits, uint16_t readBits) {
+    if (!busReady || pending.active) {
+        return false;
+    }
+
+    size_t count = owRmtEncode(reset, tx, txBits, readBits,
+                               (onewire_rmt_item_t*)txItems, OW_RMT_ITEM_CAPACITY);
+    if (count == 0) {
+        return false;
+    }
+
+    pending.capture = reset || readBits > 0;
+    pending.reset = reset;
+    pending.txBits = txBits;
+    pending.readBits = readBits;
+    uint32_t durationUs = count * OW_RMT_SLOT_US + (reset ? OW_RMT_RESET_LOW_US + OW_RMT_RESET_RELEASE_US : 0);
+    pending.timeoutMs = (durationUs + OW_RMT_RX_IDLE_US) / 1000 + 10;
+
+    if (pending.capture) {
+        // Descartar capturas anteriores que no se llegaron a leer
+        size_t size = 0;
+        void* stale;
+        while ((stale = xRingbufferReceive(rxRing, &size, 0)) != NULL) {
+            vRingbufferReturnItem(rxRing, stale);
+        }
+        rmt_rx_start(RX_CHANNEL, true);
+    }
+
+    if (rmt_write_items(TX_CHANNEL, txItems, count, false) != ESP_OK) {
+        if (pending.capture) {
+            rmt_rx_stop(RX_CHANNEL);
+        }
+        return false;
+    }
+    pending.active = true;
+    return true;
+}
+
+bool owRmtFinish(uint8_t* rx, bool* presence) {
+    if (!pending.active) {
+        return false;
+    }
+    pending.active = false;
+
+    TickType_t ticks = pdMS_TO_TICKS(pending.timeoutMs) + 1;
+    if (rmt_wait_tx_done(TX_CHANNEL, ticks) != ESP_OK) {
+        if (pending.capture) {
+            rmt_rx_stop(RX_CHANNEL);
+        }
+        return false;
+    }
+    if (!pending.capture) {
+        return true;
+    }
+
+    size_t size = 0;
+    rmt_item32_t* items = (rmt_item32_t*)xRingbufferReceive(rxRing, &size, ticks);
+    rmt_rx_stop(RX_CHANNEL);
+    if (items == NULL) {
+        return false;
+    }
+
+    onewire_rmt_decode_t result;
+    bool ok = owRmtDecode((const onewire_rmt_item_t*)items, size / sizeof(rmt_item32_t),
+                          pending.reset, pending.txBits, rx, pending.readBits, &result);
+    vRingbufferReturnItem(rxRing, items);
+
+    if (presence != NULL) {
+        *presence = result.presence;
+    }
+    return ok;
+}
+
+bool owRmtBusy() {
+    return pending.active;
+}
+
+bool owRmtTransaction(bool reset, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen) {
+    bool presence = false;
+    if (!owRmtStart(reset, tx, txLen * 8, rxLen * 8)) {
+        return false;
+    }
+    bool ok = owRmtFinish(rx, &presence);
+    return ok && (!reset || presence);
+}
+
+uint8_t owRmtSearch(uint8_t roms[][8], uint8_t maxDevices) {
+    const uint8_t searchCmd = OW_CMD_SEARCH_ROM;
+    uint8_t rom[8] = {0};
+    uint8_t lastDiscrepancy = 0;
+    uint8_t found = 0;
+
+    while (found < maxDevices) {
+        if (!owRmtTransaction(true, &searchCmd, 1, NULL, 0)) {
+            break;
+        }
+
+        uint8_t lastZero = 0;
+        bool failed = false;
+        for (uint8_t bitNumber = 1; bitNumber <= 64; bitNumber++) {
+            // Bit y complemento: 11 = nadie responde, 00 = discrepancia
+            uint8_t pair = 0;
+            if (!owRmtStart(false, NULL, 0, 2) || !owRmtFinish(&pair, NULL) || pair == 0x03) {
+                failed = true;
+                break;
+            }
+
+            uint8_t byteIndex = (bitNumber - 1) / 8;
+            uint8_t mask = 1 << ((bitNumber - 1) % 8);
+            uint8_t direction;
+            if (pair != 0x00) {
+                direction = pair & 0x01;
+            } else if (bitNumber < lastDiscrepancy) {
+                direction = (rom[byteIndex] & mask) ? 1 : 0;
+            } else {
+                direction = bitNumber == lastDiscrepancy ? 1 : 0;
+            }
+            if (pair == 0x00 && direction == 0) {
+                lastZero = bitNumber;
+            }
+
+            if (direction) {
+                rom[byteIndex] |= mask;
+            } else {
+                rom[byteIndex] &= ~mask;
+            }
+            if (!owRmtStart(false, &direction, 1, 0) || !owRmtFinish(NULL, NULL)) {
+                failed = true;
+                break;
+            }
+        }
+
+        if (failed || owCrc8(rom, 7) != rom[7]) {
+            Serial.println("OneWire RMT: búsqueda interrumpida (sin respuesta o CRC de ROM incorrecto)");
+            break;
+        }
+        memcpy(roms[found++], rom, 8);
+
+        lastDiscrepancy = lastZero;
+        if (lastDiscrepancy == 0) {
+            break;
+        }
+    }
+    return found;
+}
+
+// ============================================================================
+// SUBCONJUNTO DE DALLASTEMPERATURE
+// ============================================================================
+
+DallasTemperatureRmt::DallasTemperatureRmt(uint8_t pin)
+    : pin(pin), resolution(12), waitForConversion(true), deviceCount(0) {
+}
+
+void DallasTemperatureRmt::begin() {
+    deviceCount = owRmtBegin(pin) ? owRmtSearch(roms, OW_RMT_MAX_DEVICES) : 0;
+}
+
+uint8_t DallasTemperatureRmt::getDeviceCount() {
+    return deviceCount;
+}
+
+/**
+ * @brief Reset + dirección (SKIP ROM si index < 0 o hay un único sensor) + comando
+ */
+bool DallasTemperatureRmt::selectAndSend(int8_t index, uint8_t command) {
+    uint8_t frame[10];
+    uint8_t len = 0;
+    if (index < 0 || deviceCount <= 1) {
+        frame[len++] = OW_CMD_SKIP_ROM;
+    } else {
+        frame[len++] = OW_CMD_MATCH_ROM;
+        memcpy(&frame[len], roms[index], 8);
+        len += 8;
+    }
+    frame[len++] = command;
+    return owRmtTransaction(true, frame, len, NULL, 0);
+}
+
+bool DallasTemperatureRmt::setResolution(uint8_t bits) {
+    resolution = constrain(bits, 9, 12);
+    uint8_t config = ((resolution - 9) << 5) | 0x1F;
+
+    bool ok = true;
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        // Conservar las alarmas TH/TL del scratchpad
+        uint8_t scratchpad[9];
+        if (!selectAndSend(i, DS18B20_CMD_READ_SP) ||
+            !owRmtTransaction(false, NULL, 0, scratchpad, sizeof(scratchpad)) ||
+            owCrc8(scratchpad, 8) != scratchpad[8]) {
+            ok = false;
+            continue;
+        }
+        uint8_t write[3] = { scratchpad[2], scratchpad[3], config };
+        if (!selectAndSend(i, DS18B20_CMD_WRITE_SP) ||
+            !owRmtTransaction(false, write, sizeof(write), NULL, 0)) {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void DallasTemperatureRmt::setWaitForConversion(bool wait) {
+    waitForConversion = wait;
+}
+
+void DallasTemperatureRmt::requestTemperatures() {
+    if (!selectAndSend(-1, DS18B20_CMD_CONVERT)) {
+        return;
+    }
+    if (waitForConversion) {
+        delay(750 >> (12 - resolution));
+    }
+}
+
+float DallasTemperatureRmt::getTempCByIndex(uint8_t index) {
+    if (index >= deviceCount) {
+        return DEVICE_DISCONNECTED_C;
+    }
+
+    uint8_t scratchpad[9];
+    if (!selectAndSend(index, DS18B20_CMD_READ_SP) ||
+        !owRmtTransaction(false, NULL, 0, scratchpad, sizeof(scratchpad))) {
+        return DEVICE_DISCONNECTED_C;
+    }
+
+    // Un bus sin respuesta lee todo unos; todo ceros pasaría el CRC
+    bool allZero = true;
+    for (uint8_t i = 0; i < sizeof(scratchpad); i++) {
+        allZero = allZero && scratchpad[i] == 0;
+    }
+    if (allZero || owCrc8(scratchpad, 8) != scratchpad[8]) {
+        return DEVICE_DISCONNECTED_C;
+    }
+
+    // Los bits bajos no están definidos por debajo de 12 bits de resolución
+    int16_t raw = (int16_t)((scratchpad[1] << 8) | scratchpad[0]);
+    raw &= ~((1 << (12 - resolution)) - 1);
+    return raw * 0.0625f;
+}
+
+#endif // ENABLE_SENSOR_DS18B20 && DS18B20_USE_RMT
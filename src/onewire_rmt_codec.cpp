@@ -0,0 +1,143 @@
+/**
+ * @file      onewire_rmt_codec.cpp
+ * @brief     Implementación de la codificación OneWire <-> símbolos RMT
+ *
+ * Cada slot es un único símbolo (bajo + liberación) y el reset otro, así
+ * que el número de símbolos es 1 + bits escritos + lecturas. La decodificación
+ * recorre la captura acumulando el tiempo transcurrido: un pulso bajo que
+ * empieza dentro de la ventana de liberación del reset es el presence pulse
+ * y los siguientes son, en orden, los slots de la transacción.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include "onewire_rmt_codec.h"
+
+/**
+ * @brief Símbolo de un slot de escritura ('1' también sirve como lectura)
+ */
+static onewire_rmt_item_t slotItem(bool bit) {
+    onewire_rmt_item_t item;
+    uint16_t low = bit ? OW_RMT_WRITE1_LOW_US : OW_RMT_WRITE0_LOW_US;
+    item.level0 = 0;
+    item.duration0 = low;
+    item.level1 = 1;
+    item.duration1 = OW_RMT_SLOT_US - low;
+    return item;
+}
+
+size_t owRmtItemCount(bool reset, size_t txBits, size_t readBits) {
+    return (reset ? 1 : 0) + txBits + readBits;
+}
+
+size_t owRmtEncode(bool reset, const uint8_t* tx, size_t txBits, size_t readBits,
+                   onewire_rmt_item_t* out, size_t maxItems) {
+    if (out == NULL || owRmtItemCount(reset, txBits, readBits) > maxItems) {
+        return 0;
+    }
+
+    size_t n = 0;
+    if (reset) {
+        out[n].level0 = 0;
+        out[n].duration0 = OW_RMT_RESET_LOW_US;
+        out[n].level1 = 1;
+        out[n].duration1 = OW_RMT_RESET_RELEASE_US;
+        n++;
+    }
+    for (size_t i = 0; i < txBits; i++) {
+        out[n++] = slotItem((tx[i / 8] >> (i % 8)) & 0x01);
+    }
+    for (size_t i = 0; i < readBits; i++) {
+        out[n++] = slotItem(true);
+    }
+    return n;
+}
+
+bool owRmtDecode(const onewire_rmt_item_t* items, size_t count, bool reset,
+                 size_t skipSlots, uint8_t* rx, size_t readBits,
+                 onewire_rmt_decode_t* result) {
+    onewire_rmt_decode_t local = { false, 0 };
+    if (result == NULL) {
+        result = &local;
+    }
+    result->presence = false;
+    result->slots = 0;
+
+    for (size_t i = 0; i < (readBits + 7) / 8; i++) {
+        rx[i] = 0;
+    }
+
+    // Estado del recorrido: antes del reset, en su ventana de presencia o en slots
+    bool waitingReset = reset;
+    bool inPresenceWindow = false;
+    uint32_t sinceRelease = 0;
+    size_t slot = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        for (uint8_t half = 0; half < 2; half++) {
+            uint16_t duration = half == 0 ? items[i].duration0 : items[i].duration1;
+            uint8_t level = half == 0 ? items[i].level0 : items[i].level1;
+            if (duration == 0) {
+                // Marca de fin de la captura
+                return slot >= skipSlots + readBits && !waitingReset;
+            }
+
+            if (level != 0) {
+                if (inPresenceWindow) {
+                    sinceRelease += duration;
+                }
+                continue;
+            }
+
+            if (waitingReset) {
+                if (duration >= OW_RMT_RESET_MIN_US) {
+                    waitingReset = false;
+                    inPresenceWindow = true;
+                    sinceRelease = 0;
+                }
+                continue;
+            }
+
+            if (inPresenceWindow) {
+                if (sinceRelease < OW_RMT_PRESENCE_WINDOW_US) {
+                    if (duration >= OW_RMT_PRESENCE_MIN_US && duration <= OW_RMT_PRESENCE_MAX_US) {
+                        result->presence = true;
+                    }
+                    sinceRelease += duration;
+                    continue;
+                }
+                inPresenceWindow = false;
+            }
+
+            // Pulso bajo de un slot
+            if (slot >= skipSlots && slot < skipSlots + readBits) {
+                size_t bit = slot - skipSlots;
+                if (duration <= OW_RMT_READ_THRESHOLD_US) {
+                    rx[bit / 8] |= (uint8_t)(1 << (bit % 8));
+                }
+            }
+            slot++;
+            result->slots = slot;
+        }
+    }
+
+    return slot >= skipSlots + readBits && !waitingReset;
+}
+
+uint8_t owCrc8(const uint8_t* data, size_t len) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t in = data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            uint8_t mix = (crc ^ in) & 0x01;
+            crc >>= 1;
+            if (mix) {
+                crc ^= 0x8C;
+            }
+            in >>= 1;
+        }
+    }
+    return crc;
+}
@@ -38,15 +38,26 @@
 #include <esp_task_wdt.h>   // Watchdog timer
 #include "../config/config.h"         // Configuración unificada del proyecto
 #include "sensor_interface.h" // Interfaz de sensores
-
-// Declaración forward
-void turnOffDisplay();
+#include "join_backoff.h"   // Reintentos de join persistidos en RTC
+#include "join_strategy.h"  // DR de join aprendido (NVS)
+#include "clock_calibration.h" // Error de reloj medido para las ventanas RX
+#include "radio_wake.h"     // Arranque en caliente del SX1276
+#include "wake_scheduler.h" // Ranuras de envío alineadas por DevEUI
+#include "net_time.h"       // Hora UTC de red (DeviceTimeReq)
+#include "report_policy.h"  // Envío por excepción con bandas muertas
+#include "window_stats.h"   // Resúmenes estadísticos por ventana
+#include "sd_logger.h"      // Archivo binario en la tarjeta SD
+#include "retained_state.h" // Estado RTC con versión y CRC
+#include "i2c_bus.h"        // Bus I2C compartido (PMU, BME280, OLED)
+#include "acquisition.h"    // Lectura y codificación fuera de la MAC
+#include "cpu_phase.h"      // Frecuencia de CPU por fase
+#include "battery_soc.h"    // Estado de carga de la batería
 
 // Objeto global del sensor BME280
 // Ahora definido en sensor.cpp
 
 // Prototipos de funciones privadas
-void enterDeepSleep();
+void enterDeepSleep(uint32_t seconds);
 
 // ==================== CONFIGURACIÓN LoRaWAN ====================
 // Las claves de activación OTAA ahora están incluidas desde config.h
@@ -80,61 +91,29 @@ static int joinStatus = EV_JOINING;
 static const unsigned TX_INTERVAL = 30;  // No usado en bajo consumo, pero mantener para compatibilidad
 #define SLEEP_TIME_SECONDS SEND_INTERVAL_SECONDS  // Periodo entre transmisiones
 #define uS_TO_S_FACTOR 1000000ULL
+#define LORAWAN_FRAME_OVERHEAD 13  // MHDR, FHDR sin FOpts, FPort y MIC
 static String lora_msg = "";
 
-// Variables para gestión de reintentos de join
-static int joinFailCount = 0;  // Contador de joins fallidos consecutivos
-static bool inJoinBackoff = false;  // Si estamos en período de backoff
+// Lectura única del ciclo: la prepara la adquisición y la envía do_send()
+static acquisition_result_t cycle;
+static bool cycleReady = false;
+static bool joinDeferred = false;   // El join espera a la decisión de la política
 
-/**
- * @brief Determina el tiempo de backoff basado en el número de fallos consecutivos
- *
- * @param failCount Número de joins fallidos consecutivos
- * @return Tiempo en segundos para el próximo reintento
- */
-static int getJoinBackoffTime(int failCount) {
-    if (failCount <= 1) {
-        return 300;  // Esperar 5 minutos para dar más tiempo en zonas de poca cobertura
-    } else if (failCount <= 3) {
-        return 600;  // Dormir 10 minutos
-    } else if (failCount <= 5) {
-        return 1200;  // Dormir 20 minutos
-    } else {
-        return 1800;  // Dormir 30 minutos
-    }
-}
+// Sueño profundo solicitado desde onEvent(); se ejecuta en loopLMIC() fuera del callback
+static bool sleepRequested = false;
+static uint32_t sleepRequestSeconds = 0;
 
 /**
- * @brief Entrada en modo sueño ligero (light sleep) manteniendo estado
+ * @brief Solicita entrar en sueño profundo al terminar el despacho de LMIC
  *
- * Duerme por el tiempo especificado pero mantiene la RAM y el estado del programa.
- * Se usa para backoffs largos de join LoRaWAN sin perder el contador de intentos.
+ * onEvent() se ejecuta dentro del bucle de trabajos de LMIC; dormir ahí deja
+ * la cola de trabajos a medias. La petición se atiende en loopLMIC().
  *
  * @param seconds Tiempo en segundos para dormir
  */
-static void enterLightSleep(int seconds) {
-    Serial.printf("Entrando en sueño ligero por %d segundos (backoff join)...\n", seconds);
-
-    // Apagar pantalla para ahorrar energía durante el sueño
-    turnOffDisplay();
-
-    // Configurar despertar por temporizador
-    esp_sleep_enable_timer_wakeup((uint64_t)seconds * uS_TO_S_FACTOR);
-
-    // Entrar en sueño ligero (mantiene estado de RAM)
-    esp_light_sleep_start();
-
-    // Al despertar, volver a encender la pantalla si es necesario
-    Serial.println("Despertando de sueño ligero");
-}
-
-/**
- * @brief Reinicia el contador de joins fallidos
- */
-static void resetJoinFailCount() {
-    joinFailCount = 0;
-    inJoinBackoff = false;
-    Serial.println("Contador de joins fallidos reseteado");
+static void requestDeepSleep(uint32_t seconds) {
+    sleepRequested = true;
+    sleepRequestSeconds = seconds;
 }
 
 // Funciones callback de LMIC
@@ -178,12 +157,6 @@ void do_send(osjob_t *j)
     // Resetear watchdog al inicio del envío
     esp_task_wdt_reset();
     
-    // Verificar si estamos en período de backoff de join
-    if (inJoinBackoff) {
-        Serial.println(F("En período de backoff de join, esperando..."));
-        return;
-    }
-
     // Verificar estado de join
     if (joinStatus == EV_JOINING) {
         Serial.println(F("Aún no unido a la red"));
@@ -198,16 +171,20 @@ void do_send(osjob_t *j)
         return;
     }
 
+    // La adquisición puede seguir en el otro núcleo si el join fue más rápido
+    if (!cycleReady) {
+        os_setTimedCallback(&sendjob, os_getTime() + ms2osticks(DUAL_CORE_POLL_MS), do_send);
+        return;
+    }
+
     Serial.println(F("Preparando datos del sensor para envío..."));
 
     // ==================== OBTENER PAYLOAD COMPLETO ====================
-    uint8_t payload[PAYLOAD_SIZE_BYTES];  // Buffer para el payload (12 bytes para Boya V2)
-    payload_config_t payload_config = {
-        .buffer = payload,
-        .max_size = sizeof(payload),
-        .written = 0
-    };
-    uint8_t payloadSize = sensors_get_payload(&payload_config);
+    // Payload ya codificado por la adquisición (lectura instantánea o
+    // resumen de la ventana), sin releer
+    uint8_t port = cycle.port;
+    uint8_t payloadSize = cycle.payloadSize;
+    uint8_t* payload = cycle.payload;
 
     if (payloadSize == 0) {
         Serial.println("Error al obtener payload del sensor");
@@ -218,12 +195,11 @@ void do_send(osjob_t *j)
     }
 
     // ==================== OBTENER DATOS PARA DISPLAY ====================
-    sensor_data_t sensorData;
-    bool sensorOk = sensors_read_all(&sensorData);
-    float temperatura = sensorData.temperature;
-    float humedad = sensorData.humidity;
-    float presion = sensorData.pressure;
-    float bateria = sensorData.battery;
+    bool sensorOk = cycle.dataOk;
+    float temperatura = cycle.data.temperature;
+    float humedad = cycle.data.humidity;
+    float presion = cycle.data.pressure;
+    float bateria = cycle.data.battery;
 
     // ==================== INTERFAZ DE USUARIO ====================
     // Mostrar datos en pantalla OLED durante el envío (sin límite de tiempo)
@@ -235,7 +211,14 @@ void do_send(osjob_t *j)
     }
 
     // ==================== ENVÍO LoRaWAN ====================
-    LMIC_setTxData2(1, payload, payloadSize, 0);
+    // Pedir la hora solo si la cota de error por deriva supera el límite
+    if (netTimeNeedsSync()) {
+        Serial.println(F("Solicitando hora de red (DeviceTimeReq)"));
+        LMIC_requestNetworkTime();
+    }
+    wakeSchedulerMarkUplink();
+    LMIC_setTxData2(port, payload, payloadSize, 0);
+    batterySocAddTx(osticks2ms(calcAirTime(updr2rps(LMIC.datarate), payloadSize + LORAWAN_FRAME_OVERHEAD)));
 
     if (sensorOk) {
         #ifdef USE_SENSOR_DHT22
@@ -285,6 +268,19 @@ void onEvent (ev_t ev)
             // Mostrar métricas de enlace
             lora_msg = "rssi:" + String(LMIC.rssi) + " snr: " + String(LMIC.snr);
 
+            // Recalibrar el error de reloj si se recibió alguna trama
+            if ((LMIC.txrxFlags & TXRX_ACK) || LMIC.dataLen) {
+                clockCalOnDownlink();
+            }
+            clockCalReportRxOn("uplink");
+
+            // Ajustar el reloj si el downlink traía DeviceTimeAns
+            netTimeOnTxComplete();
+
+            // Referencia de la política de envío: la lectura recién enviada
+            reportPolicyOnSent();
+            windowStatsOnSent();
+
             // Verificar datos downlink
             if (LMIC.dataLen) {
                 Serial.print(F("Datos recibidos: "));
@@ -297,7 +293,7 @@ void onEvent (ev_t ev)
             showSuccess("Datos enviados!", 5000);
 
             // ==================== TRANSICIÓN A SUEÑO PROFUNDO ====================
-            enterDeepSleep();
+            requestDeepSleep(wakeSchedulerNextSleepSeconds());
             break;
 
         case EV_JOINING:
@@ -311,34 +307,23 @@ void onEvent (ev_t ev)
 
         case EV_JOIN_FAILED:
         {
-            joinFailCount++;
-            Serial.printf("Join fallido #%d - aplicando backoff\n", joinFailCount);
             lora_msg = "Unión OTAA fallida";
 
-            int backoffSeconds = getJoinBackoffTime(joinFailCount);
-            inJoinBackoff = true;
+            // Estado de reintentos persistido en RTC; el backoff se hace en sueño profundo
+            uint32_t backoffSeconds = joinBackoffOnFailed();
+            joinStrategyOnFailed();
+            clockCalOnJoinFailed();
+            clockCalReportRxOn("join fallido");
 
             // Mostrar información del backoff en pantalla
             char backoffMsg[32];
-            sprintf(backoffMsg, "Reintento en %d min", backoffSeconds / 60);
+            snprintf(backoffMsg, sizeof(backoffMsg), "Reintento en %lu min",
+                     (unsigned long)(backoffSeconds / 60));
             showWarning(backoffMsg, 3000);
 
-            Serial.printf("Esperando %d segundos antes del próximo intento de join\n", backoffSeconds);
-
-            // Si es un backoff moderado, usar callback normal
-            if (backoffSeconds <= 300) {
-                os_setTimedCallback(&sendjob, os_getTime() + sec2osticks(backoffSeconds), do_send);
-            } else {
-                // Para backoffs largos, dormir ligero y luego reiniciar join
-                delay(1000);  // Pequeño delay para mostrar mensaje
-                enterLightSleep(backoffSeconds);
-
-                // Al despertar, reiniciar LMIC y volver a intentar join
-                Serial.println("Reiniciando LMIC después de backoff");
-                LMIC_reset();
-                LMIC_startJoining();
-                os_setTimedCallback(&sendjob, os_getTime() + sec2osticks(5), do_send);
-            }
+            Serial.printf("Esperando %lu segundos en sueño profundo antes del próximo join\n",
+                          (unsigned long)backoffSeconds);
+            requestDeepSleep(backoffSeconds);
             break;
         }
 
@@ -348,7 +333,10 @@ void onEvent (ev_t ev)
             joinStatus = EV_JOINED;
 
             // Resetear contador de fallos al conectar exitosamente
-            resetJoinFailCount();
+            joinBackoffOnJoined();
+            joinStrategyOnJoined();
+            clockCalOnDownlink();
+            clockCalReportRxOn("join");
 
             // Mostrar mensaje de conexión exitosa durante 5 segundos
             // La pantalla se apagará automáticamente al expirar el mensaje
@@ -382,20 +370,22 @@ void onEvent (ev_t ev)
 /**
  * @brief     Entrada en modo sueño profundo
  *
- * Configura el temporizador ESP32 para despertar después del intervalo definido
+ * Configura el temporizador ESP32 para despertar después del tiempo indicado
  * y apaga la pantalla para maximizar el ahorro de energía.
  * NO apaga completamente el PMU para permitir el despertar por temporizador.
  *
+ * @param seconds Tiempo en segundos para dormir
+ *
  * @note      El dispositivo se reiniciará completamente al despertar
- * @warning   Toda la memoria RAM se pierde durante el sueño profundo
+ * @warning   Toda la memoria RAM se pierde durante el sueño profundo (salvo RTC_DATA_ATTR)
  */
-void enterDeepSleep() {
-    Serial.println("Entrando en sueño profundo por " + String(SLEEP_TIME_SECONDS) + " segundos...");
+void enterDeepSleep(uint32_t seconds) {
+    Serial.println("Entrando en sueño profundo por " + String(seconds) + " segundos...");
     // Apagar pantalla para ahorrar energía
     turnOffDisplayCompletely();
 
     // Configurar despertar por temporizador (RTC interno del ESP32)
-    esp_sleep_enable_timer_wakeup(SLEEP_TIME_SECONDS * uS_TO_S_FACTOR);
+    esp_sleep_enable_timer_wakeup((uint64_t)seconds * uS_TO_S_FACTOR);
 
     // NO apagar PMU completamente para evitar problemas de despertar
     // disablePeripherals();  // Comentado para permitir despertar
@@ -411,10 +401,71 @@ void enterDeepSleep() {
         // NO apagar las salidas de alimentación del PMU
     }
 
+    // Terminar las escrituras del display que sigan en cola
+    i2cBusFlush(I2C_BUS_TIMEOUT_MS);
+
+    // Tiempo del despertar a cada frecuencia de CPU
+    cpuPhaseReport();
+
+    // Cerrar el consumo del despertar para el estado de carga
+    batterySocOnSleep();
+
+    // Sellar el estado RTC de todos los módulos con su CRC
+    retainedSealAll();
+
     // Entrar en sueño profundo (reinicio completo al despertar)
     esp_deep_sleep_start();
 }
 
+/**
+ * @brief     Arranca el join OTAA con el DR aprendido y el estado de reintentos
+ */
+static void startJoin() {
+    Serial.println("Iniciando proceso de join LoRaWAN...");
+    // Iniciar el proceso de joining a la red
+    LMIC_startJoining();
+
+    // Empezar en el DR/canal del último join exitoso en lugar de barrer desde SF7
+    joinStrategyApply();
+
+    // Restaurar DevNonce y, si un ciclo quedó interrumpido, reanudar en su último DR
+    joinBackoffApply();
+}
+
+/**
+ * @brief     Recoge el resultado de la adquisición y actúa sobre él
+ *
+ * La pantalla y LMIC solo se tocan desde aquí, en el núcleo de la MAC.
+ *
+ * @return    false si el ciclo no tiene nada que enviar (sueño solicitado)
+ */
+static bool collectCycle() {
+    if (cycleReady || !acquisitionPoll(&cycle)) {
+        return true;
+    }
+    cycleReady = true;
+    Serial.printf("Adquisición completada en %lu ms\n", (unsigned long)cycle.elapsedMs);
+
+    if (!cycle.sensorsOk) {
+        showWarning("Sensor no disponible", 5000);
+        // No entramos en bucle infinito - el dispositivo debe continuar funcionando
+    } else {
+        showInfo("Sensor OK", 3000);
+    }
+
+    if (!cycle.send) {
+        showInfo("Sin cambios", 2000);
+        requestDeepSleep(wakeSchedulerNextSleepSeconds());
+        return false;
+    }
+
+    if (joinDeferred) {
+        joinDeferred = false;
+        startJoin();
+    }
+    return true;
+}
+
 // ==================== FUNCIONES PÚBLICAS ====================
 
 /**
@@ -440,25 +491,30 @@ void setupLMIC(void)
     digitalWrite(RADIO_TCXO_ENABLE, HIGH);
 #endif
 
-    // Inicializar el sistema operativo de LMIC
-    os_init();
-
-    // ==================== CONFIGURACIÓN DEL SENSOR ====================
-    // Inicializar sensor usando la interfaz unificada
-    if (!sensors_init_all()) {
-        Serial.println("ADVERTENCIA: Sensor no disponible, el dispositivo continuará funcionando y enviará datos de error");
-        showWarning("Sensor no disponible", 5000);
-        // No entramos en bucle infinito - el dispositivo debe continuar funcionando
-    } else {
-        showInfo("Sensor OK", 3000);
+    // Recuperar el estado de reintentos de join conservado en RTC
+    joinBackoffInit();
+    wakeSchedulerInit();
+    netTimeInit();
+    joinStrategyInit();
+    clockCalInit();
+
+    // Inicializar el sistema operativo de LMIC (en caliente si la radio quedó aparcada)
+    radioWakeInit();
+
+    // ==================== LECTURA Y POLÍTICA DE ENVÍO ====================
+    // Sensores, registro en SD, política de envío y codificación del payload;
+    // con DUAL_CORE_ENABLE en el otro núcleo mientras LMIC arranca el join
+    acquisitionStart();
+    if (!collectCycle()) {
+        return;
     }
 
     // ==================== CONFIGURACIÓN LoRaWAN ====================
     // Reiniciar estado MAC - descarta sesiones y transferencias pendientes
     LMIC_reset();
 
-    // Configurar tolerancia de error de reloj (1% máximo)
-    LMIC_setClockError(MAX_CLOCK_ERROR * 1 / 100);
+    // Configurar tolerancia de error de reloj (medida por dispositivo, 1% hasta calibrar)
+    clockCalApply();
 
     // Configurar canales TTN Europa (868MHz) - habilita todos los canales disponibles
     // Esto evita sobrecargar los 3 canales base de LoRaWAN
@@ -481,9 +537,14 @@ void setupLMIC(void)
     // Configurar spread factor y potencia de transmisión (aumentada para mejor alcance)
     LMIC_setDrTxpow(spreadFactor, TX_POWER_DBM);
 
-    Serial.println("Iniciando proceso de join LoRaWAN...");
-    // Iniciar el proceso de joining a la red
-    LMIC_startJoining();
+    // Si la política aún puede descartar el ciclo, esperar a su decisión
+    // para no gastar un join en balde
+    if (!cycleReady && acquisitionMaySkipUplink()) {
+        joinDeferred = true;
+        Serial.println("Join aplazado hasta la decisión de la política de envío");
+    } else {
+        startJoin();
+    }
 
     // El envío se programará en EV_JOINED después de mostrar el mensaje de conexión
     // do_send(&sendjob);
@@ -500,6 +561,22 @@ void setupLMIC(void)
 void loopLMIC(void)
 {
     os_runloop_once();  // Procesar eventos LMIC pendientes
+
+    // Resultado de la adquisición en el otro núcleo, si acaba de llegar
+    collectCycle();
+
+    // Mantener en RTC el DR y DevNonce del join en curso
+    joinBackoffTrack();
+
+    // Dormir fuera del callback de LMIC, con la radio parada y sin trabajos pendientes
+    // ni la adquisición a medias (puede estar escribiendo en la SD o en RTC)
+    if (sleepRequested && !acquisitionBusy()) {
+        sleepRequested = false;
+        LMIC_shutdown();
+        radioWakePark();
+        // Con resúmenes por ventana, despertar antes para muestrear el agua
+        enterDeepSleep(windowStatsPlanSleep(sleepRequestSeconds));
+    }
 }
 
 // Función de utilidad para leer registro (si es necesario)
@@ -0,0 +1,81 @@
+/**
+ * @file      ph_settling.cpp
+ * @brief     Implementación del detector de estabilización del pH
+ *
+ * El ajuste se hace sobre tiempos relativos a la muestra más antigua de la
+ * ventana para no perder precisión en float con tiempos largos.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include "../config/config.h"
+
+#ifdef ENABLE_SENSOR_PH
+#include <math.h>
+#include "ph_settling.h"
+
+void phSettlingReset(ph_settling_t* s) {
+    s->count = 0;
+    s->next = 0;
+    s->slopeMvPerMin = NAN;
+    s->noiseMv = NAN;
+}
+
+bool phSettlingAdd(ph_settling_t* s, uint32_t elapsedMs, float millivolts) {
+    if (isnan(millivolts)) {
+        return false;
+    }
+
+    s->timeMs[s->next] = elapsedMs;
+    s->millivolts[s->next] = millivolts;
+    s->next = (s->next + 1) % PH_SETTLE_WINDOW;
+    if (s->count < PH_SETTLE_WINDOW) {
+        s->count++;
+    }
+    if (s->count < 3) {
+        return false;
+    }
+
+    // Muestra más antigua de la ventana
+    uint8_t first = s->count < PH_SETTLE_WINDOW ? 0 : s->next;
+    uint32_t t0 = s->timeMs[first];
+
+    float meanT = 0.0f;
+    float meanV = 0.0f;
+    for (uint8_t i = 0; i < s->count; i++) {
+        meanT += (s->timeMs[i] - t0) / 60000.0f;
+        meanV += s->millivolts[i];
+    }
+    meanT /= s->count;
+    meanV /= s->count;
+
+    float sxx = 0.0f;
+    float sxy = 0.0f;
+    for (uint8_t i = 0; i < s->count; i++) {
+        float dt = (s->timeMs[i] - t0) / 60000.0f - meanT;
+        sxx += dt * dt;
+        sxy += dt * (s->millivolts[i] - meanV);
+    }
+    if (sxx <= 0.0f) {
+        return false;
+    }
+    s->slopeMvPerMin = sxy / sxx;
+
+    float sse = 0.0f;
+    for (uint8_t i = 0; i < s->count; i++) {
+        float dt = (s->timeMs[i] - t0) / 60000.0f - meanT;
+        float residual = s->millivolts[i] - (meanV + s->slopeMvPerMin * dt);
+        sse += residual * residual;
+    }
+    s->noiseMv = sqrtf(sse / (s->count - 2));
+
+    float spanMin = (elapsedMs - t0) / 60000.0f;
+    return s->count == PH_SETTLE_WINDOW &&
+           elapsedMs >= PH_SETTLE_MIN_MS &&
+           fabsf(s->slopeMvPerMin) * spanMin <= PH_SETTLE_MAX_DRIFT_MV &&
+           s->noiseMv <= PH_SETTLE_MAX_NOISE_MV;
+}
+
+#endif // ENABLE_SENSOR_PH
@@ -0,0 +1,141 @@
+/**
+ * @file      pmu_telemetry.cpp
+ * @brief     Implementación de la instantánea de registros del PMU
+ *
+ * Decodifica los registros del AXP2101 igual que XPowersAXP2101.tpp
+ * (readRegisterH5L8/H6L8 y las mismas condiciones de batería y VBUS),
+ * pero sobre los bytes de las dos ráfagas.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include "pmu_telemetry.h"
+#include "LoRaBoards.h"
+#include "i2c_bus.h"
+
+#ifdef HAS_PMU
+// Ráfagas del AXP2101
+#define PMU_STATUS_FIRST  XPOWERS_AXP2101_STATUS1             // 0x00-0x01
+#define PMU_STATUS_LEN    2
+#define PMU_DATA_FIRST    XPOWERS_AXP2101_ADC_DATA_RELUST0    // 0x34-0x4A: ADC ... INTSTS3
+#define PMU_DATA_LEN      (XPOWERS_AXP2101_INTSTS3 - XPOWERS_AXP2101_ADC_DATA_RELUST0 + 1)
+
+static pmu_telemetry_t snapshot;
+static bool snapshotValid = false;
+static portMUX_TYPE snapshotMux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Byte de la ráfaga de datos por dirección de registro
+ */
+static uint8_t dataReg(const uint8_t* data, uint8_t reg) {
+    return data[reg - PMU_DATA_FIRST];
+}
+
+static uint16_t h5l8(const uint8_t* data, uint8_t highReg) {
+    return (uint16_t)(((dataReg(data, highReg) & 0x1F) << 8) | dataReg(data, highReg + 1));
+}
+
+static uint16_t h6l8(const uint8_t* data, uint8_t highReg) {
+    return (uint16_t)(((dataReg(data, highReg) & 0x3F) << 8) | dataReg(data, highReg + 1));
+}
+
+/**
+ * @brief Lee el AXP2101 en dos ráfagas
+ */
+static bool readAxp2101(pmu_telemetry_t* t) {
+    uint8_t status[PMU_STATUS_LEN];
+    uint8_t data[PMU_DATA_LEN];
+    if (!i2cBusReadRegs(AXP2101_SLAVE_ADDRESS, PMU_STATUS_FIRST, status, sizeof(status)) ||
+        !i2cBusReadRegs(AXP2101_SLAVE_ADDRESS, PMU_DATA_FIRST, data, sizeof(data))) {
+        return false;
+    }
+
+    t->batteryPresent = (status[0] >> 3) & 0x01;
+    // VBUS bueno (STATUS1 bit 5) y sin limitación de entrada (STATUS2 bit 3)
+    t->vbusIn = ((status[0] >> 5) & 0x01) && !((status[1] >> 3) & 0x01);
+    t->charging = (status[1] >> 5) == 0x01;
+    t->chargerStatus = status[1] & 0x07;
+
+    t->batteryMv = t->batteryPresent ? h5l8(data, XPOWERS_AXP2101_ADC_DATA_RELUST0) : 0;
+    t->vbusMv = t->vbusIn ? h6l8(data, XPOWERS_AXP2101_ADC_DATA_RELUST4) : 0;
+    t->systemMv = h6l8(data, XPOWERS_AXP2101_ADC_DATA_RELUST6);
+    t->dieTempC = XPOWERS_AXP2101_CONVERSION(h6l8(data, XPOWERS_AXP2101_ADC_DATA_RELUST8));
+    t->irqStatus = ((uint32_t)dataReg(data, XPOWERS_AXP2101_INTSTS1) << 16) |
+                   ((uint32_t)dataReg(data, XPOWERS_AXP2101_INTSTS2) << 8) |
+                   dataReg(data, XPOWERS_AXP2101_INTSTS3);
+    return true;
+}
+
+/**
+ * @brief Lee un PMU que no es AXP2101 con los getters de XPowersLib
+ */
+static bool readGeneric(pmu_telemetry_t* t) {
+    t->batteryPresent = PMU->isBatteryConnect();
+    t->vbusIn = PMU->isVbusIn();
+    t->charging = PMU->isCharging();
+    t->chargerStatus = 0;
+    t->batteryMv = PMU->getBattVoltage();
+    t->vbusMv = PMU->getVbusVoltage();
+    t->systemMv = PMU->getSystemVoltage();
+#if PMU_MODEL == PMU_MODEL_PROBE
+    t->dieTempC = NAN;  // XPowersLibInterface no expone la temperatura
+#else
+    t->dieTempC = PMU->getTemperature();
+#endif
+    t->irqStatus = (uint32_t)PMU->getIrqStatus();
+    return true;
+}
+#endif
+
+bool pmuTelemetryRead(pmu_telemetry_t* out, uint32_t maxAgeMs) {
+#ifdef HAS_PMU
+    if (!PMU || !out) {
+        return false;
+    }
+
+    uint32_t now = millis();
+    portENTER_CRITICAL(&snapshotMux);
+    bool fresh = snapshotValid && maxAgeMs > 0 && now - snapshot.takenMs <= maxAgeMs;
+    if (fresh) {
+        *out = snapshot;
+    }
+    portEXIT_CRITICAL(&snapshotMux);
+    if (fresh) {
+        return true;
+    }
+
+    pmu_telemetry_t t;
+    bool ok = PMU_IS_AXP2101() ? readAxp2101(&t) : readGeneric(&t);
+    if (!ok) {
+        Serial.println("PMU: ERROR - lectura de registros fallida");
+        return false;
+    }
+    t.takenMs = now;
+
+    portENTER_CRITICAL(&snapshotMux);
+    snapshot = t;
+    snapshotValid = true;
+    portEXIT_CRITICAL(&snapshotMux);
+
+    Serial.printf("PMU: bat %u mV, VBUS %u mV, sist %u mV, %.1f C, %s, IRQ 0x%06lx\n",
+                  t.batteryMv, t.vbusMv, t.systemMv, t.dieTempC,
+                  t.charging ? "cargando" : "sin carga", (unsigned long)t.irqStatus);
+    *out = t;
+    return true;
+#else
+    (void)out;
+    (void)maxAgeMs;
+    return false;
+#endif
+}
+
+void pmuTelemetryInvalidate() {
+#ifdef HAS_PMU
+    portENTER_CRITICAL(&snapshotMux);
+    snapshotValid = false;
+    portEXIT_CRITICAL(&snapshotMux);
+#endif
+}
@@ -0,0 +1,74 @@
+/**
+ * @file      radio_wake.cpp
+ * @brief     Implementación del arranque en caliente del SX1276
+ *
+ * La línea NSS se mantiene en alto durante el sueño profundo (gpio hold)
+ * para que el ruido en el bus SPI no modifique registros de la radio.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include <lmic.h>
+#include <esp_sleep.h>
+#include <esp_attr.h>
+#include <driver/gpio.h>
+#include "radio_wake.h"
+#include "retained_state.h"
+#include "../config/config.h"
+
+#define RADIO_WAKE_VERSION 1
+
+/**
+ * @brief Estado de la radio conservado durante el sueño profundo
+ */
+typedef struct {
+    uint8_t  parked;    /**< 1 si la radio quedó en sleep con su configuración */
+    uint8_t  calValid;  /**< 1 si calTemp se midió en un arranque completo */
+    int8_t   calTemp;   /**< Temperatura de la radio en el último arranque completo */
+} radio_wake_state_t;
+
+RETAINED_STATE(radio_wake_state_t, radioBlock);
+static radio_wake_state_t& radioState = radioBlock.state;
+
+void radioWakeInit() {
+    // Liberar NSS, retenido en alto durante el sueño profundo
+    gpio_hold_dis((gpio_num_t)RADIO_CS_PIN);
+
+    bool restored = retainedRegister(RETAINED_RADIO_WAKE, radioBlock, RADIO_WAKE_VERSION);
+    bool canWarm = RADIO_WARM_START &&
+                   restored &&
+                   radioState.parked &&
+                   radioState.calValid &&
+                   esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER;
+    radioState.parked = 0;
+
+    uint32_t start = micros();
+    if (canWarm && os_init_warm(radioState.calTemp, RADIO_WARM_MAX_TEMP_DRIFT)) {
+        Serial.printf("Radio: arranque en caliente en %lu us\n", (unsigned long)(micros() - start));
+        return;
+    }
+
+    if (!canWarm) {
+        os_init();
+    }
+    // Si os_init_warm() falló ya hizo el arranque completo; registrar la nueva referencia
+    radioState.calValid = 1;
+    radioState.calTemp = radio_temp();
+    Serial.printf("Radio: arranque completo en %lu us (temperatura radio %d)\n",
+                  (unsigned long)(micros() - start), radioState.calTemp);
+}
+
+void radioWakePark() {
+#if RADIO_WARM_START
+    // LMIC_shutdown()/LMIC_reset() dejan la radio en sleep; conservar NSS en alto
+    digitalWrite(RADIO_CS_PIN, HIGH);
+    gpio_hold_en((gpio_num_t)RADIO_CS_PIN);
+    gpio_deep_sleep_hold_en();
+    // En los despertares de muestreo radioWakeInit() no se ha ejecutado
+    retainedRegister(RETAINED_RADIO_WAKE, radioBlock, RADIO_WAKE_VERSION);
+    radioState.parked = 1;
+#endif
+}
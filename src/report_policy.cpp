@@ -0,0 +1,162 @@
+/**
+ * @file      report_policy.cpp
+ * @brief     Implementación del envío por excepción con bandas muertas
+ *
+ * La referencia es el último valor entregado, no el último leído: una
+ * deriva lenta acaba superando la banda muerta y se envía.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <esp_attr.h>
+#include "report_policy.h"
+#include "retained_state.h"
+
+#define REPORT_POLICY_VERSION 1
+
+// Ciclos silenciosos tras los que se fuerza un uplink de latido
+#define REPORT_MAX_SILENT_CYCLES (REPORT_HEARTBEAT_SECONDS / SEND_INTERVAL_SECONDS)
+
+/**
+ * @brief Canal comparado por la política
+ */
+typedef struct {
+    const char* name;   /**< Nombre para el log */
+    size_t offset;      /**< Posición del valor en sensor_data_t */
+    float deadband;     /**< Cambio mínimo que justifica un uplink */
+    float error;        /**< Valor de lectura fallida */
+} report_channel_t;
+
+static const report_channel_t CHANNELS[] = {
+    { "batería",   offsetof(sensor_data_t, battery),        REPORT_DEADBAND_BATTERY,     SENSOR_ERROR_BATTERY },
+#if SYSTEM_HAS_PH
+    { "pH",        offsetof(sensor_data_t, ph),             REPORT_DEADBAND_PH,          SENSOR_ERROR_PH },
+#endif
+#if SYSTEM_HAS_TEMPERATURE
+    { "temp_ext",  offsetof(sensor_data_t, temperature),    REPORT_DEADBAND_TEMPERATURE, SENSOR_ERROR_TEMPERATURE },
+#endif
+#if SYSTEM_HAS_TEMP_1M
+    { "temp_1m",   offsetof(sensor_data_t, temperature_1m), REPORT_DEADBAND_TEMP_1M,     SENSOR_ERROR_TEMPERATURE },
+#endif
+#if SYSTEM_HAS_HUMIDITY
+    { "humedad",   offsetof(sensor_data_t, humidity),       REPORT_DEADBAND_HUMIDITY,    SENSOR_ERROR_HUMIDITY },
+#endif
+#if SYSTEM_HAS_PRESSURE
+    { "presión",   offsetof(sensor_data_t, pressure),       REPORT_DEADBAND_PRESSURE,    SENSOR_ERROR_PRESSURE },
+#endif
+};
+
+#define REPORT_CHANNEL_COUNT (sizeof(CHANNELS) / sizeof(CHANNELS[0]))
+
+/**
+ * @brief Estado de la política conservado durante el sueño profundo
+ */
+typedef struct {
+    uint16_t silentCycles; /**< Ciclos sin uplink desde la última entrega */
+    uint8_t  hasSent;      /**< 1 si lastSent contiene una lectura entregada */
+    sensor_data_t lastSent; /**< Última lectura entregada */
+} report_policy_state_t;
+
+RETAINED_STATE(report_policy_state_t, policyBlock);
+static report_policy_state_t& policyState = policyBlock.state;
+
+// Lectura del ciclo pendiente de confirmar en EV_TXCOMPLETE
+static sensor_data_t pending;
+static bool hasPending = false;
+
+/**
+ * @brief Valor de un canal dentro de la lectura
+ */
+static float channelValue(const sensor_data_t* data, const report_channel_t* ch) {
+    return *(const float*)((const uint8_t*)data + ch->offset);
+}
+
+#if SYSTEM_HAS_PH
+/**
+ * @brief true si el pH está fuera del rango normal
+ */
+static bool phOutOfRange(float ph) {
+    return ph != SENSOR_ERROR_PH && (ph < REPORT_PH_ALARM_LOW || ph > REPORT_PH_ALARM_HIGH);
+}
+#endif
+
+void reportPolicyInit() {
+    // Sin estado válido hasSent queda a 0 y el primer ciclo siempre envía
+    retainedRegister(RETAINED_REPORT_POLICY, policyBlock, REPORT_POLICY_VERSION);
+    hasPending = false;
+}
+
+bool reportPolicyShouldSend(const sensor_data_t* data) {
+    pending = *data;
+    hasPending = true;
+
+#if !REPORT_BY_EXCEPTION
+    return true;
+#else
+    if (!policyState.hasSent) {
+        Serial.println("Política: primer envío");
+        return true;
+    }
+    if (policyState.silentCycles + 1 >= REPORT_MAX_SILENT_CYCLES) {
+        Serial.printf("Política: latido tras %u ciclos sin envío\n", policyState.silentCycles);
+        return true;
+    }
+
+#if SYSTEM_HAS_PH
+    // Cruzar los umbrales de alarma (en cualquier sentido) fuerza el envío
+    if (!isnan(data->ph) && phOutOfRange(data->ph) != phOutOfRange(policyState.lastSent.ph)) {
+        Serial.printf("Política: pH %.2f cruza el umbral de alarma\n", data->ph);
+        return true;
+    }
+#endif
+
+    for (uint8_t i = 0; i < REPORT_CHANNEL_COUNT; i++) {
+        const report_channel_t* ch = &CHANNELS[i];
+        float now = channelValue(data, ch);
+        float last = channelValue(&policyState.lastSent, ch);
+
+        // Canal no leído en este ciclo (muestreo multifrecuencia): nada que comparar
+        if (isnan(now)) {
+            continue;
+        }
+
+        // Un sensor que falla o se recupera es un cambio significativo
+        if ((now == ch->error) != (last == ch->error)) {
+            Serial.printf("Política: %s cambia de estado\n", ch->name);
+            return true;
+        }
+        if (now != ch->error && fabsf(now - last) >= ch->deadband) {
+            Serial.printf("Política: %s %.2f -> %.2f supera la banda muerta %.2f\n",
+                          ch->name, last, now, ch->deadband);
+            return true;
+        }
+    }
+
+    policyState.silentCycles++;
+    hasPending = false;
+    Serial.printf("Política: sin cambios significativos, uplink omitido (%u/%u)\n",
+                  policyState.silentCycles, (unsigned)REPORT_MAX_SILENT_CYCLES);
+    return false;
+#endif
+}
+
+void reportPolicyOnSent() {
+    if (!hasPending) {
+        return;
+    }
+    // Los canales no leídos en el ciclo conservan el último valor entregado
+    for (uint8_t i = 0; i < REPORT_CHANNEL_COUNT; i++) {
+        const report_channel_t* ch = &CHANNELS[i];
+        if (isnan(channelValue(&pending, ch))) {
+            *(float*)((uint8_t*)&pending + ch->offset) = channelValue(&policyState.lastSent, ch);
+        }
+    }
+    policyState.lastSent = pending;
+    policyState.hasSent = 1;
+    policyState.silentCycles = 0;
+    hasPending = false;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file      retained_state.cpp
+ * @brief     Implementación del registro de estado retenido en memoria RTC
+ *
+ * Tras un power-on la memoria RTC sin inicializar contiene basura que podría
+ * pasar la comprobación por casualidad, así que en ese arranque todos los
+ * bloques se reinician sin mirar el CRC. El sueño profundo, un brown-out o
+ * un watchdog conservan esa memoria y el CRC decide si el contenido es
+ * utilizable. Como nadie la pone a cero, un bloque que no pasa la
+ * comprobación se borra aquí antes de entregarlo al módulo. El CRC usa la
+ * tabla de la ROM del ESP32 (esp_rom_crc32_le).
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include <esp_system.h>
+#include <stddef.h>
+#include <esp_rom_crc.h>
+#include "retained_state.h"
+
+#define RETAINED_MAGIC 0x52544E44UL  // "RTND"
+
+/**
+ * @brief Entrada del registro de este arranque
+ */
+typedef struct {
+    retained_header_t* header;  /**< Cabecera en memoria RTC (NULL = sin registrar) */
+    void* state;                /**< Estado del módulo */
+    bool restored;              /**< Resultado de la validación */
+} retained_entry_t;
+
+static retained_entry_t entries[RETAINED_ID_COUNT];
+
+/**
+ * @brief CRC-32 de la cabecera (sin el campo crc) seguida del estado
+ */
+static uint32_t blockCrc(const retained_header_t* header, const void* state) {
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t*)header, offsetof(retained_header_t, crc));
+    return esp_rom_crc32_le(crc, (const uint8_t*)state, header->size);
+}
+
+/**
+ * @brief true si la memoria RTC sin inicializar no sobrevivió al reinicio
+ */
+static bool isColdStart() {
+    esp_reset_reason_t reason = esp_reset_reason();
+    return reason == ESP_RST_POWERON || reason == ESP_RST_UNKNOWN;
+}
+
+bool retainedRegisterRaw(retained_id_t id, retained_header_t* header, void* state,
+                         uint16_t size, uint16_t version) {
+    if (id >= RETAINED_ID_COUNT) {
+        return false;
+    }
+    retained_entry_t* entry = &entries[id];
+    if (entry->header == header) {
+        return entry->restored;
+    }
+
+    const char* reason = NULL;
+    if (isColdStart()) {
+        reason = "arranque en frío";
+    } else if (header->magic != RETAINED_MAGIC || header->id != id) {
+        reason = "sin inicializar";
+    } else if (header->version != version || header->size != size) {
+        reason = "versión distinta";
+    } else if (header->crc != blockCrc(header, state)) {
+        reason = "CRC incorrecto";
+    }
+
+    if (reason != NULL) {
+        memset(state, 0, size);
+        header->magic = RETAINED_MAGIC;
+        header->id = id;
+        header->version = version;
+        header->size = size;
+        header->reserved = 0;
+        header->crc = blockCrc(header, state);
+        Serial.printf("Estado RTC %u reiniciado (%s)\n", (unsigned)id, reason);
+    }
+
+    entry->header = header;
+    entry->state = state;
+    entry->restored = reason == NULL;
+    return entry->restored;
+}
+
+void retainedCommit(retained_id_t id) {
+    if (id < RETAINED_ID_COUNT && entries[id].header != NULL) {
+        entries[id].header->crc = blockCrc(entries[id].header, entries[id].state);
+    }
+}
+
+void retainedSealAll() {
+    for (uint8_t i = 0; i < RETAINED_ID_COUNT; i++) {
+        retainedCommit((retained_id_t)i);
+    }
+}
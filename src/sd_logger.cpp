@@ -0,0 +1,266 @@
+/**
+ * @file      sd_logger.cpp
+ * @brief     Implementación del archivo binario por bloques en la tarjeta SD
+ *
+ * El bloque en curso vive en memoria RTC, así que sobrevive al sueño
+ * profundo y solo se pierde (como mucho un bloque) con un corte de
+ * alimentación. El archivo se crea una vez con su tamaño final; después
+ * cada escritura sobrescribe un sector completo sin cambiar el tamaño.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include <esp_attr.h>
+#include "sd_logger.h"
+#include "retained_state.h"
+#include "LoRaBoards.h"
+
+#if SD_LOG_ENABLE && defined(HAS_SDCARD)
+
+#if defined(ENABLE_SENSOR_DS18B20) && (DS18B20_DATA_PIN == SDCARD_MOSI || DS18B20_POWER_PIN == SDCARD_CS)
+#error "SD_LOG_ENABLE: los pines de la SD coinciden con los del DS18B20 (ver sensor_ds18b20.h)"
+#endif
+#if defined(ENABLE_SENSOR_PH) && PH_POWER_PIN == SDCARD_CS
+#error "SD_LOG_ENABLE: el CS de la SD coincide con PH_POWER_PIN (ver sensor_ph.h)"
+#endif
+
+#define SD_LOG_MAGIC        0x474F4C42UL  // "BLOG" en little-endian
+#define SD_LOG_VERSION      1
+#define SD_LOG_STATE_VERSION 1
+
+#define SD_LOG_BLOCK_SIZE   512
+#define SD_LOG_HEADER_SIZE  16
+#define SD_LOG_CRC_SIZE     4
+#define SD_LOG_RECORD_SIZE  18
+#define SD_LOG_RECORDS_PER_BLOCK ((SD_LOG_BLOCK_SIZE - SD_LOG_HEADER_SIZE - SD_LOG_CRC_SIZE) / SD_LOG_RECORD_SIZE)
+
+// Bits de validez de cada campo del registro
+#define SD_LOG_HAS_PH        0x01
+#define SD_LOG_HAS_TEMP_1M   0x02
+#define SD_LOG_HAS_TEMP      0x04
+#define SD_LOG_HAS_HUMIDITY  0x08
+#define SD_LOG_HAS_PRESSURE  0x10
+#define SD_LOG_HAS_BATTERY   0x20
+
+/**
+ * @brief Estado del archivo conservado durante el sueño profundo
+ */
+typedef struct {
+    uint32_t nextBlock;    /**< Índice del bloque en curso dentro del archivo */
+    uint32_t nextSeq;      /**< Secuencia del bloque en curso */
+    uint8_t  located;      /**< 1 si nextBlock/nextSeq se recuperaron de la tarjeta */
+    uint8_t  count;        /**< Registros en el bloque en curso */
+    uint8_t  block[SD_LOG_BLOCK_SIZE];  /**< Bloque en curso */
+} sd_log_state_t;
+
+RETAINED_STATE(sd_log_state_t, logBlock);
+static sd_log_state_t& logState = logBlock.state;
+
+/**
+ * @brief CRC-32 IEEE (el mismo que zlib.crc32 en la herramienta de host)
+ */
+static uint32_t crc32(const uint8_t* data, size_t len) {
+    uint32_t crc = 0xFFFFFFFFUL;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static void putU16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void putU32(uint8_t* p, uint32_t v) {
+    putU16(p, v & 0xFFFF);
+    putU16(p + 2, v >> 16);
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Codifica un valor escalado en 16 bits y marca su bit de validez
+ */
+static void putScaled(uint8_t* p, float value, float error, float scale, uint8_t bit, uint8_t* flags) {
+    if (value == error || isnan(value)) {
+        putU16(p, 0);
+        return;
+    }
+    putU16(p, (uint16_t)(int16_t)lroundf(value * scale));
+    *flags |= bit;
+}
+
+/**
+ * @brief Monta la tarjeta SD
+ */
+static bool mountCard() {
+#if defined(SD_SHARE_SPI_BUS)
+    return SD.begin(SDCARD_CS);
+#else
+    // En los despertares de muestreo setupBoards() no se ha ejecutado
+    SDCardSPI.begin(SDCARD_SCLK, SDCARD_MISO, SDCARD_MOSI);
+    return SD.begin(SDCARD_CS, SDCardSPI);
+#endif
+}
+
+/**
+ * @brief Abre el archivo del registro, creándolo con su tamaño final si hace falta
+ */
+static File openArchive() {
+    const uint32_t size = (uint32_t)SD_LOG_FILE_BLOCKS * SD_LOG_BLOCK_SIZE;
+
+    if (SD.exists(SD_LOG_PATH)) {
+        File file = SD.open(SD_LOG_PATH, "r+");
+        if (file && file.size() == size) {
+            return file;
+        }
+        if (file) {
+            file.close();
+        }
+    }
+
+    // Preasignar a ceros una sola vez: después no cambia ni el tamaño ni la cadena de clústeres
+    Serial.printf("SD: creando %s de %lu KB\n", SD_LOG_PATH, (unsigned long)(size / 1024));
+    File file = SD.open(SD_LOG_PATH, FILE_WRITE);
+    if (!file) {
+        return file;
+    }
+    uint8_t zeros[SD_LOG_BLOCK_SIZE];
+    memset(zeros, 0, sizeof(zeros));
+    for (uint32_t i = 0; i < SD_LOG_FILE_BLOCKS; i++) {
+        if (file.write(zeros, sizeof(zeros)) != sizeof(zeros)) {
+            Serial.println("SD: tarjeta llena al preasignar");
+            file.close();
+            return File();
+        }
+    }
+    file.close();
+    logState.nextBlock = 0;
+    logState.nextSeq = 1;
+    logState.located = 1;
+    return SD.open(SD_LOG_PATH, "r+");
+}
+
+/**
+ * @brief Busca el último bloque válido para continuar tras un corte de alimentación
+ */
+static void locateNextBlock(File& file) {
+    uint8_t block[SD_LOG_BLOCK_SIZE];
+    uint32_t bestSeq = 0;
+    uint32_t bestIndex = 0;
+
+    for (uint32_t i = 0; i < SD_LOG_FILE_BLOCKS; i++) {
+        if (!file.seek(i * SD_LOG_BLOCK_SIZE) || file.read(block, sizeof(block)) != sizeof(block)) {
+            break;
+        }
+        if (getU32(block) != SD_LOG_MAGIC) {
+            continue;
+        }
+        uint32_t crc = getU32(&block[SD_LOG_BLOCK_SIZE - SD_LOG_CRC_SIZE]);
+        if (crc != crc32(block, SD_LOG_BLOCK_SIZE - SD_LOG_CRC_SIZE)) {
+            continue;
+        }
+        uint32_t seq = getU32(&block[4]);
+        if (seq > bestSeq) {
+            bestSeq = seq;
+            bestIndex = i;
+        }
+    }
+
+    logState.nextSeq = bestSeq + 1;
+    logState.nextBlock = bestSeq ? (bestIndex + 1) % SD_LOG_FILE_BLOCKS : 0;
+    logState.located = 1;
+    Serial.printf("SD: continuando en bloque %lu (secuencia %lu)\n",
+                  (unsigned long)logState.nextBlock, (unsigned long)logState.nextSeq);
+}
+
+/**
+ * @brief Cierra el bloque en curso (cabecera y CRC) y lo escribe en su sector
+ */
+static bool writeBlock() {
+    uint8_t* block = logState.block;
+    putU32(&block[0], SD_LOG_MAGIC);
+    putU32(&block[4], logState.nextSeq);
+    block[8] = SD_LOG_VERSION;
+    block[9] = SD_LOG_RECORD_SIZE;
+    block[10] = logState.count;
+    block[11] = 0;
+    putU32(&block[12], 0);
+    putU32(&block[SD_LOG_BLOCK_SIZE - SD_LOG_CRC_SIZE],
+           crc32(block, SD_LOG_BLOCK_SIZE - SD_LOG_CRC_SIZE));
+
+    uint32_t start = millis();
+    if (!mountCard()) {
+        Serial.println("SD: no se pudo montar la tarjeta");
+        return false;
+    }
+
+    bool ok = false;
+    File file = openArchive();
+    if (file) {
+        if (!logState.located) {
+            locateNextBlock(file);
+            // La secuencia ya está en la cabecera: recalcularla con la recuperada
+            putU32(&block[4], logState.nextSeq);
+            putU32(&block[SD_LOG_BLOCK_SIZE - SD_LOG_CRC_SIZE],
+                   crc32(block, SD_LOG_BLOCK_SIZE - SD_LOG_CRC_SIZE));
+        }
+        ok = file.seek(logState.nextBlock * SD_LOG_BLOCK_SIZE) &&
+             file.write(block, SD_LOG_BLOCK_SIZE) == SD_LOG_BLOCK_SIZE;
+        file.close();
+    }
+    SD.end();
+
+    Serial.printf("SD: bloque %lu (secuencia %lu, %u registros) %s en %lu ms\n",
+                  (unsigned long)logState.nextBlock, (unsigned long)logState.nextSeq,
+                  logState.count, ok ? "escrito" : "FALLIDO",
+                  (unsigned long)(millis() - start));
+    return ok;
+}
+
+void sdLogAppend(const sensor_data_t* data) {
+    // Un estado no válido queda a cero: bloque vacío y posición por localizar
+    retainedRegister(RETAINED_SD_LOGGER, logBlock, SD_LOG_STATE_VERSION);
+
+    uint8_t* rec = &logState.block[SD_LOG_HEADER_SIZE + logState.count * SD_LOG_RECORD_SIZE];
+    uint8_t flags = 0;
+    putU32(&rec[0], data->timestamp);
+    putScaled(&rec[4],  data->ph,             SENSOR_ERROR_PH,          100.0f, SD_LOG_HAS_PH,       &flags);
+    putScaled(&rec[6],  data->temperature_1m, SENSOR_ERROR_TEMPERATURE, 100.0f, SD_LOG_HAS_TEMP_1M,  &flags);
+    putScaled(&rec[8],  data->temperature,    SENSOR_ERROR_TEMPERATURE, 100.0f, SD_LOG_HAS_TEMP,     &flags);
+    putScaled(&rec[10], data->humidity,       SENSOR_ERROR_HUMIDITY,    100.0f, SD_LOG_HAS_HUMIDITY, &flags);
+    putScaled(&rec[12], data->pressure,       SENSOR_ERROR_PRESSURE,    10.0f,  SD_LOG_HAS_PRESSURE, &flags);
+    putScaled(&rec[14], data->battery,        SENSOR_ERROR_BATTERY,     1000.0f, SD_LOG_HAS_BATTERY, &flags);
+    rec[16] = flags;
+    rec[17] = 0;
+    logState.count++;
+
+    if (logState.count < SD_LOG_RECORDS_PER_BLOCK) {
+        return;
+    }
+
+    // Si la escritura falla el bloque se descarta: no bloquear el muestreo
+    if (writeBlock()) {
+        logState.nextBlock = (logState.nextBlock + 1) % SD_LOG_FILE_BLOCKS;
+        logState.nextSeq++;
+    }
+    logState.count = 0;
+    memset(logState.block, 0, sizeof(logState.block));
+}
+
+#else
+
+void sdLogAppend(const sensor_data_t* data) {
+    (void)data;
+}
+
+#endif // SD_LOG_ENABLE && HAS_SDCARD
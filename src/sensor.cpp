@@ -11,44 +11,102 @@
 
 #include "../config/config.h"  // Configuracion unificada del proyecto
 #include "sensor_interface.h"  // Interfaz generica de sensores
+#include "sensor_registry.h"  // Lista de sensores habilitados
 #include "LoRaBoards.h"  // Para readBatteryVoltage y batteryPercentFromVoltage
+#include "net_time.h"  // Hora UTC de red para sellar las muestras
+#include "wake_scheduler.h"  // Indice de ciclo para el muestreo multifrecuencia
+#include "sensor_health.h"  // Salud de sensores y re-sondeo con backoff
+#include "battery_soc.h"  // Estado de carga estimado
+#include <esp_sleep.h>
 
 // Declaracion externa para funciones de carga solar
 extern bool isSolarChargingBattery();
 
+static_assert(SensorRegistry::PAYLOAD_BYTES == 2 * SensorPayload::COUNT,
+              "PAYLOAD_BYTES de algun sensor no coincide con sus campos");
+// La mascara de presencia tiene un bit por posicion del payload
+static_assert(!SENSOR_MULTIRATE_ENABLE || SensorRegistry::FIELD_COUNT <= 8,
+              "Demasiados campos para la mascara de presencia de 1 byte");
+static_assert(SensorRegistry::COUNT <= SENSOR_HEALTH_MAX, "Demasiados sensores para sensor_health");
+static_assert(!SENSOR_HEALTH_IN_PAYLOAD || SensorRegistry::COUNT <= 4,
+              "El byte de salud solo admite cuatro sensores");
+
+// Un bit por sensor del registro
+#define REGISTRY_MASK ((1UL << SensorRegistry::COUNT) - 1)
+
+// Sensores leidos en este ciclo sin estabilizar (salen como degradados en el payload)
+static uint32_t unstable_mask = 0;
+
 // ============================================================================
 // FUNCIONES PARA GESTIONAR TODOS LOS SENSORES
 // ============================================================================
 
 /**
- * @brief Inicializa todos los sensores habilitados
- * @return true si al menos un sensor se inicializo correctamente
+ * @brief Sensores que tocan en este despertar (uno por ciclo de envio)
+ *
+ * Tras un power-on o reset se leen todos para que el primer envio sea completo.
+ * @return Mascara con un bit por sensor del registro
  */
-bool sensors_init_all(void) {
-    bool any_init = false;
-    
-#ifdef ENABLE_SENSOR_BME280
-    if (sensor_bme280_init()) {
-        Serial.println("BME280 inicializado");
-        any_init = true;
+static uint32_t due_mask(void) {
+#if SENSOR_MULTIRATE_ENABLE
+    static bool planned = false;
+    static uint32_t mask = SENSOR_MASK_ALL;
+
+    if (!planned) {
+        if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER) {
+            uint32_t cycle = wakeSchedulerCycleIndex() % SensorRegistry::HYPERPERIOD;
+            mask = SensorRegistry::dueMask(cycle);
+            Serial.printf("Sensores: ciclo %lu/%lu, mascara 0x%02lX\n", (unsigned long)cycle,
+                          (unsigned long)SensorRegistry::HYPERPERIOD, (unsigned long)mask);
+        }
+        planned = true;
     }
+    return mask;
+#else
+    return SENSOR_MASK_ALL;
 #endif
+}
 
-#ifdef ENABLE_SENSOR_DS18B20
-    if (sensor_ds18b20_init()) {
-        Serial.println("DS18B20 inicializado");
-        any_init = true;
-    }
-#endif
+/**
+ * @brief Sensores que tocan y no estan caidos (o vence su re-sondeo)
+ *
+ * El backoff de salud avanza una sola vez por despertar.
+ * @return Mascara con un bit por sensor del registro
+ */
+static uint32_t probe_mask(void) {
+    static bool planned = false;
+    static uint32_t mask = 0;
 
-#ifdef ENABLE_SENSOR_PH
-    if (sensor_ph_init()) {
-        Serial.println("Sensor de pH inicializado");
-        any_init = true;
+    if (!planned) {
+        mask = due_mask() & sensorHealthProbeMask(SensorRegistry::COUNT);
+        planned = true;
     }
-#endif
+    return mask;
+}
 
-    return any_init;
+/**
+ * @brief Pone a valor de error todos los campos de una lectura
+ */
+static void reset_reading(sensor_data_t* data) {
+    data->temperature = SENSOR_ERROR_TEMPERATURE;
+    data->humidity = SENSOR_ERROR_HUMIDITY;
+    data->pressure = SENSOR_ERROR_PRESSURE;
+    data->temperature_1m = SENSOR_ERROR_TEMPERATURE;
+    data->ph = SENSOR_ERROR_PH;
+    data->battery = SENSOR_ERROR_BATTERY;
+    data->timestamp = netTimeNow();
+    data->valid = false;
+}
+
+/**
+ * @brief Inicializa todos los sensores habilitados
+ * @return true si al menos un sensor se inicializo correctamente
+ */
+bool sensors_init_all(void) {
+    Serial.printf("Sensores: %u registrados, adquisicion estimada %lu ms\n",
+                  (unsigned)SensorRegistry::COUNT,
+                  (unsigned long)(SensorRegistry::WARMUP_MS + SensorRegistry::READ_MS));
+    return SensorRegistry::initAll(probe_mask()) != 0;
 }
 
 /**
@@ -56,21 +114,7 @@ bool sensors_init_all(void) {
  * @return true si al menos un sensor esta operativo
  */
 bool sensors_is_any_available(void) {
-    bool any_available = false;
-    
-#ifdef ENABLE_SENSOR_BME280
-    any_available |= sensor_bme280_is_available();
-#endif
-
-#ifdef ENABLE_SENSOR_DS18B20
-    any_available |= sensor_ds18b20_is_available();
-#endif
-
-#ifdef ENABLE_SENSOR_PH
-    any_available |= sensor_ph_is_available();
-#endif
-
-    return any_available;
+    return SensorRegistry::anyAvailable();
 }
 
 /**
@@ -78,21 +122,8 @@ bool sensors_is_any_available(void) {
  * @return true si al menos un sensor se reinicializo correctamente
  */
 bool sensors_retry_init_all(void) {
-    bool any_retry = false;
-    
-#ifdef ENABLE_SENSOR_BME280
-    any_retry |= sensor_bme280_retry_init();
-#endif
-
-#ifdef ENABLE_SENSOR_DS18B20
-    any_retry |= sensor_ds18b20_retry_init();
-#endif
-
-#ifdef ENABLE_SENSOR_PH
-    any_retry |= sensor_ph_retry_init();
-#endif
-
-    return any_retry;
+    // Los sensores caidos solo se re-sondean al vencer su backoff, en sensors_init_all()
+    return SensorRegistry::retryAll(probe_mask() & sensorHealthUsableMask(SensorRegistry::COUNT));
 }
 
 /**
@@ -104,96 +135,60 @@ bool sensors_read_all(sensor_data_t* data) {
     if (!data) return false;
 
     // Inicializar con valores de error
-    data->temperature = SENSOR_ERROR_TEMPERATURE;
-    data->humidity = SENSOR_ERROR_HUMIDITY;
-    data->pressure = SENSOR_ERROR_PRESSURE;
-    data->temperature_1m = SENSOR_ERROR_TEMPERATURE;
-    data->ph = SENSOR_ERROR_PH;
+    reset_reading(data);
     data->battery = readBatteryVoltage();
-    data->valid = false;
 
-    bool any_data = false;
-
-    // Leer del sensor BME280
-#ifdef ENABLE_SENSOR_BME280
-    {
-        sensor_data_t bme_data;
-        if (sensor_bme280_read_all(&bme_data)) {
-            if (bme_data.temperature != SENSOR_ERROR_TEMPERATURE) {
-                data->temperature = bme_data.temperature;
-                Serial.printf("DEBUG: BME280 Temperatura exterior = %.2f °C\n", data->temperature);
-                any_data = true;
-            }
-            if (bme_data.humidity != SENSOR_ERROR_HUMIDITY) {
-                data->humidity = bme_data.humidity;
-                Serial.printf("DEBUG: BME280 Humedad = %.2f %%\n", data->humidity);
-                any_data = true;
-            }
-            if (bme_data.pressure != SENSOR_ERROR_PRESSURE) {
-                data->pressure = bme_data.pressure;
-                Serial.printf("DEBUG: BME280 Presion = %.2f hPa\n", data->pressure);
-                any_data = true;
-            }
-        }
-    }
-#endif
-
-    // Leer del sensor DS18B20 (temperatura a 1m)
-#ifdef ENABLE_SENSOR_DS18B20
-    {
-        sensor_data_t ds18b20_data;
-        if (sensor_ds18b20_read_all(&ds18b20_data)) {
-            if (ds18b20_data.temperature_1m != SENSOR_ERROR_TEMPERATURE) {
-                data->temperature_1m = ds18b20_data.temperature_1m;
-                Serial.printf("DEBUG: DS18B20 Temperatura agua 1m = %.2f °C\n", data->temperature_1m);
-                any_data = true;
-            }
-        }
-    }
-#endif
-
-    // Leer del sensor de pH (con compensacion de temperatura si esta disponible)
-#ifdef ENABLE_SENSOR_PH
-    {
-        // Si tenemos temperatura del BME280, actualizar compensacion de pH
-        #ifdef ENABLE_SENSOR_BME280
-        if (data->temperature != SENSOR_ERROR_TEMPERATURE) {
-            sensor_ph_set_temperature(data->temperature);
-            Serial.printf("DEBUG: pH compensado con temperatura = %.2f °C\n", data->temperature);
-        }
-        #endif
-        
-        sensor_data_t ph_data;
-        if (sensor_ph_read_all(&ph_data)) {
-            if (ph_data.ph != SENSOR_ERROR_PH) {
-                data->ph = ph_data.ph;
-                Serial.printf("DEBUG: pH sensor = %.2f\n", data->ph);
-                any_data = true;
-            }
-        }
-    }
-#endif
+    uint32_t attempted = probe_mask() & REGISTRY_MASK;
+    uint32_t ok = SensorRegistry::readAll(data, false, due_mask(), attempted);
+    sensorHealthUpdate(attempted, ok);
+    unstable_mask = SensorRegistry::unstableMask(ok);
+    bool any_data = ok != 0;
 
     // Mostrar resumen final
     Serial.println("DEBUG: ========== RESUMEN DE LECTURAS ==========");
     Serial.printf("DEBUG: Bateria = %.2f V (%.0f%%)\n", data->battery, 
                   (data->battery - 3.3) / (4.2 - 3.3) * 100.0);
-    if (data->ph != SENSOR_ERROR_PH) 
-        Serial.printf("DEBUG: pH = %.2f\n", data->ph);
-    if (data->temperature != SENSOR_ERROR_TEMPERATURE) 
-        Serial.printf("DEBUG: Temp exterior = %.2f °C\n", data->temperature);
-    if (data->temperature_1m != SENSOR_ERROR_TEMPERATURE) 
-        Serial.printf("DEBUG: Temp agua 1m = %.2f °C\n", data->temperature_1m);
-    if (data->humidity != SENSOR_ERROR_HUMIDITY) 
-        Serial.printf("DEBUG: Humedad = %.2f %%\n", data->humidity);
-    if (data->pressure != SENSOR_ERROR_PRESSURE) 
-        Serial.printf("DEBUG: Presion = %.2f hPa\n", data->pressure);
+    for (uint8_t i = 0; i < SensorPayload::COUNT; i++) {
+        const sensor_field_t* field = &SensorPayload::FIELDS[i];
+        float value = sensorFieldValue(data, field);
+        if (value != field->error && !isnan(value))
+            Serial.printf("DEBUG: %s = %.2f\n", field->label, value);
+    }
+#ifdef ENABLE_SENSOR_PH
+    // Solo si la sonda se encendio en este ciclo
+    if (sensor_ph_settling_ms() > 0) {
+        Serial.printf("DEBUG: Estabilizacion pH = %lu ms%s\n", (unsigned long)sensor_ph_settling_ms(),
+                      sensor_ph_is_stable() ? "" : " (sin estabilizar)");
+    }
+#endif
     Serial.println("DEBUG: ==========================================");
 
     data->valid = any_data;
     return any_data;
 }
 
+/**
+ * @brief Lectura reducida para los despertares de muestreo: solo agua
+ *
+ * Inicializa y lee los sensores marcados WATER en el registro (DS18B20 y
+ * pH) sin tocar el BME280 ni el bus I2C. El pH se compensa con la
+ * temperatura del agua, que es la de la muestra.
+ *
+ * @param data Puntero a estructura donde almacenar los datos
+ * @return true si se pudo leer al menos un sensor
+ */
+bool sensors_read_water(sensor_data_t* data) {
+    if (!data) return false;
+
+    reset_reading(data);
+    // Sin tocar la salud: los sensores caidos se re-sondean en los ciclos de envio
+    uint32_t usable = SensorRegistry::WATER_MASK & sensorHealthUsableMask(SensorRegistry::COUNT);
+    bool any_data = SensorRegistry::readAll(data, true, SENSOR_MASK_ALL, usable) != 0;
+
+    data->valid = any_data;
+    return any_data;
+}
+
 /**
  * @brief Construye el payload con datos de todos los sensores
  * @param config Configuracion del payload
@@ -208,14 +203,25 @@ uint8_t sensors_get_payload(payload_config_t* config) {
     if (!sensor_ok) {
         // Si no hay datos validos, intentar reinicializar
         sensors_retry_init_all();
-        // Usar datos de error
-        data.temperature = SENSOR_ERROR_TEMPERATURE;
-        data.humidity = SENSOR_ERROR_HUMIDITY;
-        data.pressure = SENSOR_ERROR_PRESSURE;
-        data.temperature_1m = SENSOR_ERROR_TEMPERATURE;
-        data.ph = SENSOR_ERROR_PH;
+        // Usar datos de error (conservando bateria y hora)
+        float battery = data.battery;
+        reset_reading(&data);
+        data.battery = battery;
     }
 
+    return sensors_build_payload(&data, config);
+}
+
+/**
+ * @brief Construye el payload a partir de una lectura ya hecha
+ * @param reading Lectura de sensors_read_all()
+ * @param config Configuracion del payload
+ * @return Numero de bytes escritos
+ */
+uint8_t sensors_build_payload(const sensor_data_t* reading, payload_config_t* config) {
+    if (!reading || !config || config->max_size < PAYLOAD_SIZE_BYTES) return 0;
+
+    const sensor_data_t& data = *reading;
     uint8_t offset = 0;
 
     // Orden del payload: Bateria, pH, Temperatura exterior, Temperatura 1m, Humedad, Presion
@@ -223,7 +229,7 @@ uint8_t sensors_get_payload(payload_config_t* config) {
     // 1. Bateria (1 byte) - PRIMERO
 #ifdef BATTERY_AS_PERCENTAGE
     // Enviar como porcentaje (1 byte)
-    uint8_t batt_percent = batteryPercentFromVoltage(data.battery);
+    uint8_t batt_percent = batterySocPercent(data.battery);
     Serial.printf("DEBUG: Battery voltage %.2f V = %u%%\n", data.battery, batt_percent);
     config->buffer[offset++] = batt_percent;              // Solo 1 byte
 #else
@@ -234,58 +240,52 @@ uint8_t sensors_get_payload(payload_config_t* config) {
     config->buffer[offset++] = batt_int >> 8;             // High byte despues
 #endif
 
-    // 2. pH (2 bytes)
-#ifdef ENABLE_SENSOR_PH
-    if (SYSTEM_HAS_PH) {
-        uint16_t ph_int = (uint16_t)(data.ph * 100);
-        Serial.printf("DEBUG PAYLOAD: pH %.2f → %u (0x%04X) → bytes[%u,%u]\n", 
-                     data.ph, ph_int, ph_int, ph_int & 0xFF, ph_int >> 8);
-        config->buffer[offset++] = ph_int & 0xFF;        // Low byte primero
-        config->buffer[offset++] = ph_int >> 8;           // High byte despues
+    // 2-6. Campos de los sensores en el orden de su posicion en el payload
+    const sensor_field_t* layout = SensorPayload::FIELDS;
+    const uint8_t count = SensorPayload::COUNT;
+#if SENSOR_MULTIRATE_ENABLE
+    // Mascara de presencia: bit (posicion - 1) por cada campo leido en este ciclo
+    uint8_t presence = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (!isnan(sensorFieldValue(&data, &layout[i]))) {
+            presence |= 1 << (layout[i].slot - 1);
+        }
     }
+    Serial.printf("DEBUG PAYLOAD: Presencia 0x%02X\n", presence);
+    config->buffer[offset++] = presence;
 #endif
-
-    // 3. Temperatura exterior/BME280 (2 bytes)
-#ifdef ENABLE_SENSOR_BME280
-    if (SYSTEM_HAS_TEMPERATURE) {
-        int16_t temp_int = (int16_t)(data.temperature * 100);
-        Serial.printf("DEBUG PAYLOAD: Temp_ext %.2f → %d (0x%04X) → bytes[%u,%u]\n", 
-                     data.temperature, temp_int, (uint16_t)temp_int, temp_int & 0xFF, (temp_int >> 8) & 0xFF);
-        config->buffer[offset++] = temp_int & 0xFF;      // Low byte primero
-        config->buffer[offset++] = (temp_int >> 8) & 0xFF; // High byte despues
-    }
+    for (uint8_t i = 0; i < count; i++) {
+        float value = sensorFieldValue(&data, &layout[i]);
+#if SENSOR_MULTIRATE_ENABLE
+        if (isnan(value)) {
+            continue;  // No leido en este ciclo: no viaja
+        }
 #endif
-
-    // 4. Temperatura a 1m (2 bytes)
-#ifdef ENABLE_SENSOR_DS18B20
-    if (SYSTEM_HAS_TEMP_1M) {
-        int16_t temp1m_int = (int16_t)(data.temperature_1m * 100);
-        Serial.printf("DEBUG PAYLOAD: Temp_1m %.2f → %d (0x%04X) → bytes[%u,%u]\n", 
-                     data.temperature_1m, temp1m_int, (uint16_t)temp1m_int, temp1m_int & 0xFF, (temp1m_int >> 8) & 0xFF);
-        config->buffer[offset++] = temp1m_int & 0xFF;     // Low byte primero
-        config->buffer[offset++] = (temp1m_int >> 8) & 0xFF; // High byte despues
+        uint16_t raw = layout[i].isSigned ? (uint16_t)(int16_t)(value * layout[i].scale)
+                                           : (uint16_t)(value * layout[i].scale);
+        Serial.printf("DEBUG PAYLOAD: %s %.2f → %u (0x%04X) → bytes[%u,%u]\n", 
+                     layout[i].label, value, raw, raw, raw & 0xFF, raw >> 8);
+        config->buffer[offset++] = raw & 0xFF;            // Low byte primero
+        config->buffer[offset++] = raw >> 8;              // High byte despues
     }
-#endif
 
-    // 5. Humedad (2 bytes)
-#ifdef ENABLE_SENSOR_BME280
-    if (SYSTEM_HAS_HUMIDITY) {
-        int16_t hum_int = (int16_t)(data.humidity * 100);
-        Serial.printf("DEBUG PAYLOAD: Humedad %.2f → %d (0x%04X) → bytes[%u,%u]\n", 
-                     data.humidity, hum_int, (uint16_t)hum_int, hum_int & 0xFF, (hum_int >> 8) & 0xFF);
-        config->buffer[offset++] = hum_int & 0xFF;        // Low byte primero
-        config->buffer[offset++] = (hum_int >> 8) & 0xFF; // High byte despues
+    // 7. Hora de la muestra (2 bytes, unidades de 2 s modulo 65535; 0xFFFF = sin hora)
+#if ENABLE_SAMPLE_TIMESTAMP
+    {
+        uint16_t ts = netTimeCompact(data.timestamp);
+        Serial.printf("DEBUG PAYLOAD: Hora %lu → %u (0x%04X)\n",
+                     (unsigned long)data.timestamp, ts, ts);
+        config->buffer[offset++] = ts & 0xFF;             // Low byte primero
+        config->buffer[offset++] = ts >> 8;               // High byte despues
     }
 #endif
 
-    // 6. Presion (2 bytes)
-#ifdef ENABLE_SENSOR_BME280
-    if (SYSTEM_HAS_PRESSURE) {
-        uint16_t pres_int = (uint16_t)(data.pressure * 10);
-        Serial.printf("DEBUG PAYLOAD: Presion %.2f → %u (0x%04X) → bytes[%u,%u]\n", 
-                     data.pressure, pres_int, pres_int, pres_int & 0xFF, pres_int >> 8);
-        config->buffer[offset++] = pres_int & 0xFF;       // Low byte primero
-        config->buffer[offset++] = pres_int >> 8;         // High byte despues
+    // 8. Salud de los sensores (1 byte, 2 bits por sensor en el orden del registro)
+#if SENSOR_HEALTH_IN_PAYLOAD
+    {
+        uint8_t health = sensorHealthBits(unstable_mask);
+        Serial.printf("DEBUG PAYLOAD: Salud 0x%02X\n", health);
+        config->buffer[offset++] = health;
     }
 #endif
 
@@ -310,15 +310,7 @@ const char* sensors_get_name(void) {
     static char name_buffer[100] = "";
     name_buffer[0] = '\0';
     
-#ifdef ENABLE_SENSOR_BME280
-    strcat(name_buffer, "BME280 ");
-#endif
-#ifdef ENABLE_SENSOR_DS18B20
-    strcat(name_buffer, "DS18B20 ");
-#endif
-#ifdef ENABLE_SENSOR_PH
-    strcat(name_buffer, "pH ");
-#endif
+    SensorRegistry::appendNames(name_buffer, sizeof(name_buffer));
     
     if (strlen(name_buffer) == 0) {
         strcpy(name_buffer, "NINGUNO");
@@ -332,15 +324,7 @@ const char* sensors_get_name(void) {
  * @param available true para simular disponible, false para simular fallo
  */
 void sensors_set_available_for_testing(bool available) {
-#ifdef ENABLE_SENSOR_BME280
-    sensor_bme280_set_available_for_testing(available);
-#endif
-#ifdef ENABLE_SENSOR_DS18B20
-    sensor_ds18b20_set_available_for_testing(available);
-#endif
-#ifdef ENABLE_SENSOR_PH
-    sensor_ph_set_available_for_testing(available);
-#endif
+    SensorRegistry::setAvailableForTesting(available);
 }
 
 // ============================================================================
@@ -6,12 +6,25 @@
 #include <Wire.h>
 #include "sensor_interface.h"
 #include "LoRaBoards.h"
+#include "i2c_bus.h"
 
 // Objeto global del sensor
 static Adafruit_BME280 bme;
 
 // Estado del sensor
 static bool sensor_available = false;
+static uint8_t sensor_address = 0x76;
+
+/**
+ * @brief Prueba el sensor en una dirección con el bus I2C reservado
+ */
+static bool sensor_bme280_begin_at(uint8_t address) {
+    if (!i2cBusLock(address)) return false;
+    bool found = bme.begin(address, &Wire);
+    i2cBusUnlock();
+    if (found) sensor_address = address;
+    return found;
+}
 
 /**
  * @brief Inicializa el sensor BME280
@@ -23,10 +36,14 @@ bool sensor_bme280_init(void) {
     // Solo hacemos un pequeño delay para estabilización
     delay(100);
     
+    i2cBusSetClock(0x76, I2C_BUS_CLOCK_BME280_HZ);
+    i2cBusSetClock(0x77, I2C_BUS_CLOCK_BME280_HZ);
+
     // Escanear el bus I2C para ver qué dispositivos hay
     Serial.println("BME280: Escaneando bus I2C...");
     byte error, address;
     int nDevices = 0;
+    bool scanLocked = i2cBusLock(0);
     for(address = 1; address < 127; address++ ) {
         Wire.beginTransmission(address);
         error = Wire.endTransmission();
@@ -35,6 +52,7 @@ bool sensor_bme280_init(void) {
             nDevices++;
         }
     }
+    if (scanLocked) i2cBusUnlock();
     if (nDevices == 0) {
         Serial.println("  No se encontraron dispositivos I2C en el bus!");
     } else {
@@ -43,14 +61,14 @@ bool sensor_bme280_init(void) {
     
     // Intentar primero con dirección 0x76
     Serial.print("BME280: Probando dirección 0x76... ");
-    if (bme.begin(0x76, &Wire)) {
+    if (sensor_bme280_begin_at(0x76)) {
         Serial.println("¡Encontrado!");
     }
     // Si no funciona, intentar con dirección 0x77
     else {
         Serial.println("No encontrado");
         Serial.print("BME280: Probando dirección 0x77... ");
-        if (bme.begin(0x77, &Wire)) {
+        if (sensor_bme280_begin_at(0x77)) {
             Serial.println("¡Encontrado!");
         }
         // Si ninguna dirección funciona
@@ -63,12 +81,17 @@ bool sensor_bme280_init(void) {
         }
     }
     
+    if (!i2cBusLock(sensor_address)) {
+        sensor_available = false;
+        return false;
+    }
     bme.setSampling(Adafruit_BME280::MODE_NORMAL,
                     Adafruit_BME280::SAMPLING_X2,   // Temperatura
                     Adafruit_BME280::SAMPLING_X16,  // Presión
                     Adafruit_BME280::SAMPLING_X1,   // Humedad
                     Adafruit_BME280::FILTER_X16,
                     Adafruit_BME280::STANDBY_MS_500);
+    i2cBusUnlock();
     Serial.println("BME280: Sensor inicializado correctamente.");
     sensor_available = true;
     return true;
@@ -96,9 +119,12 @@ bool sensor_bme280_retry_init(void) {
 bool sensor_bme280_read_all(sensor_data_t* data) {
     if (!sensor_available || !data) return false;
 
+    // Las tres lecturas seguidas, sin escrituras del display intercaladas
+    if (!i2cBusLock(sensor_address)) return false;
     data->temperature = bme.readTemperature();
     data->humidity = bme.readHumidity();  // BME280 sí mide humedad
     data->pressure = bme.readPressure() / 100.0F;  // Convertir a hPa
+    i2cBusUnlock();
     // Batería se lee en sensors_read_all(), no aquí
     data->valid = true;
 
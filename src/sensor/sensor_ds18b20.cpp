@@ -2,14 +2,22 @@
 
 #ifdef ENABLE_SENSOR_DS18B20
 // Implementación DS18B20 (temperatura a 1m de profundidad)
+#if DS18B20_USE_RMT
+#include "onewire_rmt.h"
+#else
 #include <OneWire.h>
 #include <DallasTemperature.h>
+#endif
 #include "sensor_interface.h"
 #include "LoRaBoards.h"
 
 // Objetos globales del sensor
+#if DS18B20_USE_RMT
+static DallasTemperatureRmt sensors(DS18B20_DATA_PIN);
+#else
 static OneWire oneWire(DS18B20_DATA_PIN);
 static DallasTemperature sensors(&oneWire);
+#endif
 
 // Estado del sensor
 static bool sensor_available = false;
@@ -71,7 +79,11 @@ bool sensor_ds18b20_init(void) {
     
     // Inicializar librería DallasTemperature
     sensors.begin();
+#if DS18B20_USE_RMT
+    Serial.println("DS18B20: Bus OneWire sobre RMT inicializado");
+#else
     Serial.println("DS18B20: Libreria DallasTemperature inicializada");
+#endif
     
     // Verificar si hay dispositivos conectados
     int deviceCount = sensors.getDeviceCount();
@@ -6,6 +6,8 @@
 #include <EEPROM.h>
 #include "sensor_interface.h"
 #include "LoRaBoards.h"
+#include "adc_scan.h"
+#include "ph_settling.h"
 
 // Objeto global del sensor DFRobot_PH
 static DFRobot_PH ph_sensor;
@@ -17,6 +19,53 @@ static bool sensor_powered = false;
 // Variables para lecturas
 static float temperature = PH_DEFAULT_TEMPERATURE;  // Temperatura para compensacion
 
+// Resultado de la última estabilización tras encender la sonda
+static uint32_t settle_ms = 0;
+static bool settle_stable = true;
+
+static float read_ph_voltage(void);
+
+/**
+ * @brief Espera a que la tensión de la sonda se estabilice tras encenderla
+ *
+ * Muestrea cada PH_SETTLE_SAMPLE_INTERVAL_MS hasta que el detector da la
+ * ventana por estable o se agota PH_POWER_ON_DELAY_MS.
+ */
+static void sensor_ph_wait_settled(void) {
+#if PH_SETTLE_ENABLE
+    ph_settling_t window;
+    phSettlingReset(&window);
+    uint32_t start = millis();
+    settle_stable = false;
+
+    while (true) {
+        delay(PH_SETTLE_SAMPLE_INTERVAL_MS);
+        uint32_t elapsed = millis() - start;
+        if (phSettlingAdd(&window, elapsed, read_ph_voltage() * 1000.0f)) {
+            settle_stable = true;
+            break;
+        }
+        if (elapsed >= PH_POWER_ON_DELAY_MS) {
+            break;
+        }
+    }
+    settle_ms = millis() - start;
+
+    if (settle_stable) {
+        Serial.printf("pH: Sonda estable en %lu ms (deriva %.2f mV/min, ruido %.2f mV)\n",
+                      (unsigned long)settle_ms, window.slopeMvPerMin, window.noiseMv);
+    } else {
+        Serial.printf("pH: ADVERTENCIA - Sonda sin estabilizar tras %lu ms (deriva %.2f mV/min, ruido %.2f mV)\n",
+                      (unsigned long)settle_ms, window.slopeMvPerMin, window.noiseMv);
+    }
+#else
+    Serial.printf("pH: Esperando %d ms para estabilizacion...\n", PH_POWER_ON_DELAY_MS);
+    delay(PH_POWER_ON_DELAY_MS);
+    settle_ms = PH_POWER_ON_DELAY_MS;
+    settle_stable = true;
+#endif
+}
+
 /**
  * @brief Enciende alimentacion de sensores
  */
@@ -29,8 +78,7 @@ static void sensor_ph_power_on(void) {
     sensor_powered = true;
     
     Serial.println("pH: Alimentacion de sensores activada");
-    Serial.printf("pH: Esperando %d ms para estabilizacion...\n", PH_POWER_ON_DELAY_MS);
-    delay(PH_POWER_ON_DELAY_MS);
+    sensor_ph_wait_settled();
 #else
     Serial.println("pH: Alimentacion permanente (sin control por MOSFET)");
     sensor_powered = true;
@@ -101,9 +149,18 @@ bool sensor_ph_retry_init(void) {
 }
 
 /**
- * @brief Lee el valor de pH usando la libreria DFRobot
+ * @brief Lee la tension de la sonda de pH promediada
  */
-static float read_ph_value(void) {
+static float read_ph_voltage(void) {
+#if ADC_SCAN_ENABLE
+    // Barrido calibrado compartido; tras encender la sonda hace falta uno nuevo
+    float voltage = adcScanMillivolts(ADC_SCAN_PH, PH_USE_POWER_CONTROL ? 0 : ADC_SCAN_MAX_AGE_MS) / 1000.0f;
+    if (isnan(voltage)) {
+        Serial.println("pH: ERROR - Sin lectura del ADC");
+        return NAN;
+    }
+    Serial.printf("pH: Voltaje calibrado = %.3f V\n", voltage);
+#else
     uint32_t sum = 0;
     
     // Tomar multiples muestras y promediar
@@ -118,6 +175,18 @@ static float read_ph_value(void) {
     float voltage = (avg_reading / PH_ADC_RESOLUTION) * PH_REFERENCE_VOLTAGE;
     
     Serial.printf("pH: Lectura ADC promedio = %.1f, Voltaje = %.3f V\n", avg_reading, voltage);
+#endif
+    return voltage;
+}
+
+/**
+ * @brief Lee el valor de pH usando la libreria DFRobot
+ */
+static float read_ph_value(void) {
+    float voltage = read_ph_voltage();
+    if (isnan(voltage)) {
+        return NAN;
+    }
     
     // Usar la libreria DFRobot_PH para calcular el pH con compensacion de temperatura
     float ph_value = ph_sensor.readPH(voltage, temperature);
@@ -125,6 +194,37 @@ static float read_ph_value(void) {
     return ph_value;
 }
 
+/**
+ * @brief Convierte a pH una lectura cruda del ADC tomada fuera del driver
+ *
+ * Misma conversion a tension que read_ph_voltage() y misma compensacion
+ * de temperatura que la ultima lectura.
+ */
+float sensor_ph_from_raw(uint16_t raw) {
+    if (!sensor_available) return NAN;
+#if ADC_SCAN_ENABLE
+    float voltage = adcScanRawToMillivolts(ADC_SCAN_PH, raw) / 1000.0f;
+    if (isnan(voltage)) return NAN;
+#else
+    float voltage = (raw / PH_ADC_RESOLUTION) * PH_REFERENCE_VOLTAGE;
+#endif
+    return ph_sensor.readPH(voltage, temperature);
+}
+
+/**
+ * @brief Tiempo de estabilizacion del ultimo encendido de la sonda
+ */
+uint32_t sensor_ph_settling_ms(void) {
+    return settle_ms;
+}
+
+/**
+ * @brief Indica si la sonda estaba estable en la ultima lectura
+ */
+bool sensor_ph_is_stable(void) {
+    return settle_stable;
+}
+
 /**
  * @brief Actualiza la temperatura para compensacion de pH
  * @param temp Temperatura en grados C
@@ -160,6 +260,9 @@ bool sensor_ph_read_all(sensor_data_t* data) {
         data->ph = ph;
         Serial.printf("pH: Valor de pH = %.2f\n", ph);
     }
+    if (!settle_stable) {
+        Serial.println("pH: ADVERTENCIA - Lectura tomada con la sonda sin estabilizar");
+    }
     
     // Apagar alimentacion despues de leer
     sensor_ph_power_off();
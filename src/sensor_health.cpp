@@ -0,0 +1,135 @@
+/**
+ * @file      sensor_health.cpp
+ * @brief     Implementación del seguimiento de salud de sensores
+ *
+ * Un estado RTC no válido queda a cero, es decir, todos los sensores sanos:
+ * tras un power-on se vuelven a sondear todos.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include "sensor_health.h"
+#include "retained_state.h"
+
+#define SENSOR_HEALTH_VERSION 1
+
+/**
+ * @brief Salud de un sensor conservada durante el sueño profundo
+ */
+typedef struct {
+    uint8_t  state;        /**< sensor_health_t */
+    uint8_t  failures;     /**< Fallos consecutivos */
+    uint16_t skipCycles;   /**< Ciclos que faltan para re-sondear un sensor caído */
+} sensor_health_entry_t;
+
+typedef struct {
+    sensor_health_entry_t sensor[SENSOR_HEALTH_MAX];
+} sensor_health_state_t;
+
+RETAINED_STATE(sensor_health_state_t, healthBlock);
+static sensor_health_state_t& healthState = healthBlock.state;
+
+/**
+ * @brief Valida el estado RTC
+ */
+static void ensureState() {
+    retainedRegister(RETAINED_SENSOR_HEALTH, healthBlock, SENSOR_HEALTH_VERSION);
+}
+
+/**
+ * @brief Ciclos hasta el próximo re-sondeo: 1, 2, 4... hasta el máximo
+ */
+static uint16_t backoffCycles(uint8_t failures) {
+    uint8_t exponent = failures - SENSOR_HEALTH_FAIL_THRESHOLD;
+    if (exponent >= 16) {
+        return SENSOR_HEALTH_BACKOFF_MAX_CYCLES;
+    }
+    uint32_t cycles = 1UL << exponent;
+    return cycles > SENSOR_HEALTH_BACKOFF_MAX_CYCLES ? SENSOR_HEALTH_BACKOFF_MAX_CYCLES : (uint16_t)cycles;
+}
+
+uint32_t sensorHealthProbeMask(uint8_t count) {
+    ensureState();
+    uint32_t mask = 0;
+    for (uint8_t i = 0; i < count && i < SENSOR_HEALTH_MAX; i++) {
+        sensor_health_entry_t* s = &healthState.sensor[i];
+        if (s->state != SENSOR_FAILED) {
+            mask |= 1UL << i;
+        } else if (s->skipCycles > 0) {
+            s->skipCycles--;
+            Serial.printf("Salud: sensor %u caído, re-sondeo en %u ciclos\n", i, s->skipCycles + 1);
+        } else {
+            Serial.printf("Salud: re-sondeando sensor %u tras %u fallos\n", i, s->failures);
+            mask |= 1UL << i;
+        }
+    }
+    return mask;
+}
+
+uint32_t sensorHealthUsableMask(uint8_t count) {
+    ensureState();
+    uint32_t mask = 0;
+    for (uint8_t i = 0; i < count && i < SENSOR_HEALTH_MAX; i++) {
+        if (healthState.sensor[i].state != SENSOR_FAILED) {
+            mask |= 1UL << i;
+        }
+    }
+    return mask;
+}
+
+void sensorHealthUpdate(uint32_t attempted, uint32_t ok) {
+    ensureState();
+    for (uint8_t i = 0; i < SENSOR_HEALTH_MAX; i++) {
+        if (!(attempted & (1UL << i))) {
+            continue;
+        }
+        sensor_health_entry_t* s = &healthState.sensor[i];
+
+        if (ok & (1UL << i)) {
+            if (s->state != SENSOR_HEALTHY) {
+                Serial.printf("Salud: sensor %u recuperado tras %u fallos\n", i, s->failures);
+            }
+            s->state = SENSOR_HEALTHY;
+            s->failures = 0;
+            s->skipCycles = 0;
+            continue;
+        }
+
+        if (s->failures < 255) {
+            s->failures++;
+        }
+        if (s->failures >= SENSOR_HEALTH_FAIL_THRESHOLD) {
+            s->state = SENSOR_FAILED;
+            s->skipCycles = backoffCycles(s->failures) - 1;
+            Serial.printf("Salud: sensor %u caído (%u fallos), próximo intento en %u ciclos\n",
+                          i, s->failures, s->skipCycles + 1);
+        } else {
+            s->state = SENSOR_DEGRADED;
+            Serial.printf("Salud: sensor %u degradado (%u fallos)\n", i, s->failures);
+        }
+    }
+}
+
+sensor_health_t sensorHealthState(uint8_t index) {
+    ensureState();
+    if (index >= SENSOR_HEALTH_MAX) {
+        return SENSOR_HEALTHY;
+    }
+    return (sensor_health_t)healthState.sensor[index].state;
+}
+
+uint8_t sensorHealthBits(uint32_t unstable) {
+    ensureState();
+    uint8_t bits = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        uint8_t state = healthState.sensor[i].state & 0x03;
+        if (state == SENSOR_HEALTHY && (unstable & (1UL << i))) {
+            state = SENSOR_DEGRADED;
+        }
+        bits |= state << (2 * i);
+    }
+    return bits;
+}
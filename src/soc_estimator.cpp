@@ -0,0 +1,83 @@
+/**
+ * @file      soc_estimator.cpp
+ * @brief     Implementación del estimador de estado de carga
+ *
+ * La curva OCV es la típica de una 18650 NMC en reposo a 25 °C, en pasos
+ * del 10 %. El peso de la OCV se escala con la pendiente del tramo
+ * respecto a 10 mV por punto: en los extremos de la curva manda la
+ * tensión, en la zona plana el recuento.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <math.h>
+#include "soc_estimator.h"
+
+#define SOC_OCV_POINTS        11
+#define SOC_OCV_STEP          10.0f     // Puntos de carga entre entradas de la tabla
+#define SOC_SLOPE_FULL_WEIGHT 0.010f    // V por punto con el peso completo de la OCV
+#define SOC_MIN_WEIGHT_SCALE  0.25f     // Fracción mínima del peso en la zona plana
+#define SOC_RES_TEMP_COEFF    0.02f     // Aumento de R_int por grado bajo 25 °C
+#define SOC_CELL_TEMP_MIN     -20.0f    // Rango de temperatura plausible de la celda
+#define SOC_CELL_TEMP_MAX     60.0f
+
+// OCV (V) al 0, 10, ..., 100 %
+static const float ocvTable[SOC_OCV_POINTS] = {
+    3.00f, 3.45f, 3.60f, 3.68f, 3.74f, 3.79f, 3.85f, 3.92f, 3.99f, 4.07f, 4.18f
+};
+
+static float clampf(float value, float lo, float hi) {
+    return value < lo ? lo : (value > hi ? hi : value);
+}
+
+float socFromOcv(float ocvVolts) {
+    if (ocvVolts <= ocvTable[0]) {
+        return 0.0f;
+    }
+    for (uint8_t i = 1; i < SOC_OCV_POINTS; i++) {
+        if (ocvVolts < ocvTable[i]) {
+            float fraction = (ocvVolts - ocvTable[i - 1]) / (ocvTable[i] - ocvTable[i - 1]);
+            return ((i - 1) + fraction) * SOC_OCV_STEP;
+        }
+    }
+    return 100.0f;
+}
+
+float socOcvSlope(float percent) {
+    uint8_t i = (uint8_t)(clampf(percent, 0.0f, 99.9f) / SOC_OCV_STEP);
+    return (ocvTable[i + 1] - ocvTable[i]) / SOC_OCV_STEP;
+}
+
+float socCompensateOcv(float volts, float loadMa, float tempC, uint16_t internalResMohm) {
+    float resOhm = internalResMohm / 1000.0f;
+    if (!isnan(tempC)) {
+        tempC = clampf(tempC, SOC_CELL_TEMP_MIN, SOC_CELL_TEMP_MAX);
+        if (tempC < 25.0f) {
+            resOhm *= 1.0f + SOC_RES_TEMP_COEFF * (25.0f - tempC);
+        }
+    }
+    return volts + loadMa / 1000.0f * resOhm;
+}
+
+void socEstimatorStep(soc_estimate_t* est, const soc_params_t* params, float consumedMah,
+                      float volts, float loadMa, float tempC) {
+    if (est->valid && params->capacityMah > 0) {
+        est->percent = clampf(est->percent - consumedMah * 100.0f / params->capacityMah, 0.0f, 100.0f);
+    }
+    if (volts <= 0.0f) {
+        return;
+    }
+
+    float ocvPercent = socFromOcv(socCompensateOcv(volts, loadMa, tempC, params->internalResMohm));
+    if (!est->valid) {
+        est->percent = ocvPercent;
+        est->valid = true;
+        return;
+    }
+
+    float scale = clampf(socOcvSlope(ocvPercent) / SOC_SLOPE_FULL_WEIGHT, SOC_MIN_WEIGHT_SCALE, 1.0f);
+    float weight = clampf(params->ocvWeight, 0.0f, 1.0f) * scale;
+    est->percent += weight * (ocvPercent - est->percent);
+}
@@ -1,23 +1,17 @@
-#include <XPowersLib.h>
 #include <Arduino.h>
-
-// Declaración externa para funciones de carga solar
-extern XPowersLibInterface *PMU;
+#include "../config/config.h"
+#include "pmu_telemetry.h"   // Instantánea de registros del PMU
 
 /**
  * @brief Verifica si la placa solar está cargando la batería
  * @return true si hay entrada VBUS y la batería está cargándose
  */
 bool isSolarChargingBattery() {
-    if (!PMU) return false;  // Verificar que PMU esté inicializado
-    
-    // Verifica si hay entrada VBUS (placa solar conectada y generando voltaje)
-    if (!PMU->isVbusIn()) {
-        return false;  // No hay entrada solar
-    }
-    
-    // Verifica si la batería está cargándose
-    return PMU->isCharging();
+    pmu_telemetry_t pmu;
+    if (!pmuTelemetryRead(&pmu, PMU_TELEMETRY_MAX_AGE_MS)) return false;  // Sin PMU
+
+    // Entrada VBUS (placa solar conectada y generando voltaje) y batería cargándose
+    return pmu.vbusIn && pmu.charging;
 }
 
 /**
@@ -12,6 +12,7 @@
 
 #include "../config/config.h"
 #include <Arduino.h>
+#include "sensor_registry.h"
 
 // =============================================================================
 // CONFIGURACIÓN DEL GENERADOR DE DECODERS TTN
@@ -56,6 +57,38 @@ static void print_battery_percent_decoder() {
     Serial.println(F(""));
 }
 
+/**
+ * @brief Imprime el código para leer la máscara de presencia (muestreo multifrecuencia)
+ */
+static void print_presence_decoder() {
+    Serial.println(F("  // Byte 1: Máscara de presencia (bit 0 pH, 1 temp. exterior, 2 temp. 1m, 3 humedad, 4 presión)"));
+    Serial.println(F("  var presencia = bytes[offset++];"));
+    Serial.println(F(""));
+}
+
+/**
+ * @brief Abre el bloque de un campo que solo viaja si su bit de presencia está activo
+ *
+ * @param bit Bit del campo en la máscara de presencia
+ */
+static void print_field_begin(uint8_t bit) {
+#if SENSOR_MULTIRATE_ENABLE
+    Serial.printf("  if (presencia & 0x%02X) {\r\n", bit);
+#else
+    (void)bit;
+#endif
+}
+
+/**
+ * @brief Cierra el bloque abierto por print_field_begin()
+ */
+static void print_field_end() {
+#if SENSOR_MULTIRATE_ENABLE
+    Serial.println(F("  }"));
+    Serial.println(F(""));
+#endif
+}
+
 /**
  * @brief Imprime el código para decodificar pH
  */
@@ -106,19 +139,101 @@ static void print_pressure_decoder() {
     Serial.println(F(""));
 }
 
+/**
+ * @brief Imprime el código para decodificar la hora de la muestra
+ *
+ * La hora va en unidades de 2 s módulo 65535; se reconstruye tomando el
+ * valor más cercano a la hora de recepción en el gateway.
+ */
+static void print_timestamp_decoder() {
+    Serial.println(F("  // Hora de la muestra (unidades de 2 s, módulo 65535; 0xFFFF = sin hora) - Little-endian"));
+    Serial.println(F("  var ts_raw = bytes[offset++] | (bytes[offset++] << 8);"));
+    Serial.println(F("  if (ts_raw !== 0xFFFF && input.recvTime) {"));
+    Serial.println(F("    var rx = Math.floor(new Date(input.recvTime).getTime() / 2000);"));
+    Serial.println(F("    var age = ((rx % 65535) - ts_raw + 65535) % 65535;"));
+    Serial.println(F("    if (age > 32767) age -= 65535;"));
+    Serial.println(F("    data.timestamp = new Date((rx - age) * 2000).toISOString();"));
+    Serial.println(F("  }"));
+    Serial.println(F(""));
+}
+
+/**
+ * @brief Imprime el código para decodificar el byte de salud de los sensores
+ */
+static void print_health_decoder() {
+    Serial.println(F("  // Salud de sensores: 2 bits por sensor (0 ok, 1 degradado o sin estabilizar, 2 caído)"));
+    Serial.println(F("  var salud = bytes[offset++];"));
+    Serial.println(F("  var estados = ['ok', 'degradado', 'caido', '?'];"));
+    Serial.println(F("  data.salud = {};"));
+    for (uint8_t i = 0; i < SensorRegistry::COUNT; i++) {
+        Serial.printf("  data.salud['%s'] = estados[(salud >> %u) & 3];\r\n",
+                      SensorRegistry::nameAt(i), 2 * i);
+    }
+    Serial.println(F(""));
+}
+
+/**
+ * @brief Imprime el código para decodificar un canal del resumen por ventana
+ *
+ * @param name Nombre del campo en el objeto decodificado
+ */
+static void print_stats_channel_decoder(const char* name) {
+    Serial.printf("    // %s: n (1), min/max/media x100 (int16), desviación x100 (uint16)\r\n", name);
+    Serial.printf("    data.%s = { n: bytes[offset++] };\r\n", name);
+    Serial.printf("    data.%s.min = s16(bytes[offset++] | (bytes[offset++] << 8)) / 100.0;\r\n", name);
+    Serial.printf("    data.%s.max = s16(bytes[offset++] | (bytes[offset++] << 8)) / 100.0;\r\n", name);
+    Serial.printf("    data.%s.media = s16(bytes[offset++] | (bytes[offset++] << 8)) / 100.0;\r\n", name);
+    Serial.printf("    data.%s.desviacion = (bytes[offset++] | (bytes[offset++] << 8)) / 100.0;\r\n", name);
+}
+
+/**
+ * @brief Imprime el código para decodificar el uplink de resumen por ventana
+ */
+static void print_stats_decoder() {
+    Serial.printf("  // Puerto %d: resumen estadístico de la ventana (%d bytes)\r\n",
+                  STATS_FPORT, STATS_PAYLOAD_SIZE);
+    Serial.printf("  if (input.fPort === %d) {\r\n", STATS_FPORT);
+    Serial.println(F("    function s16(v) { return v > 32767 ? v - 65536 : v; }"));
+    Serial.println(F("    data.bateria = bytes[offset++];"));
+#if SYSTEM_HAS_PH
+    print_stats_channel_decoder("ph");
+#endif
+#if SYSTEM_HAS_TEMP_1M
+    print_stats_channel_decoder("temp_1m");
+#endif
+    Serial.println(F("    return { data: data };"));
+    Serial.println(F("  }"));
+    Serial.println(F(""));
+}
+
 /**
  * @brief Imprime validación del tamaño del payload
  */
 static void print_payload_validation() {
-    Serial.println(F("  // Validar tamaño del payload (11 bytes esperados)"));
-    Serial.println(F("  if (bytes.length !== 11) {"));
+#if SENSOR_MULTIRATE_ENABLE
+    // Longitud variable: batería + máscara como mínimo
+    Serial.printf("  // Validar tamaño del payload (%d a %d bytes)\r\n",
+                  PAYLOAD_SIZE_BATTERY + PAYLOAD_SIZE_PRESENCE, PAYLOAD_SIZE_BYTES);
+    Serial.printf("  if (bytes.length < %d || bytes.length > %d) {\r\n",
+                  PAYLOAD_SIZE_BATTERY + PAYLOAD_SIZE_PRESENCE, PAYLOAD_SIZE_BYTES);
     Serial.println(F("    return {"));
     Serial.println(F("      data: data,"));
-    Serial.println(F("      warnings: ['Payload size should be 11 bytes, got ' + bytes.length],"));
+    Serial.println(F("      warnings: ['Unexpected payload size ' + bytes.length],"));
     Serial.println(F("      errors: []"));
     Serial.println(F("    };"));
     Serial.println(F("  }"));
     Serial.println(F(""));
+#else
+    Serial.printf("  // Validar tamaño del payload (%d bytes esperados)\r\n", PAYLOAD_SIZE_BYTES);
+    Serial.printf("  if (bytes.length !== %d) {\r\n", PAYLOAD_SIZE_BYTES);
+    Serial.println(F("    return {"));
+    Serial.println(F("      data: data,"));
+    Serial.printf("      warnings: ['Payload size should be %d bytes, got ' + bytes.length],\r\n", PAYLOAD_SIZE_BYTES);
+    Serial.println(F("      errors: []"));
+    Serial.println(F("    };"));
+    Serial.println(F("  }"));
+    Serial.println(F(""));
+#endif
 }
 
 /**
@@ -157,13 +272,22 @@ static void print_configuration_info() {
     Serial.printf("Tamaño del payload: %d bytes\r\n", payload_size);
 
     // Información sobre estructura del payload
-    Serial.println(F("Estructura del payload (11 bytes):"));
+    Serial.printf("Estructura del payload (%d bytes):\r\n", payload_size);
     Serial.println(F("  Byte 0:      Batería (%)"));
+#if SENSOR_MULTIRATE_ENABLE
+    Serial.println(F("  Byte 1:      Máscara de presencia; después solo los campos con su bit activo"));
+#endif
     Serial.println(F("  Byte 1-2:    pH (x100) - Little-endian"));
     Serial.println(F("  Byte 3-4:    Temperatura exterior (x100) - Little-endian"));
     Serial.println(F("  Byte 5-6:    Temperatura agua 1m (x100) - Little-endian"));
     Serial.println(F("  Byte 7-8:    Humedad (x100) - Little-endian"));
     Serial.println(F("  Byte 9-10:   Presión (x10) - Little-endian"));
+#if ENABLE_SAMPLE_TIMESTAMP
+    Serial.println(F("  Byte 11-12:  Hora de la muestra (2 s, mód. 65535) - Little-endian"));
+#endif
+#if SENSOR_HEALTH_IN_PAYLOAD
+    Serial.println(F("  Último byte: Salud de sensores (2 bits por sensor)"));
+#endif
 
     Serial.println(F(""));
 }
@@ -182,28 +306,52 @@ void generate_and_print_ttn_decoder() {
 
     print_configuration_info();
     print_decoder_header();
+#if STATS_ENABLE
+    print_stats_decoder();
+#endif
     print_payload_validation();
 
     // Generar el código de decodificación para Boya Marítima V2
     // Payload: Battery(1) + pH(2) + TempExt(2) + Temp1m(2) + Humidity(2) + Pressure(2) = 12 bytes
     
     print_battery_percent_decoder();
+#if SENSOR_MULTIRATE_ENABLE
+    print_presence_decoder();
+#endif
     
 #ifdef ENABLE_SENSOR_PH
+    print_field_begin(0x01);
     print_ph_decoder();
+    print_field_end();
 #endif
 
 #ifdef ENABLE_SENSOR_BME280
+    print_field_begin(0x02);
     print_temperature_ext_decoder();
+    print_field_end();
 #endif
 
 #ifdef ENABLE_SENSOR_DS18B20
+    print_field_begin(0x04);
     print_temperature_water_decoder();
+    print_field_end();
 #endif
 
 #ifdef ENABLE_SENSOR_BME280
+    print_field_begin(0x08);
     print_humidity_decoder();
+    print_field_end();
+    print_field_begin(0x10);
     print_pressure_decoder();
+    print_field_end();
+#endif
+
+#if ENABLE_SAMPLE_TIMESTAMP
+    print_timestamp_decoder();
+#endif
+
+#if SENSOR_HEALTH_IN_PAYLOAD
+    print_health_decoder();
 #endif
 
     print_decoder_footer();
@@ -227,9 +375,9 @@ uint16_t generate_ttn_decoder_string(char* buffer, uint16_t max_size) {
         "  var data = {};\n"
         "  var bytes = input.bytes;\n"
         "  var offset = 0;\n\n"
-        "  if (bytes.length !== 11) {\n"
-        "    return { data: data, warnings: ['Payload size should be 11 bytes'], errors: [] };\n"
-        "  }\n\n");
+        "  if (bytes.length !== %d) {\n"
+        "    return { data: data, warnings: ['Payload size should be %d bytes'], errors: [] };\n"
+        "  }\n\n", PAYLOAD_SIZE_BYTES, PAYLOAD_SIZE_BYTES);
 
     // Batería
     offset += snprintf(buffer + offset, max_size - offset,
@@ -265,6 +413,18 @@ uint16_t generate_ttn_decoder_string(char* buffer, uint16_t max_size) {
         "  data.presion_hPa = pressure_raw / 10.0;\n");
 #endif
 
+    // Hora de la muestra
+#if ENABLE_SAMPLE_TIMESTAMP
+    offset += snprintf(buffer + offset, max_size - offset,
+        "  var ts_raw = bytes[offset++] | (bytes[offset++] << 8);\n"
+        "  if (ts_raw !== 0xFFFF && input.recvTime) {\n"
+        "    var rx = Math.floor(new Date(input.recvTime).getTime() / 2000);\n"
+        "    var age = ((rx %% 65535) - ts_raw + 65535) %% 65535;\n"
+        "    if (age > 32767) age -= 65535;\n"
+        "    data.timestamp = new Date((rx - age) * 2000).toISOString();\n"
+        "  }\n");
+#endif
+
     // Footer
     offset += snprintf(buffer + offset, max_size - offset,
         "\n  return { data: data, warnings: [], errors: [] };\n"
@@ -0,0 +1,215 @@
+/**
+ * @file      ulp_accum.cpp
+ * @brief     Programa del ULP, su intérprete y acceso al bloque de datos
+ *
+ * El programa usa R3 como base del bloque de datos y R0 para la lectura
+ * del ADC. Las comparaciones son restas de 16 bits cuyo desbordamiento
+ * (préstamo) decide el salto y la suma de 32 bits propaga el acarreo de
+ * la palabra baja a la alta. Solo la ALU actualiza el flag: LD y ST lo
+ * conservan, así que M_BXF puede ir detrás del ST de la suma.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include "ulp_accum.h"
+
+/**
+ * @brief Palabra del bloque de datos
+ */
+static uint32_t* word(uint32_t* slowMem, uint8_t offset) {
+    return &slowMem[ULP_ACC_DATA_WORD + offset];
+}
+
+static uint16_t get(const uint32_t* slowMem, uint16_t absolute) {
+    return (uint16_t)(slowMem[absolute] & 0xFFFF);
+}
+
+// Etiquetas del programa (los canales usan 6 a partir de su base)
+#define L_BATTERY 0
+#define L_PH 10
+#define L_THRESHOLD 20
+#define L_WAKE 21
+#define L_DONE 22
+
+#define R0 ULP_ACC_R0
+#define R1 ULP_ACC_R1
+#define R2 ULP_ACC_R2
+#define R3 ULP_ACC_R3
+
+#define OP_MOVI(rd, imm)       { ULP_OP_MOVI, rd, 0, 0, imm }
+#define OP_LD(rd, rs, off)     { ULP_OP_LD, rd, rs, 0, off }
+#define OP_ST(rd, rs, off)     { ULP_OP_ST, rd, rs, 0, off }
+#define OP_ADDR(rd, rs, rt)    { ULP_OP_ADDR, rd, rs, rt, 0 }
+#define OP_SUBR(rd, rs, rt)    { ULP_OP_SUBR, rd, rs, rt, 0 }
+#define OP_ADDI(rd, rs, imm)   { ULP_OP_ADDI, rd, rs, 0, imm }
+#define OP_ADC(rd, channel)    { ULP_OP_ADC, rd, 0, 0, channel }
+#define OP_LABEL(label)        { ULP_OP_LABEL, 0, 0, 0, label }
+#define OP_BX(label)           { ULP_OP_BX, 0, 0, 0, label }
+#define OP_BXF(label)          { ULP_OP_BXF, 0, 0, 0, label }
+#define OP_WAKE()              { ULP_OP_WAKE, 0, 0, 0, 0 }
+#define OP_HALT()              { ULP_OP_HALT, 0, 0, 0, 0 }
+
+/**
+ * @brief Acumulación de un canal (lectura en R0, datos en R3)
+ */
+#define OPS_CHANNEL(channelWord, label) \
+    OP_ST(R0, R3, (channelWord) + ULP_ACC_CH_LAST), \
+    /* Mínimo: R0 - min con préstamo si R0 < min */ \
+    OP_LD(R1, R3, (channelWord) + ULP_ACC_CH_MIN), \
+    OP_SUBR(R2, R0, R1), \
+    OP_BXF((label) + 0), \
+    OP_BX((label) + 1), \
+    OP_LABEL((label) + 0), \
+    OP_ST(R0, R3, (channelWord) + ULP_ACC_CH_MIN), \
+    OP_LABEL((label) + 1), \
+    /* Máximo: max - R0 con préstamo si R0 > max */ \
+    OP_LD(R1, R3, (channelWord) + ULP_ACC_CH_MAX), \
+    OP_SUBR(R2, R1, R0), \
+    OP_BXF((label) + 2), \
+    OP_BX((label) + 3), \
+    OP_LABEL((label) + 2), \
+    OP_ST(R0, R3, (channelWord) + ULP_ACC_CH_MAX), \
+    OP_LABEL((label) + 3), \
+    /* Suma de 32 bits: acarreo de la palabra baja a la alta */ \
+    OP_LD(R1, R3, (channelWord) + ULP_ACC_CH_SUM_LO), \
+    OP_ADDR(R1, R1, R0), \
+    OP_ST(R1, R3, (channelWord) + ULP_ACC_CH_SUM_LO), \
+    OP_BXF((label) + 4), \
+    OP_BX((label) + 5), \
+    OP_LABEL((label) + 4), \
+    OP_LD(R1, R3, (channelWord) + ULP_ACC_CH_SUM_HI), \
+    OP_ADDI(R1, R1, 1), \
+    OP_ST(R1, R3, (channelWord) + ULP_ACC_CH_SUM_HI), \
+    OP_LABEL((label) + 5)
+
+const ulp_op_t ulpAccumProgram[] = {
+    OP_MOVI(R3, ULP_ACC_DATA_WORD),
+    OP_ADC(R0, ULP_ACC_ADC_BATTERY),
+    OPS_CHANNEL(ULP_ACC_W_BATTERY, L_BATTERY),
+    OP_ADC(R0, ULP_ACC_ADC_PH),
+    OPS_CHANNEL(ULP_ACC_W_PH, L_PH),
+    // Registro: log[count] = R0; count++
+    OP_LD(R1, R3, ULP_ACC_W_COUNT),
+    OP_LD(R2, R3, ULP_ACC_W_LOG_BASE),
+    OP_ADDR(R2, R2, R1),
+    OP_ST(R0, R2, 0),
+    OP_ADDI(R1, R1, 1),
+    OP_ST(R1, R3, ULP_ACC_W_COUNT),
+    // Umbrales: R0 < PH_LO o PH_HI < R0
+    OP_LD(R2, R3, ULP_ACC_W_PH_LO),
+    OP_SUBR(R2, R0, R2),
+    OP_BXF(L_THRESHOLD),
+    OP_LD(R2, R3, ULP_ACC_W_PH_HI),
+    OP_SUBR(R2, R2, R0),
+    OP_BXF(L_THRESHOLD),
+    // Ventana: seguir durmiendo mientras count < WINDOW
+    OP_LD(R2, R3, ULP_ACC_W_WINDOW),
+    OP_SUBR(R2, R1, R2),
+    OP_BXF(L_DONE),
+    OP_MOVI(R1, ULP_WAKE_WINDOW),
+    OP_BX(L_WAKE),
+    OP_LABEL(L_THRESHOLD),
+    OP_MOVI(R1, ULP_WAKE_THRESHOLD),
+    OP_LABEL(L_WAKE),
+    OP_ST(R1, R3, ULP_ACC_W_REASON),
+    OP_WAKE(),
+    OP_LABEL(L_DONE),
+    OP_HALT(),
+};
+
+const size_t ulpAccumProgramLength = sizeof(ulpAccumProgram) / sizeof(ulpAccumProgram[0]);
+
+/**
+ * @brief Posición de una etiqueta (ulpAccumProgramLength si no existe)
+ */
+static size_t findLabel(uint16_t label) {
+    for (size_t i = 0; i < ulpAccumProgramLength; i++) {
+        if (ulpAccumProgram[i].code == ULP_OP_LABEL && ulpAccumProgram[i].imm == label) {
+            return i;
+        }
+    }
+    return ulpAccumProgramLength;
+}
+
+void ulpAccumReset(uint32_t* slowMem, uint16_t phLo, uint16_t phHi, uint16_t window, uint16_t logBase) {
+    *word(slowMem, ULP_ACC_W_PH_LO) = phLo;
+    *word(slowMem, ULP_ACC_W_PH_HI) = phHi;
+    *word(slowMem, ULP_ACC_W_WINDOW) = window;
+    *word(slowMem, ULP_ACC_W_LOG_BASE) = logBase;
+    *word(slowMem, ULP_ACC_W_COUNT) = 0;
+    *word(slowMem, ULP_ACC_W_REASON) = ULP_WAKE_NONE;
+
+    const uint8_t channels[] = { ULP_ACC_W_BATTERY, ULP_ACC_W_PH };
+    for (uint8_t i = 0; i < sizeof(channels); i++) {
+        *word(slowMem, channels[i] + ULP_ACC_CH_LAST) = 0;
+        *word(slowMem, channels[i] + ULP_ACC_CH_MIN) = 0xFFFF;
+        *word(slowMem, channels[i] + ULP_ACC_CH_MAX) = 0;
+        *word(slowMem, channels[i] + ULP_ACC_CH_SUM_LO) = 0;
+        *word(slowMem, channels[i] + ULP_ACC_CH_SUM_HI) = 0;
+    }
+}
+
+ulp_wake_reason_t ulpAccumStep(uint32_t* slowMem, uint16_t batteryRaw, uint16_t phRaw) {
+    uint16_t reg[4] = { 0, 0, 0, 0 };
+    bool overflow = false;
+
+    // Sin saltos hacia atrás: cada operación se ejecuta como mucho una vez
+    size_t pc = 0;
+    while (pc < ulpAccumProgramLength) {
+        const ulp_op_t& op = ulpAccumProgram[pc++];
+        uint32_t result;
+        switch (op.code) {
+        case ULP_OP_MOVI:
+            reg[op.rd] = op.imm;
+            overflow = false;
+            break;
+        case ULP_OP_LD:
+            reg[op.rd] = get(slowMem, (uint16_t)(reg[op.rs] + op.imm));
+            break;
+        case ULP_OP_ST:
+            slowMem[(uint16_t)(reg[op.rs] + op.imm)] = ((uint32_t)pc << 16) | reg[op.rd];
+            break;
+        case ULP_OP_ADDR:
+        case ULP_OP_ADDI:
+            result = (uint32_t)reg[op.rs] + (op.code == ULP_OP_ADDR ? reg[op.rt] : op.imm);
+            reg[op.rd] = (uint16_t)result;
+            overflow = result > 0xFFFF;
+            break;
+        case ULP_OP_SUBR:
+            overflow = reg[op.rs] < reg[op.rt];
+            reg[op.rd] = (uint16_t)(reg[op.rs] - reg[op.rt]);
+            break;
+        case ULP_OP_ADC:
+            reg[op.rd] = op.imm == ULP_ACC_ADC_PH ? phRaw : batteryRaw;
+            break;
+        case ULP_OP_BX:
+        case ULP_OP_BXF:
+            if (op.code == ULP_OP_BX || overflow) {
+                pc = findLabel(op.imm);
+            }
+            break;
+        case ULP_OP_WAKE:
+            return ulpAccumReason(slowMem);
+        case ULP_OP_HALT:
+            return ULP_WAKE_NONE;
+        default:
+            break;
+        }
+    }
+    return ULP_WAKE_NONE;
+}
+
+void ulpAccumChannel(const uint32_t* slowMem, uint8_t channelWord, ulp_accum_channel_t* out) {
+    uint16_t base = ULP_ACC_DATA_WORD + channelWord;
+    out->count = get(slowMem, ULP_ACC_DATA_WORD + ULP_ACC_W_COUNT);
+    out->min = get(slowMem, base + ULP_ACC_CH_MIN);
+    out->max = get(slowMem, base + ULP_ACC_CH_MAX);
+    out->sum = ((uint32_t)get(slowMem, base + ULP_ACC_CH_SUM_HI) << 16) | get(slowMem, base + ULP_ACC_CH_SUM_LO);
+    out->last = get(slowMem, base + ULP_ACC_CH_LAST);
+}
+
+ulp_wake_reason_t ulpAccumReason(const uint32_t* slowMem) {
+    return (ulp_wake_reason_t)get(slowMem, ULP_ACC_DATA_WORD + ULP_ACC_W_REASON);
+}
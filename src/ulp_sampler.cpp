@@ -0,0 +1,339 @@
+/**
+ * @file      ulp_sampler.cpp
+ * @brief     Programa ULP de muestreo y su gestión desde la CPU
+ *
+ * El programa se construye con las macros de esp32/ulp.h en tiempo de
+ * ejecución (la unidad y el canal del ADC se conocen al resolver los
+ * pines), sin necesidad de la toolchain del ULP: cada operación de
+ * ulpAccumProgram (ulp_accum.cpp), la misma tabla que se prueba en el
+ * host, se traduce a su macro.
+ *
+ * El programa y el bloque de datos ocupan la zona reservada al ULP al
+ * principio de la memoria RTC lenta; el registro de muestras es una
+ * variable RTC_DATA_ATTR normal cuya dirección se pasa al programa.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include "../config/config.h"
+
+#if ULP_SAMPLER_ENABLE
+#if !STATS_ENABLE
+#error "ULP_SAMPLER_ENABLE: la ventana de muestreo la planifica window_stats (STATS_ENABLE)"
+#endif
+#if WAKE_STUB_ENABLE
+#error "ULP_SAMPLER_ENABLE y WAKE_STUB_ENABLE son alternativas: activar solo una"
+#endif
+#ifndef ENABLE_SENSOR_PH
+#error "ULP_SAMPLER_ENABLE: el ULP muestrea la sonda de pH (ENABLE_SENSOR_PH)"
+#endif
+#if PH_USE_POWER_CONTROL
+#error "ULP_SAMPLER_ENABLE: el ULP no puede encender la sonda de pH (PH_USE_POWER_CONTROL)"
+#endif
+#if defined(CONFIG_ULP_COPROC_RESERVE_MEM) && \
+    CONFIG_ULP_COPROC_RESERVE_MEM < (ULP_ACC_DATA_WORD + ULP_ACC_WORDS) * 4
+#error "ULP_SAMPLER_ENABLE: la memoria reservada al ULP no alcanza para programa y datos"
+#endif
+
+#include <Arduino.h>
+#include <math.h>
+#include <esp_attr.h>
+#include <esp_sleep.h>
+#include <esp_system.h>
+#include <esp32/ulp.h>
+#include <soc/rtc_cntl_reg.h>
+#include <soc/sens_reg.h>
+#include <driver/adc.h>
+#include "ulp_sampler.h"
+#include "adc_scan.h"
+#include "sensor_interface.h"
+
+#define ULP_ADC_MAX_RAW 4095
+#define ULP_MAX_INSNS 96        // Instrucciones y etiquetas del programa
+#define L_WAIT ULP_ACC_LABEL_FREE
+
+// Registro de lecturas de pH de la ventana (escrito por el ULP)
+static RTC_DATA_ATTR uint32_t phLog[ULP_SAMPLER_LOG_SIZE];
+// true mientras el bloque de datos es de una ventana armada por este firmware
+static RTC_DATA_ATTR bool armed = false;
+
+/**
+ * @brief Añade instrucciones al programa
+ */
+static void emit(ulp_insn_t* program, size_t* count, const ulp_insn_t* insns, size_t n) {
+    for (size_t i = 0; i < n && *count < ULP_MAX_INSNS; i++) {
+        program[(*count)++] = insns[i];
+    }
+}
+
+/**
+ * @brief Canal del ADC del ULP
+ */
+typedef struct {
+    bool present;
+    uint8_t unit;
+    uint8_t channel;
+} ulp_adc_t;
+
+/**
+ * @brief Traduce una operación de ulpAccumProgram a instrucciones del ULP
+ */
+static void emitOp(ulp_insn_t* program, size_t* count, const ulp_op_t& op, const ulp_adc_t* adcs) {
+    switch (op.code) {
+    case ULP_OP_MOVI: {
+        const ulp_insn_t insns[] = { I_MOVI(op.rd, op.imm) };
+        emit(program, count, insns, 1);
+        break;
+    }
+    case ULP_OP_LD: {
+        const ulp_insn_t insns[] = { I_LD(op.rd, op.rs, op.imm) };
+        emit(program, count, insns, 1);
+        break;
+    }
+    case ULP_OP_ST: {
+        const ulp_insn_t insns[] = { I_ST(op.rd, op.rs, op.imm) };
+        emit(program, count, insns, 1);
+        break;
+    }
+    case ULP_OP_ADDR: {
+        const ulp_insn_t insns[] = { I_ADDR(op.rd, op.rs, op.rt) };
+        emit(program, count, insns, 1);
+        break;
+    }
+    case ULP_OP_SUBR: {
+        const ulp_insn_t insns[] = { I_SUBR(op.rd, op.rs, op.rt) };
+        emit(program, count, insns, 1);
+        break;
+    }
+    case ULP_OP_ADDI: {
+        const ulp_insn_t insns[] = { I_ADDI(op.rd, op.rs, op.imm) };
+        emit(program, count, insns, 1);
+        break;
+    }
+    case ULP_OP_ADC: {
+        // Sin pin de batería el canal acumula ceros
+        const ulp_adc_t& adc = adcs[op.imm];
+        const ulp_insn_t read[] = { I_ADC(op.rd, adc.unit - 1, adc.channel) };
+        const ulp_insn_t zero[] = { I_MOVI(op.rd, 0) };
+        emit(program, count, adc.present ? read : zero, 1);
+        break;
+    }
+    case ULP_OP_LABEL: {
+        const ulp_insn_t insns[] = { M_LABEL(op.imm) };
+        emit(program, count, insns, 1);
+        break;
+    }
+    case ULP_OP_BX: {
+        const ulp_insn_t insns[] = { M_BX(op.imm) };
+        emit(program, count, insns, 1);
+        break;
+    }
+    case ULP_OP_BXF: {
+        const ulp_insn_t insns[] = { M_BXF(op.imm) };
+        emit(program, count, insns, 1);
+        break;
+    }
+    case ULP_OP_WAKE: {
+        // Esperar a que la CPU esté dormida, despertarla y parar el temporizador
+        const ulp_insn_t insns[] = {
+            M_LABEL(L_WAIT),
+            I_RD_REG(RTC_CNTL_LOW_POWER_ST_REG, RTC_CNTL_RDY_FOR_WAKEUP_S, RTC_CNTL_RDY_FOR_WAKEUP_S),
+            I_ANDI(R0, R0, 1),
+            M_BXZ(L_WAIT),
+            I_WAKE(),
+            I_END(),
+        };
+        emit(program, count, insns, sizeof(insns) / sizeof(insns[0]));
+        break;
+    }
+    case ULP_OP_HALT: {
+        const ulp_insn_t insns[] = { I_HALT() };
+        emit(program, count, insns, 1);
+        break;
+    }
+    default:
+        // Operación sin traducción: programa inválido
+        *count = ULP_MAX_INSNS;
+        break;
+    }
+}
+
+/**
+ * @brief Pasa el canal al controlador del ULP, con el SAR encendido solo al convertir
+ */
+static void enableUlpAdc(uint8_t unit) {
+    if (unit == 1) {
+        adc1_ulp_enable();
+    } else {
+        CLEAR_PERI_REG_MASK(SENS_SAR_READ_CTRL2_REG, SENS_SAR2_DIG_FORCE);
+        CLEAR_PERI_REG_MASK(SENS_SAR_MEAS_START2_REG, SENS_MEAS2_START_FORCE | SENS_SAR2_EN_PAD_FORCE);
+    }
+    REG_SET_FIELD(SENS_SAR_MEAS_WAIT2_REG, SENS_FORCE_XPD_SAR, SENS_FORCE_XPD_SAR_FSM);
+}
+
+/**
+ * @brief Primera lectura cruda cuyo pH cumple la condición (0..4096)
+ *
+ * El pH es monótono en la lectura: creciente o decreciente según la
+ * calibración de la sonda.
+ *
+ * @param atLeast true: primera con pH >= ph; false: primera con pH <= ph
+ */
+static uint16_t firstRaw(float ph, bool atLeast) {
+    uint16_t lo = 0;
+    uint16_t hi = ULP_ADC_MAX_RAW + 1;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        float value = sensor_ph_from_raw(mid);
+        if (atLeast ? value >= ph : value <= ph) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief Banda de lecturas crudas con el pH dentro de los umbrales de alarma
+ *
+ * Solo se arma si la lectura actual está dentro: el ULP detecta el cruce
+ * y la política de envío ya conoce el estado de alarma.
+ */
+static void phBand(uint16_t currentRaw, uint16_t* lo, uint16_t* hi) {
+    *lo = 0;
+    *hi = 0xFFFF;
+#if ULP_SAMPLER_WAKE_ON_PH_ALARM
+    float first = sensor_ph_from_raw(0);
+    float last = sensor_ph_from_raw(ULP_ADC_MAX_RAW);
+    if (isnan(first) || isnan(last) || first == last) {
+        Serial.println("ULP: sonda sin calibrar, sin despertar por alarma de pH");
+        return;
+    }
+
+    uint16_t bandLo;
+    uint16_t bandHi;
+    if (last > first) {
+        bandLo = firstRaw(REPORT_PH_ALARM_LOW, true);
+        bandHi = firstRaw(REPORT_PH_ALARM_HIGH, true);
+    } else {
+        bandLo = firstRaw(REPORT_PH_ALARM_HIGH, false);
+        bandHi = firstRaw(REPORT_PH_ALARM_LOW, false);
+    }
+    if (bandHi == 0 || bandLo > ULP_ADC_MAX_RAW || currentRaw < bandLo || currentRaw >= bandHi) {
+        Serial.println("ULP: pH ya fuera de la banda de alarma, sin despertar por cruce");
+        return;
+    }
+    *lo = bandLo;
+    *hi = bandHi - 1;
+#else
+    (void)currentRaw;
+#endif
+}
+
+void ulpSamplerStop() {
+    CLEAR_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+}
+
+bool ulpSamplerArm(uint32_t untilFullBootSeconds) {
+    ulpSamplerStop();
+    armed = false;
+
+    ulp_adc_t adcs[2];
+    ulp_adc_t& ph = adcs[ULP_ACC_ADC_PH];
+    ulp_adc_t& battery = adcs[ULP_ACC_ADC_BATTERY];
+    ph.present = adcScanChannel(ADC_SCAN_PH, &ph.unit, &ph.channel);
+    if (!ph.present) {
+        Serial.println("ULP: ERROR - el pH no está en un canal ADC");
+        return false;
+    }
+    battery.present = adcScanChannel(ADC_SCAN_BATTERY, &battery.unit, &battery.channel);
+
+    // Lectura actual del pH para decidir los umbrales
+    int current = 0;
+    if (ph.unit == 1) {
+        current = adc1_get_raw((adc1_channel_t)ph.channel);
+    } else {
+        adc2_get_raw((adc2_channel_t)ph.channel, ADC_WIDTH_BIT_12, &current);
+    }
+
+    ulp_insn_t program[ULP_MAX_INSNS];
+    size_t count = 0;
+    for (size_t i = 0; i < ulpAccumProgramLength; i++) {
+        emitOp(program, &count, ulpAccumProgram[i], adcs);
+    }
+
+    size_t words = count;
+    if (count >= ULP_MAX_INSNS || ulp_process_macros_and_load(0, program, &words) != ESP_OK ||
+        words > ULP_ACC_PROGRAM_WORDS) {
+        Serial.printf("ULP: ERROR - programa no cargado (%u palabras)\n", (unsigned)words);
+        return false;
+    }
+
+    enableUlpAdc(ph.unit);
+    if (battery.present && battery.unit != ph.unit) {
+        enableUlpAdc(battery.unit);
+    }
+
+    uint16_t lo, hi;
+    phBand((uint16_t)current, &lo, &hi);
+
+    uint32_t window = untilFullBootSeconds / ULP_SAMPLER_PERIOD_SECONDS;
+    if (window < 1) window = 1;
+    if (window > ULP_SAMPLER_LOG_SIZE) window = ULP_SAMPLER_LOG_SIZE;
+    uint16_t logWord = (uint16_t)(phLog - RTC_SLOW_MEM);
+    ulpAccumReset(RTC_SLOW_MEM, lo, hi, (uint16_t)window, logWord);
+
+    ulp_set_wakeup_period(0, ULP_SAMPLER_PERIOD_SECONDS * 1000000UL);
+    esp_sleep_enable_ulp_wakeup();
+    if (ulp_run(0) != ESP_OK) {
+        Serial.println("ULP: ERROR - no arranca");
+        return false;
+    }
+    armed = true;
+
+    Serial.printf("ULP: %u instrucciones, muestreo cada %d s, ventana de %lu muestras, pH crudo %u..%u\n",
+                  (unsigned)words, ULP_SAMPLER_PERIOD_SECONDS, (unsigned long)window, lo, hi);
+    return true;
+}
+
+ulp_wake_reason_t ulpSamplerWakeReason() {
+    if (!armed || esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_ULP) {
+        return ULP_WAKE_NONE;
+    }
+    return ulpAccumReason(RTC_SLOW_MEM);
+}
+
+uint8_t ulpSamplerTake(uint16_t* raw, uint8_t maxCount) {
+    ulpSamplerStop();
+    // Tras un power-on o un reinicio el bloque de datos no es de esta ventana
+    if (!armed || esp_reset_reason() != ESP_RST_DEEPSLEEP) {
+        armed = false;
+        return 0;
+    }
+    armed = false;
+
+    ulp_accum_channel_t ph;
+    ulp_accum_channel_t battery;
+    ulpAccumChannel(RTC_SLOW_MEM, ULP_ACC_W_PH, &ph);
+    ulpAccumChannel(RTC_SLOW_MEM, ULP_ACC_W_BATTERY, &battery);
+
+    uint16_t n = ph.count;
+    if (n > ULP_SAMPLER_LOG_SIZE) n = ULP_SAMPLER_LOG_SIZE;
+    if (n > maxCount) n = maxCount;
+    for (uint16_t i = 0; i < n; i++) {
+        raw[i] = phLog[i] & 0xFFFF;
+    }
+
+    if (ph.count > 0) {
+        Serial.printf("ULP: %u muestras, pH crudo %u..%u (media %.1f), batería %.0f..%.0f mV en el pin\n",
+                      ph.count, ph.min, ph.max, (float)ph.sum / ph.count,
+                      adcScanRawToMillivolts(ADC_SCAN_BATTERY, battery.min),
+                      adcScanRawToMillivolts(ADC_SCAN_BATTERY, battery.max));
+    }
+    return (uint8_t)n;
+}
+
+#endif // ULP_SAMPLER_ENABLE
@@ -0,0 +1,159 @@
+/**
+ * @file      wake_scheduler.cpp
+ * @brief     Implementación del planificador de despertares por ranuras
+ *
+ * El reloj del sistema del ESP32 sigue contando durante el sueño profundo a
+ * partir del reloj lento del RTC, así que las ranuras se calculan sobre
+ * gettimeofday(). Sin hora de red la referencia es el primer arranque; en
+ * cuanto la hora se sincroniza, todas las boyas comparten la misma base y
+ * el desfase por DevEUI las separa en el gateway.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <sys/time.h>
+#include "wake_scheduler.h"
+#include "retained_state.h"
+#include "LoRaBoards.h"
+#include "../config/config.h"
+
+#define WAKE_SCHEDULER_VERSION 1
+
+// Límite de la deriva estimada (ppm); el RC interno de 150 kHz puede derivar unos %
+#define WAKE_MAX_DRIFT_PPM 50000L
+
+// Tiempo mínimo entre sincronizaciones para estimar la deriva (s)
+#define WAKE_MIN_SYNC_SPAN_SECONDS 600UL
+
+/**
+ * @brief Estado del planificador conservado durante el sueño profundo
+ */
+typedef struct {
+    uint32_t leadMs;         /**< Retardo aprendido entre despertar y uplink (ms) */
+    int32_t  driftPpm;       /**< Deriva estimada del reloj local (local - red, ppm) */
+    uint32_t lastSyncLocal;  /**< Segundos locales de la última sincronización (0 = nunca) */
+} wake_scheduler_state_t;
+
+RETAINED_STATE(wake_scheduler_state_t, schedBlock);
+static wake_scheduler_state_t& schedState = schedBlock.state;
+
+/**
+ * @brief Milisegundos del reloj del sistema
+ */
+static int64_t nowMs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+/**
+ * @brief Hora estimada de red (ms): reloj local menos la deriva acumulada
+ *        desde la última sincronización
+ */
+static int64_t estimatedNowMs() {
+    int64_t local = nowMs();
+    int64_t sinceSync = schedState.lastSyncLocal ? local - (int64_t)schedState.lastSyncLocal * 1000 : 0;
+    return local - sinceSync * (int64_t)schedState.driftPpm / 1000000;
+}
+
+/**
+ * @brief Desfase de la ranura dentro del intervalo (s)
+ *
+ * FNV-1a de 32 bits sobre el DevEUI, salvo que se fije WAKE_SLOT_OFFSET_SECONDS.
+ */
+static uint32_t slotOffsetSeconds() {
+#if WAKE_SLOT_OFFSET_SECONDS >= 0
+    return (uint32_t)WAKE_SLOT_OFFSET_SECONDS % SEND_INTERVAL_SECONDS;
+#else
+    uint8_t eui[8];
+    memcpy_P(eui, DEVEUI, sizeof(eui));
+    uint32_t hash = 2166136261UL;
+    for (uint8_t i = 0; i < sizeof(eui); i++) {
+        hash ^= eui[i];
+        hash *= 16777619UL;
+    }
+    return hash % SEND_INTERVAL_SECONDS;
+#endif
+}
+
+void wakeSchedulerInit() {
+    // Sin estado válido queda a cero: sin retardo ni deriva aprendidos
+    retainedRegister(RETAINED_WAKE_SCHEDULER, schedBlock, WAKE_SCHEDULER_VERSION);
+}
+
+void wakeSchedulerMarkUplink() {
+    uint32_t lead = millis();
+    if (schedState.leadMs == 0) {
+        schedState.leadMs = lead;
+    } else {
+        // Media móvil exponencial (alfa = 1/4)
+        schedState.leadMs = (schedState.leadMs * 3 + lead) / 4;
+    }
+}
+
+uint32_t wakeSchedulerNextSleepSeconds() {
+#if !WAKE_SLOT_ALIGN
+    return SEND_INTERVAL_SECONDS;
+#else
+    // Refrescar la calibración del reloj lento con la que se contará el sueño
+    calibrateSlowClock();
+
+    int64_t drift = schedState.driftPpm;
+    int64_t now = estimatedNowMs();
+
+    int64_t interval = (int64_t)SEND_INTERVAL_SECONDS * 1000;
+    int64_t offset = (int64_t)slotOffsetSeconds() * 1000;
+    int64_t lead = schedState.leadMs;
+
+    // Primera ranura cuyo despertar quede al menos WAKE_MIN_SLEEP_SECONDS en el futuro
+    int64_t earliest = now + lead + (int64_t)WAKE_MIN_SLEEP_SECONDS * 1000 - offset;
+    int64_t k = earliest <= 0 ? 0 : (earliest + interval - 1) / interval;
+    int64_t target = k * interval + offset;
+    int64_t sleepMs = target - lead - now;
+
+    // El temporizador cuenta con el reloj local: alargar/acortar según la deriva
+    sleepMs += sleepMs * drift / 1000000;
+
+    uint32_t seconds = (uint32_t)((sleepMs + 500) / 1000);
+    Serial.printf("Ranura %lu s (+%lu s), adelanto %lu ms, deriva %ld ppm -> dormir %lu s\n",
+                  (unsigned long)(target / 1000), (unsigned long)(offset / 1000),
+                  (unsigned long)lead, (long)drift, (unsigned long)seconds);
+    return seconds;
+#endif
+}
+
+uint32_t wakeSchedulerCycleIndex() {
+    int64_t interval = (int64_t)SEND_INTERVAL_SECONDS * 1000;
+#if WAKE_SLOT_ALIGN
+    int64_t since = estimatedNowMs() - (int64_t)slotOffsetSeconds() * 1000;
+#else
+    int64_t since = estimatedNowMs();
+#endif
+    // Redondear a la ranura más cercana: el despertar cae algo antes o después
+    return since <= 0 ? 0 : (uint32_t)((since + interval / 2) / interval);
+}
+
+void wakeSchedulerOnTimeSync(int32_t localMinusNetworkMs) {
+    int64_t local = nowMs();
+    uint32_t localSeconds = (uint32_t)(local / 1000);
+
+    if (schedState.lastSyncLocal != 0 && localSeconds > schedState.lastSyncLocal) {
+        uint32_t span = localSeconds - schedState.lastSyncLocal;
+        if (span >= WAKE_MIN_SYNC_SPAN_SECONDS) {
+            int32_t ppm = (int32_t)((int64_t)localMinusNetworkMs * 1000 / span);
+            if (ppm > WAKE_MAX_DRIFT_PPM) ppm = WAKE_MAX_DRIFT_PPM;
+            if (ppm < -WAKE_MAX_DRIFT_PPM) ppm = -WAKE_MAX_DRIFT_PPM;
+            schedState.driftPpm = (schedState.driftPpm * 3 + ppm) / 4;
+            Serial.printf("Deriva RTC medida %ld ppm (estimada %ld ppm)\n",
+                          (long)ppm, (long)schedState.driftPpm);
+        }
+        // Con menos tiempo el error es sobre todo ruido de medida: no actualizar la deriva
+    }
+
+    // La referencia pasa a ser la hora ya corregida
+    schedState.lastSyncLocal = (uint32_t)((local - localMinusNetworkMs) / 1000);
+}
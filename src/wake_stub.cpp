@@ -0,0 +1,246 @@
+/**
+ * @file      wake_stub.cpp
+ * @brief     Implementación del wake stub de despertares de muestreo
+ *
+ * El stub corre antes de que exista nada de IDF: solo puede usar código
+ * en RTC_IRAM_ATTR, datos en memoria RTC, funciones de la ROM y accesos
+ * directos a registros. Por eso el arranque completo deja todo calculado
+ * (canal del ADC, periodo y límite en ciclos del reloj RTC lento) y el
+ * stub se limita a sumas y comparaciones enteras.
+ *
+ * El estado del stub no usa retained_state: el stub lo modifica sin poder
+ * recalcular el CRC del registro, y el arranque completo solo necesita un
+ * número mágico y una cuenta acotada.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include "../config/config.h"
+
+#if WAKE_STUB_ENABLE
+#if !STATS_ENABLE
+#error "WAKE_STUB_ENABLE: los despertares de muestreo los planifica window_stats (STATS_ENABLE)"
+#endif
+#ifndef ENABLE_SENSOR_PH
+#error "WAKE_STUB_ENABLE: el stub muestrea la sonda de pH (ENABLE_SENSOR_PH)"
+#endif
+#if PH_USE_POWER_CONTROL
+#error "WAKE_STUB_ENABLE: el stub no puede encender la sonda de pH (PH_USE_POWER_CONTROL)"
+#endif
+
+#include <Arduino.h>
+#include <string.h>
+#include <esp_attr.h>
+#include <esp_sleep.h>
+#include <esp_system.h>
+#include <esp_rom_sys.h>
+#include <esp32/rom/rtc.h>
+#include <soc/rtc.h>
+#include <soc/rtc_cntl_reg.h>
+#include <soc/sens_reg.h>
+#include <driver/adc.h>
+#include <esp_private/esp_clk.h>
+#include "wake_stub.h"
+#include "adc_scan.h"
+
+#define WAKE_STUB_MAGIC 0x53545542      // "STUB"
+#define WAKE_STUB_TIMER_WAKE BIT(3)     // Bit del temporizador en RTC_CNTL_WAKEUP_CAUSE
+#define WAKE_STUB_MIN_SLEEP_MS 1000     // Sueño más corto que el stub programa
+#define WAKE_STUB_ADC_TIMEOUT 10000     // Iteraciones máximas esperando al SAR ADC
+
+/**
+ * @brief Estado compartido entre el stub y el arranque completo
+ */
+typedef struct {
+    uint32_t magic;         /**< WAKE_STUB_MAGIC mientras el stub está armado */
+    uint32_t wakes;         /**< Despertares atendidos desde el último arranque completo */
+    uint64_t sampleTicks;   /**< Periodo de muestreo en ciclos del reloj RTC lento */
+    uint64_t deadlineTick;  /**< Cuenta RTC del despertar con arranque completo */
+    uint64_t minSleepTicks; /**< WAKE_STUB_MIN_SLEEP_MS en ciclos del reloj RTC lento */
+    uint8_t unit;           /**< Unidad SAR del pH (1 o 2) */
+    uint8_t channel;        /**< Canal del pH dentro de la unidad */
+    uint8_t count;          /**< Muestras en raw */
+    uint16_t raw[WAKE_STUB_RING_SIZE];
+} wake_stub_state_t;
+
+static RTC_DATA_ATTR wake_stub_state_t stubState;
+
+/**
+ * @brief Cuenta actual del temporizador RTC (como rtc_time_get())
+ */
+static RTC_IRAM_ATTR uint64_t stubRtcTime() {
+    SET_PERI_REG_MASK(RTC_CNTL_TIME_UPDATE_REG, RTC_CNTL_TIME_UPDATE);
+    while (GET_PERI_REG_MASK(RTC_CNTL_TIME_UPDATE_REG, RTC_CNTL_TIME_VALID) == 0) {
+        esp_rom_delay_us(1);  // Puede tardar un ciclo del reloj lento
+    }
+    SET_PERI_REG_MASK(RTC_CNTL_INT_CLR_REG, RTC_CNTL_TIME_VALID_INT_CLR);
+    uint64_t t = READ_PERI_REG(RTC_CNTL_TIME0_REG);
+    t |= ((uint64_t)READ_PERI_REG(RTC_CNTL_TIME1_REG)) << 32;
+    return t;
+}
+
+/**
+ * @brief Una conversión del SAR ADC desde el controlador RTC
+ */
+static RTC_IRAM_ATTR bool stubConvert(uint16_t* raw) {
+    uint32_t wait = 0;
+    if (stubState.unit == 1) {
+        REG_SET_FIELD(SENS_SAR_MEAS_START1_REG, SENS_SAR1_EN_PAD, 1 << stubState.channel);
+        while (REG_GET_FIELD(SENS_SAR_SLAVE_ADDR1_REG, SENS_MEAS_STATUS) != 0) {
+            if (++wait > WAKE_STUB_ADC_TIMEOUT) return false;
+        }
+        REG_CLR_BIT(SENS_SAR_MEAS_START1_REG, SENS_MEAS1_START_SAR);
+        REG_SET_BIT(SENS_SAR_MEAS_START1_REG, SENS_MEAS1_START_SAR);
+        while (REG_GET_BIT(SENS_SAR_MEAS_START1_REG, SENS_MEAS1_DONE_SAR) == 0) {
+            if (++wait > WAKE_STUB_ADC_TIMEOUT) return false;
+        }
+        *raw = REG_GET_FIELD(SENS_SAR_MEAS_START1_REG, SENS_MEAS1_DATA_SAR);
+    } else {
+        REG_SET_FIELD(SENS_SAR_MEAS_START2_REG, SENS_SAR2_EN_PAD, 1 << stubState.channel);
+        REG_CLR_BIT(SENS_SAR_MEAS_START2_REG, SENS_MEAS2_START_SAR);
+        REG_SET_BIT(SENS_SAR_MEAS_START2_REG, SENS_MEAS2_START_SAR);
+        while (REG_GET_BIT(SENS_SAR_MEAS_START2_REG, SENS_MEAS2_DONE_SAR) == 0) {
+            if (++wait > WAKE_STUB_ADC_TIMEOUT) return false;
+        }
+        *raw = REG_GET_FIELD(SENS_SAR_MEAS_START2_REG, SENS_MEAS2_DATA_SAR);
+    }
+    return true;
+}
+
+/**
+ * @brief Media de WAKE_STUB_ADC_SAMPLES conversiones del canal del pH
+ */
+static RTC_IRAM_ATTR bool stubReadPh(uint16_t* raw) {
+    // Atenuación y ancho siguen configurados desde el arranque completo
+    uint32_t power = REG_GET_FIELD(SENS_SAR_MEAS_WAIT2_REG, SENS_FORCE_XPD_SAR);
+    REG_SET_FIELD(SENS_SAR_MEAS_WAIT2_REG, SENS_FORCE_XPD_SAR, SENS_FORCE_XPD_SAR_PU);
+
+    uint32_t sum = 0;
+    bool ok = true;
+    for (uint8_t i = 0; ok && i < WAKE_STUB_ADC_SAMPLES; i++) {
+        uint16_t value;
+        ok = stubConvert(&value);
+        sum += value;
+    }
+
+    REG_SET_FIELD(SENS_SAR_MEAS_WAIT2_REG, SENS_FORCE_XPD_SAR, power);
+    *raw = sum / WAKE_STUB_ADC_SAMPLES;
+    return ok;
+}
+
+/**
+ * @brief Punto de entrada de la ROM al despertar del sueño profundo
+ *
+ * Sustituye al stub por defecto (símbolo débil de IDF). Retornar deja
+ * seguir el arranque completo.
+ */
+void RTC_IRAM_ATTR esp_wake_deep_sleep(void) {
+    esp_default_wake_deep_sleep();
+
+    if (stubState.magic != WAKE_STUB_MAGIC) {
+        return;
+    }
+    // El próximo arranque completo vuelve a armar el stub si hace falta
+    stubState.magic = 0;
+
+    if ((REG_GET_FIELD(RTC_CNTL_WAKEUP_STATE_REG, RTC_CNTL_WAKEUP_CAUSE) & WAKE_STUB_TIMER_WAKE) == 0 ||
+        stubState.count >= WAKE_STUB_RING_SIZE) {
+        return;
+    }
+    uint64_t now = stubRtcTime();
+    if (now + stubState.minSleepTicks >= stubState.deadlineTick) {
+        return;
+    }
+
+    uint16_t raw;
+    if (!stubReadPh(&raw)) {
+        return;
+    }
+    stubState.raw[stubState.count++] = raw;
+    stubState.wakes++;
+
+    uint64_t next = now + stubState.sampleTicks;
+    if (next > stubState.deadlineTick) {
+        next = stubState.deadlineTick;
+    }
+    WRITE_PERI_REG(RTC_CNTL_SLP_TIMER0_REG, (uint32_t)next);
+    WRITE_PERI_REG(RTC_CNTL_SLP_TIMER1_REG, (uint32_t)(next >> 32));
+    stubState.magic = WAKE_STUB_MAGIC;
+
+    // Volver a dormir con la configuración del último esp_deep_sleep_start()
+    REG_WRITE(RTC_ENTRY_ADDR_REG, (uint32_t)&esp_wake_deep_sleep);
+    set_rtc_memory_crc();
+    CLEAR_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_SLEEP_EN);
+    SET_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_SLEEP_EN);
+    while (true) {
+        // El sueño empieza en unos pocos ciclos
+    }
+}
+
+/**
+ * @brief Microsegundos a ciclos del reloj RTC lento con la calibración actual
+ */
+static uint64_t usToTicks(uint64_t us, uint32_t cal) {
+    return (us << RTC_CLK_CAL_FRACT) / cal;
+}
+
+bool wakeStubArm(uint32_t sampleSeconds, uint32_t untilFullBootSeconds) {
+    uint8_t unit;
+    uint8_t channel;
+    if (!adcScanChannel(ADC_SCAN_PH, &unit, &channel)) {
+        wakeStubDisarm();
+        return false;
+    }
+
+    // Una lectura one-shot deja el canal en el controlador RTC con su atenuación y ancho
+    if (unit == 1) {
+        adc1_get_raw((adc1_channel_t)channel);
+    } else {
+        int value;
+        adc2_get_raw((adc2_channel_t)channel, ADC_WIDTH_BIT_12, &value);
+    }
+    // Sin alimentación de los periféricos RTC el SAR ADC pierde esa configuración al dormir
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+
+    uint32_t cal = esp_clk_slowclk_cal_get();  // us por ciclo en Q13.19
+    stubState.unit = unit;
+    stubState.channel = channel;
+    stubState.sampleTicks = usToTicks((uint64_t)sampleSeconds * 1000000ULL, cal);
+    stubState.minSleepTicks = usToTicks((uint64_t)WAKE_STUB_MIN_SLEEP_MS * 1000ULL, cal);
+    stubState.deadlineTick = rtc_time_get() + usToTicks((uint64_t)untilFullBootSeconds * 1000000ULL, cal);
+    stubState.wakes = 0;
+    if (stubState.count > WAKE_STUB_RING_SIZE) {
+        stubState.count = 0;
+    }
+    stubState.magic = WAKE_STUB_MAGIC;
+
+    Serial.printf("Wake stub: muestreo de pH (ADC%u canal %u) cada %lu s durante %lu s\n",
+                  unit, channel, (unsigned long)sampleSeconds, (unsigned long)untilFullBootSeconds);
+    return true;
+}
+
+void wakeStubDisarm() {
+    stubState.magic = 0;
+}
+
+uint8_t wakeStubTake(uint16_t* raw, uint8_t maxCount) {
+    // Tras un power-on o un reinicio el contenido de la RTC no es del stub
+    if (esp_reset_reason() != ESP_RST_DEEPSLEEP || stubState.count > WAKE_STUB_RING_SIZE) {
+        stubState.count = 0;
+        stubState.wakes = 0;
+        return 0;
+    }
+
+    uint8_t n = stubState.count < maxCount ? stubState.count : maxCount;
+    memcpy(raw, stubState.raw, n * sizeof(uint16_t));
+    stubState.count = 0;
+    return n;
+}
+
+uint32_t wakeStubWakeCount() {
+    return stubState.wakes;
+}
+
+#endif // WAKE_STUB_ENABLE
@@ -0,0 +1,259 @@
+/**
+ * @file      window_stats.cpp
+ * @brief     Implementación de los resúmenes estadísticos por ventana
+ *
+ * Welford actualiza media y suma de cuadrados de desviaciones en una sola
+ * pasada y con error numérico acotado, así que no hace falta guardar las
+ * muestras. El instante del próximo uplink se guarda con el reloj del
+ * sistema, que sigue contando durante el sueño profundo.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <math.h>
+#include <esp_attr.h>
+#include <esp_sleep.h>
+#include <sys/time.h>
+#include "window_stats.h"
+#include "sensor_interface.h"
+#include "radio_wake.h"
+#include "sd_logger.h"
+#include "retained_state.h"
+#include "wake_stub.h"
+#include "ulp_sampler.h"
+#include "LoRaBoards.h"
+#include "battery_soc.h"
+
+#define WINDOW_STATS_VERSION 1
+
+// Un despertar tan cerca del uplink se trata ya como despertar de envío (ms)
+#define STATS_UPLINK_GUARD_MS 2000
+
+/**
+ * @brief Canal resumido en la ventana
+ */
+typedef struct {
+    size_t offset;      /**< Posición del valor en sensor_data_t */
+    float error;        /**< Valor de lectura fallida */
+} stats_channel_t;
+
+static const stats_channel_t CHANNELS[] = {
+#if SYSTEM_HAS_PH
+    { offsetof(sensor_data_t, ph),             SENSOR_ERROR_PH },
+#endif
+#if SYSTEM_HAS_TEMP_1M
+    { offsetof(sensor_data_t, temperature_1m), SENSOR_ERROR_TEMPERATURE },
+#endif
+};
+
+/**
+ * @brief Acumulador de Welford de un canal
+ */
+typedef struct {
+    uint16_t count;  /**< Muestras acumuladas */
+    float min;       /**< Mínimo de la ventana */
+    float max;       /**< Máximo de la ventana */
+    float mean;      /**< Media en curso */
+    float m2;        /**< Suma de cuadrados de las desviaciones a la media */
+} stats_acc_t;
+
+/**
+ * @brief Estado de la ventana conservado durante el sueño profundo
+ */
+typedef struct {
+    int64_t  uplinkDueMs;         /**< Reloj del sistema del próximo uplink (ms) */
+    stats_acc_t acc[STATS_CHANNEL_COUNT];
+} window_stats_state_t;
+
+RETAINED_STATE(window_stats_state_t, statsBlock);
+static window_stats_state_t& statsState = statsBlock.state;
+
+/**
+ * @brief Milisegundos del reloj del sistema
+ */
+static int64_t nowMs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+/**
+ * @brief Valida el estado RTC (si no es válido queda a cero: ventana vacía)
+ */
+static bool ensureState() {
+    return retainedRegister(RETAINED_WINDOW_STATS, statsBlock, WINDOW_STATS_VERSION);
+}
+
+/**
+ * @brief Escribe un valor x100 como entero de 16 bits con saturación
+ */
+static uint8_t putScaled(uint8_t* buffer, float value, bool isSigned) {
+    float scaled = roundf(value * 100.0f);
+    int32_t v;
+    if (isSigned) {
+        v = scaled > 32767.0f ? 32767 : scaled < -32768.0f ? -32768 : (int32_t)scaled;
+    } else {
+        v = scaled > 65535.0f ? 65535 : scaled < 0.0f ? 0 : (int32_t)scaled;
+    }
+    buffer[0] = (uint16_t)v & 0xFF;         // Low byte primero
+    buffer[1] = ((uint16_t)v >> 8) & 0xFF;  // High byte después
+    return 2;
+}
+
+bool windowStatsIsSampleWake() {
+#if STATS_ENABLE
+    esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+#if ULP_SAMPLER_ENABLE
+    // Registro del ULP lleno antes del uplink: vaciarlo y seguir con la ventana
+    if (cause == ESP_SLEEP_WAKEUP_ULP && ulpSamplerWakeReason() == ULP_WAKE_WINDOW) {
+        cause = ESP_SLEEP_WAKEUP_TIMER;
+    }
+#endif
+    return ensureState() &&
+           statsState.uplinkDueMs != 0 &&
+           cause == ESP_SLEEP_WAKEUP_TIMER &&
+           nowMs() < statsState.uplinkDueMs - STATS_UPLINK_GUARD_MS;
+#else
+    return false;
+#endif
+}
+
+void windowStatsSampleAndSleep() {
+    Serial.begin(115200);
+    uint32_t start = millis();
+
+    sensor_data_t data;
+    sensors_read_water(&data);
+    windowStatsAdd(&data);
+    sdLogAppend(&data);
+
+    int64_t remaining = statsState.uplinkDueMs - nowMs();
+    uint32_t seconds = windowStatsPlanSleep(remaining > 0 ? (uint32_t)((remaining + 999) / 1000) : 1);
+    Serial.printf("Muestreo de ventana en %lu ms, dormir %lu s\n",
+                  (unsigned long)(millis() - start), (unsigned long)seconds);
+    Serial.flush();
+
+    // La radio sigue aparcada desde el último ciclo con uplink
+    radioWakePark();
+    batterySocOnSleep();
+    retainedSealAll();
+    esp_sleep_enable_timer_wakeup((uint64_t)seconds * 1000000ULL);
+    esp_deep_sleep_start();
+}
+
+/**
+ * @brief Acumula un valor en el canal i (Welford)
+ */
+static void accumulate(uint8_t i, float x) {
+    stats_acc_t* acc = &statsState.acc[i];
+    if (acc->count == 0) {
+        acc->min = acc->max = x;
+        acc->mean = 0.0f;
+        acc->m2 = 0.0f;
+    }
+    if (acc->count < UINT16_MAX) {
+        acc->count++;
+    }
+    if (x < acc->min) acc->min = x;
+    if (x > acc->max) acc->max = x;
+
+    // Welford: media y M2 en una pasada
+    float delta = x - acc->mean;
+    acc->mean += delta / acc->count;
+    acc->m2 += delta * (x - acc->mean);
+}
+
+void windowStatsAdd(const sensor_data_t* data) {
+#if STATS_ENABLE
+    ensureState();
+    for (uint8_t i = 0; i < STATS_CHANNEL_COUNT; i++) {
+        float x = *(const float*)((const uint8_t*)data + CHANNELS[i].offset);
+        if (x == CHANNELS[i].error || isnan(x)) {
+            continue;
+        }
+        accumulate(i, x);
+    }
+
+#if WAKE_STUB_ENABLE || ULP_SAMPLER_ENABLE
+    // Muestras de pH tomadas sin arranque completo (el pH es el canal 0)
+#if WAKE_STUB_ENABLE
+    uint16_t raw[WAKE_STUB_RING_SIZE];
+    uint8_t n = wakeStubTake(raw, WAKE_STUB_RING_SIZE);
+#else
+    uint16_t raw[ULP_SAMPLER_LOG_SIZE];
+    uint8_t n = ulpSamplerTake(raw, ULP_SAMPLER_LOG_SIZE);
+#endif
+    for (uint8_t k = 0; k < n; k++) {
+        float ph = sensor_ph_from_raw(raw[k]);
+        if (!isnan(ph)) {
+            accumulate(0, ph);
+        }
+    }
+    if (n > 0) {
+        Serial.printf("Ventana: %u muestras de pH tomadas durante el sueño\n", n);
+    }
+#endif
+#endif
+}
+
+uint8_t windowStatsBuildPayload(uint8_t* buffer, uint8_t maxSize, float battery) {
+    if (!buffer || maxSize < STATS_PAYLOAD_SIZE) {
+        return 0;
+    }
+    ensureState();
+
+    uint8_t offset = 0;
+    buffer[offset++] = batterySocPercent(battery);
+
+    for (uint8_t i = 0; i < STATS_CHANNEL_COUNT; i++) {
+        const stats_acc_t* acc = &statsState.acc[i];
+        float stddev = acc->count > 1 ? sqrtf(acc->m2 / (acc->count - 1)) : 0.0f;
+
+        buffer[offset++] = acc->count > 255 ? 255 : (uint8_t)acc->count;
+        offset += putScaled(&buffer[offset], acc->count ? acc->min : 0.0f, true);
+        offset += putScaled(&buffer[offset], acc->count ? acc->max : 0.0f, true);
+        offset += putScaled(&buffer[offset], acc->count ? acc->mean : 0.0f, true);
+        offset += putScaled(&buffer[offset], stddev, false);
+
+        Serial.printf("Resumen canal %u: n=%u min=%.2f max=%.2f media=%.2f desv=%.3f\n",
+                      i, acc->count, acc->min, acc->max, acc->mean, stddev);
+    }
+    return offset;
+}
+
+void windowStatsOnSent() {
+    ensureState();
+    memset(statsState.acc, 0, sizeof(statsState.acc));
+}
+
+uint32_t windowStatsPlanSleep(uint32_t untilUplinkSeconds) {
+#if STATS_ENABLE
+    ensureState();
+    int64_t now = nowMs();
+    statsState.uplinkDueMs = now + (int64_t)untilUplinkSeconds * 1000;
+
+#if ULP_SAMPLER_ENABLE
+    // El ULP muestrea durante todo el sueño: la CPU solo despierta para el uplink
+    ulpSamplerArm(untilUplinkSeconds);
+    return untilUplinkSeconds;
+#endif
+
+    if (untilUplinkSeconds <= STATS_SAMPLE_INTERVAL_SECONDS + STATS_UPLINK_GUARD_MS / 1000) {
+#if WAKE_STUB_ENABLE
+        wakeStubDisarm();
+#endif
+        return untilUplinkSeconds;
+    }
+#if WAKE_STUB_ENABLE
+    // Los despertares intermedios los atiende el stub hasta el uplink
+    wakeStubArm(STATS_SAMPLE_INTERVAL_SECONDS, untilUplinkSeconds);
+#endif
+    return STATS_SAMPLE_INTERVAL_SECONDS;
+#else
+    return untilUplinkSeconds;
+#endif
+}
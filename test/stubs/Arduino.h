@@ -0,0 +1,41 @@
+/**
+ * @file      Arduino.h
+ * @brief     Lo mínimo de Arduino para compilar módulos del firmware en el host
+ *
+ * Serial descarta la salida: las pruebas comprueban resultados, no trazas.
+ * millis() devuelve stubMillis(), que cada prueba avanza a mano.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef ARDUINO_STUB_H
+#define ARDUINO_STUB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+class StubSerial {
+public:
+    int printf(const char*, ...) { return 0; }
+    size_t print(const char*) { return 0; }
+    size_t println(const char* = "") { return 0; }
+    void flush() {}
+};
+
+static StubSerial Serial;
+
+inline uint32_t& stubMillis() {
+    static uint32_t ms = 0;
+    return ms;
+}
+
+inline uint32_t millis() {
+    return stubMillis();
+}
+
+#endif // ARDUINO_STUB_H
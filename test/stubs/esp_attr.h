@@ -0,0 +1,13 @@
+/**
+ * @file      esp_attr.h
+ * @brief     Atributos de sección de ESP-IDF, vacíos en el host
+ */
+
+#ifndef ESP_ATTR_STUB_H
+#define ESP_ATTR_STUB_H
+
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define IRAM_ATTR
+
+#endif // ESP_ATTR_STUB_H
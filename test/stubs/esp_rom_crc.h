@@ -0,0 +1,25 @@
+/**
+ * @file      esp_rom_crc.h
+ * @brief     CRC-32 little-endian de la ROM del ESP32, en C para el host
+ *
+ * Mismo resultado que esp_rom_crc32_le(): polinomio reflejado 0xEDB88320
+ * con inversión a la entrada y a la salida, encadenable.
+ */
+
+#ifndef ESP_ROM_CRC_STUB_H
+#define ESP_ROM_CRC_STUB_H
+
+#include <stdint.h>
+
+inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+#endif // ESP_ROM_CRC_STUB_H
@@ -0,0 +1,32 @@
+/**
+ * @file      esp_system.h
+ * @brief     Motivo de reinicio de ESP-IDF controlado por la prueba
+ */
+
+#ifndef ESP_SYSTEM_STUB_H
+#define ESP_SYSTEM_STUB_H
+
+typedef enum {
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+inline esp_reset_reason_t& stubResetReason() {
+    static esp_reset_reason_t reason = ESP_RST_POWERON;
+    return reason;
+}
+
+inline esp_reset_reason_t esp_reset_reason() {
+    return stubResetReason();
+}
+
+#endif // ESP_SYSTEM_STUB_H
@@ -0,0 +1,48 @@
+/**
+ * @file      test_common.h
+ * @brief     Comprobaciones mínimas para las pruebas en el host
+ *
+ * Cada prueba es un programa que cuenta las comprobaciones fallidas y
+ * devuelve 1 si hubo alguna; test/Makefile los compila y ejecuta todos.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+#include <stdio.h>
+#include <math.h>
+
+static int testChecks = 0;
+static int testFailures = 0;
+
+#define CHECK(cond) do {                                                    \
+        testChecks++;                                                       \
+        if (!(cond)) {                                                      \
+            testFailures++;                                                 \
+            printf("%s:%d: FALLO: %s\n", __FILE__, __LINE__, #cond);        \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_NEAR(value, expected, tolerance) do {                         \
+        testChecks++;                                                       \
+        double v_ = (value), e_ = (expected);                               \
+        if (!(fabs(v_ - e_) <= (tolerance))) {                              \
+            testFailures++;                                                 \
+            printf("%s:%d: FALLO: %s = %g, esperado %g\n",                  \
+                   __FILE__, __LINE__, #value, v_, e_);                     \
+        }                                                                   \
+    } while (0)
+
+/**
+ * @brief Imprime el resumen y devuelve el código de salida del programa
+ */
+static inline int testResult(const char* name) {
+    printf("%s: %d comprobaciones, %d fallos\n", name, testChecks, testFailures);
+    return testFailures ? 1 : 0;
+}
+
+#endif // TEST_COMMON_H
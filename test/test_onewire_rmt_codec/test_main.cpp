@@ -0,0 +1,241 @@
+/**
+ * @file      test_main.cpp
+ * @brief     Pruebas en el host de la codificación OneWire <-> símbolos RMT
+ *
+ * Las capturas se generan como las registra el canal RX sobre el bus en
+ * drenador abierto: tramos alternos bajo/alto (los altos consecutivos se
+ * unen), empaquetados de dos en dos en símbolos y terminados con una
+ * duración 0. El maestro es la salida de owRmtEncode() y el esclavo un
+ * DS18B20 que alarga los pulsos bajos de los '0' que lee el maestro, con
+ * unos microsegundos de variación entre slots.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <string.h>
+#include "../test_common.h"
+#include "onewire_rmt_codec.h"
+
+#define MAX_ITEMS         128
+#define PRESENCE_DELAY_US 30    // Del fin del reset al presence pulse
+#define PRESENCE_LOW_US   120
+#define SLAVE_ZERO_LOW_US 30    // Pulso bajo de un '0' del esclavo
+
+static const uint8_t readScratchpad[] = { 0xCC, 0xBE };   // SKIP ROM + READ SCRATCHPAD
+// Scratchpad de un DS18B20 tras el arranque: 85 °C, 12 bits, CRC 0x1C
+static const uint8_t scratchpad[9] = { 0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0x1C };
+
+/**
+ * @brief Captura del canal RX en construcción
+ */
+typedef struct {
+    uint8_t level[2 * MAX_ITEMS];
+    uint16_t duration[2 * MAX_ITEMS];
+    size_t runs;
+} capture_t;
+
+static void line(capture_t* c, uint8_t level, uint16_t duration) {
+    if (c->runs > 0 && c->level[c->runs - 1] == level) {
+        c->duration[c->runs - 1] += duration;
+        return;
+    }
+    c->level[c->runs] = level;
+    c->duration[c->runs] = duration;
+    c->runs++;
+}
+
+/**
+ * @brief Empaqueta los tramos en símbolos RMT con la marca de fin
+ */
+static size_t pack(const capture_t* c, onewire_rmt_item_t* items) {
+    size_t n = 0;
+    for (size_t r = 0; r < c->runs; r += 2) {
+        items[n].level0 = c->level[r];
+        items[n].duration0 = c->duration[r];
+        // El último alto supera el umbral de inactividad: no se mide
+        bool last = r + 1 >= c->runs - 1;
+        items[n].level1 = r + 1 < c->runs ? c->level[r + 1] : 1;
+        items[n].duration1 = last ? 0 : c->duration[r + 1];
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Lo que ve el canal RX cuando el maestro envía tx y el esclavo responde
+ *
+ * @param presence Si el esclavo responde al reset
+ * @param reply Bits que devuelve en los slots de lectura (LSB primero)
+ */
+static size_t capture(const onewire_rmt_item_t* tx, size_t count, size_t readFrom,
+                      bool presence, const uint8_t* reply, onewire_rmt_item_t* items) {
+    capture_t c;
+    c.runs = 0;
+    size_t slot = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint16_t low = tx[i].duration0;
+        uint16_t total = low + tx[i].duration1;
+        if (low == OW_RMT_RESET_LOW_US) {
+            line(&c, 0, low);
+            if (presence) {
+                line(&c, 1, PRESENCE_DELAY_US);
+                line(&c, 0, PRESENCE_LOW_US);
+                line(&c, 1, tx[i].duration1 - PRESENCE_DELAY_US - PRESENCE_LOW_US);
+            } else {
+                line(&c, 1, tx[i].duration1);
+            }
+            continue;
+        }
+
+        uint16_t jitter = (uint16_t)(slot % 3);
+        if (slot >= readFrom && reply != NULL) {
+            size_t bit = slot - readFrom;
+            if (!((reply[bit / 8] >> (bit % 8)) & 0x01)) {
+                low = SLAVE_ZERO_LOW_US;
+            }
+        }
+        low += jitter;
+        line(&c, 0, low);
+        line(&c, 1, total - low);
+        slot++;
+    }
+    return pack(&c, items);
+}
+
+static void testEncodeSlots() {
+    onewire_rmt_item_t items[MAX_ITEMS];
+    const uint8_t bits = 0x02;     // '0' y luego '1' (LSB primero)
+
+    CHECK(owRmtItemCount(true, 2, 1) == 4);
+    CHECK(owRmtEncode(true, &bits, 2, 1, items, MAX_ITEMS) == 4);
+
+    // Reset
+    CHECK(items[0].level0 == 0 && items[0].duration0 == OW_RMT_RESET_LOW_US);
+    CHECK(items[0].level1 == 1 && items[0].duration1 == OW_RMT_RESET_RELEASE_US);
+    // Escritura de '0'
+    CHECK(items[1].level0 == 0 && items[1].duration0 == OW_RMT_WRITE0_LOW_US);
+    CHECK(items[1].level1 == 1 && items[1].duration0 + items[1].duration1 == OW_RMT_SLOT_US);
+    // Escritura de '1'
+    CHECK(items[2].level0 == 0 && items[2].duration0 == OW_RMT_WRITE1_LOW_US);
+    CHECK(items[2].level1 == 1 && items[2].duration0 + items[2].duration1 == OW_RMT_SLOT_US);
+    // Lectura: el mismo símbolo que '1'
+    CHECK(memcmp(&items[3], &items[2], sizeof(items[0])) == 0);
+
+    // Sin reset y bytes LSB primero: 0xCC = 0,0,1,1,0,0,1,1
+    CHECK(owRmtEncode(false, readScratchpad, 8, 0, items, MAX_ITEMS) == 8);
+    const uint16_t expected[] = { 60, 60, 6, 6, 60, 60, 6, 6 };
+    bool lsbFirst = true;
+    for (uint8_t i = 0; i < 8; i++) {
+        lsbFirst = lsbFirst && items[i].duration0 == expected[i];
+    }
+    CHECK(lsbFirst);
+
+    // Sin espacio
+    CHECK(owRmtEncode(true, readScratchpad, 16, 72, items, 88) == 0);
+    CHECK(owRmtEncode(true, readScratchpad, 16, 72, NULL, MAX_ITEMS) == 0);
+}
+
+static void testDecodeScratchpad() {
+    onewire_rmt_item_t tx[MAX_ITEMS];
+    onewire_rmt_item_t rxItems[MAX_ITEMS];
+    size_t n = owRmtEncode(true, readScratchpad, 16, 72, tx, MAX_ITEMS);
+    CHECK(n == 89);
+
+    size_t captured = capture(tx, n, 16, true, scratchpad, rxItems);
+    CHECK(rxItems[captured - 1].duration1 == 0);
+
+    uint8_t rx[9];
+    onewire_rmt_decode_t result;
+    CHECK(owRmtDecode(rxItems, captured, true, 16, rx, 72, &result));
+    CHECK(result.presence);
+    CHECK(result.slots == 88);
+    CHECK(memcmp(rx, scratchpad, sizeof(scratchpad)) == 0);
+    CHECK(owCrc8(rx, 8) == rx[8]);
+    CHECK(owCrc8(rx, 9) == 0);
+}
+
+static void testDecodeCrcFailure() {
+    onewire_rmt_item_t tx[MAX_ITEMS];
+    onewire_rmt_item_t rxItems[MAX_ITEMS];
+    size_t n = owRmtEncode(true, readScratchpad, 16, 72, tx, MAX_ITEMS);
+
+    // Un bit del byte de temperatura cambiado en el bus
+    uint8_t corrupted[9];
+    memcpy(corrupted, scratchpad, sizeof(corrupted));
+    corrupted[0] ^= 0x04;
+    size_t captured = capture(tx, n, 16, true, corrupted, rxItems);
+
+    uint8_t rx[9];
+    onewire_rmt_decode_t result;
+    CHECK(owRmtDecode(rxItems, captured, true, 16, rx, 72, &result));
+    CHECK(result.presence);
+    CHECK(rx[0] == corrupted[0]);
+    CHECK(owCrc8(rx, 8) != rx[8]);
+}
+
+static void testDecodeNoPresence() {
+    onewire_rmt_item_t tx[MAX_ITEMS];
+    onewire_rmt_item_t rxItems[MAX_ITEMS];
+    size_t n = owRmtEncode(true, readScratchpad, 16, 72, tx, MAX_ITEMS);
+
+    // Bus vacío: nadie responde al reset ni baja la línea al leer
+    size_t captured = capture(tx, n, 16, false, NULL, rxItems);
+    uint8_t rx[9];
+    onewire_rmt_decode_t result;
+    CHECK(owRmtDecode(rxItems, captured, true, 16, rx, 72, &result));
+    CHECK(!result.presence);
+    CHECK(result.slots == 88);
+    bool allOnes = true;
+    for (uint8_t i = 0; i < 9; i++) {
+        allOnes = allOnes && rx[i] == 0xFF;
+    }
+    CHECK(allOnes);
+}
+
+static void testDecodeIncomplete() {
+    onewire_rmt_item_t tx[MAX_ITEMS];
+    onewire_rmt_item_t rxItems[MAX_ITEMS];
+    size_t n = owRmtEncode(true, readScratchpad, 16, 72, tx, MAX_ITEMS);
+    uint8_t rx[9];
+    onewire_rmt_decode_t result;
+
+    // Captura cortada antes del último slot
+    size_t captured = capture(tx, n - 1, 16, true, scratchpad, rxItems);
+    CHECK(!owRmtDecode(rxItems, captured, true, 16, rx, 72, &result));
+    CHECK(result.slots == 87);
+
+    // Sin el reset esperado
+    captured = capture(tx + 1, n - 1, 16, true, scratchpad, rxItems);
+    CHECK(!owRmtDecode(rxItems, captured, true, 16, rx, 72, &result));
+    CHECK(result.slots == 0);
+}
+
+static void testReadThreshold() {
+    // Pulso bajo de lectura justo en el umbral ('1') y uno más ('0')
+    onewire_rmt_item_t items[3];
+    memset(items, 0, sizeof(items));
+    items[0].level0 = 0;
+    items[0].duration0 = OW_RMT_READ_THRESHOLD_US;
+    items[0].level1 = 1;
+    items[0].duration1 = OW_RMT_SLOT_US - OW_RMT_READ_THRESHOLD_US;
+    items[1].level0 = 0;
+    items[1].duration0 = OW_RMT_READ_THRESHOLD_US + 1;
+    items[1].level1 = 1;
+    items[1].duration1 = 0;
+
+    uint8_t rx = 0xAA;
+    CHECK(owRmtDecode(items, 2, false, 0, &rx, 2, NULL));
+    CHECK(rx == 0x01);
+}
+
+int main() {
+    testEncodeSlots();
+    testDecodeScratchpad();
+    testDecodeCrcFailure();
+    testDecodeNoPresence();
+    testDecodeIncomplete();
+    testReadThreshold();
+    return testResult("onewire_rmt_codec");
+}
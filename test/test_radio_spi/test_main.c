@@ -0,0 +1,252 @@
+/**
+ * @file      test_main.c
+ * @brief     Pruebas en el host de las transacciones SPI del driver SX1276
+ *
+ * Incluye radio.c de LMIC y sustituye el HAL por un SX1276 simulado:
+ * banco de 128 registros con autoincremento de dirección (salvo RegFifo,
+ * que escribe y lee un FIFO) y contadores de aserciones de NSS y de bytes.
+ * hal_spi_block() se implementa como el camino genérico de hal.cpp (una
+ * aserción de NSS, dirección y datos byte a byte), así que lo que se
+ * comprueba es lo que ve la radio en el bus.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <stdbool.h>
+#include "../test_common.h"
+#include "../../lib/LMIC-Arduino/src/lmic/radio.c"
+
+DEFINE_LMIC;
+
+// ============================================================================
+// SX1276 SIMULADO
+// ============================================================================
+
+#define MOCK_TRACE_MAX 300
+
+static struct {
+    u1_t reg[128];
+    u1_t fifo[256];
+    u1_t fifoWrite;
+    u1_t fifoRead;
+    bool selected;
+    int position;               /* Bytes de la transacción en curso */
+    u1_t addr;
+    bool write;
+    unsigned transactions;      /* Aserciones de NSS */
+    unsigned bytes;             /* Bytes en el bus */
+    u1_t trace[MOCK_TRACE_MAX]; /* MOSI desde mockReset() */
+    unsigned traceLen;
+    unsigned failures;          /* hal_failed() (ASSERT de radio.c) */
+} mock;
+
+static void mockReset(void) {
+    memset(&mock, 0, sizeof(mock));
+}
+
+static void mockCount(void) {
+    mock.transactions = 0;
+    mock.bytes = 0;
+    mock.traceLen = 0;
+}
+
+void hal_pin_nss(u1_t val) {
+    if (!val) {
+        CHECK(!mock.selected);      /* Sin transacciones anidadas */
+        mock.selected = true;
+        mock.position = 0;
+        mock.transactions++;
+    } else {
+        mock.selected = false;
+    }
+}
+
+u1_t hal_spi(u1_t out) {
+    CHECK(mock.selected);
+    mock.bytes++;
+    if (mock.traceLen < MOCK_TRACE_MAX) {
+        mock.trace[mock.traceLen++] = out;
+    }
+
+    if (mock.position++ == 0) {
+        mock.write = (out & 0x80) != 0;
+        mock.addr = out & 0x7F;
+        return 0;
+    }
+
+    u1_t in = 0;
+    if (mock.addr == RegFifo) {
+        if (mock.write) {
+            mock.fifo[mock.fifoWrite++] = out;
+        } else {
+            in = mock.fifo[mock.fifoRead++];
+        }
+        return in;
+    }
+    if (mock.write) {
+        mock.reg[mock.addr] = out;
+    } else {
+        in = mock.reg[mock.addr];
+    }
+    mock.addr = (mock.addr + 1) & 0x7F;
+    return in;
+}
+
+void hal_spi_block(u1_t addr, u1_t* buf, u1_t len, u1_t dir) {
+    hal_pin_nss(0);
+    if (dir == HAL_SPI_WRITE) {
+        hal_spi(addr | 0x80);
+        for (u1_t i = 0; i < len; i++) {
+            hal_spi(buf[i]);
+        }
+    } else {
+        hal_spi(addr & 0x7F);
+        for (u1_t i = 0; i < len; i++) {
+            buf[i] = hal_spi(0x00);
+        }
+    }
+    hal_pin_nss(1);
+}
+
+// Resto del HAL: sin efecto en estas pruebas
+void hal_pin_rxtx(u1_t val) { (void)val; }
+void hal_pin_rst(u1_t val) { (void)val; }
+void hal_disableIRQs(void) {}
+void hal_enableIRQs(void) {}
+void hal_waitUntil(u4_t time) { (void)time; }
+u4_t hal_ticks(void) { return 0; }
+u1_t hal_entropy(u1_t* buf, u1_t len) { (void)buf; (void)len; return 0; }
+void hal_failed(const char* file, u2_t line) { (void)file; (void)line; mock.failures++; }
+ostime_t os_getTime(void) { return 0; }
+void os_setCallback(xref2osjob_t job, osjobcb_t cb) { (void)job; (void)cb; }
+u4_t os_aes(u1_t mode, xref2u1_t buf, u2_t len) { (void)mode; (void)buf; (void)len; return 0; }
+ostime_t calcAirTime(rps_t rps, u1_t plen) { (void)rps; (void)plen; return 0; }
+CONST_TABLE(u1_t, _DR2RPS_CRC)[] = { ILLEGAL_RPS };   /* De lmic.c; no se usa aquí */
+
+// ============================================================================
+// PRUEBAS
+// ============================================================================
+
+static void testBuffers(void) {
+    u1_t out[5] = { 0x11, 0x22, 0x33, 0x44, 0x55 };
+    u1_t in[5] = { 0 };
+
+    mockReset();
+    writeBuf(RegFifo, out, sizeof(out));
+    CHECK(mock.transactions == 1);
+    CHECK(mock.bytes == 6);
+    const u1_t writeStream[] = { 0x80, 0x11, 0x22, 0x33, 0x44, 0x55 };
+    CHECK(mock.traceLen == sizeof(writeStream) && memcmp(mock.trace, writeStream, sizeof(writeStream)) == 0);
+    CHECK(memcmp(mock.fifo, out, sizeof(out)) == 0);
+
+    mockCount();
+    readBuf(RegFifo, in, sizeof(in));
+    CHECK(mock.transactions == 1);
+    CHECK(mock.bytes == 6);
+    const u1_t readStream[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    CHECK(mock.traceLen == sizeof(readStream) && memcmp(mock.trace, readStream, sizeof(readStream)) == 0);
+    CHECK(memcmp(in, out, sizeof(out)) == 0);
+
+    // Fuera del FIFO la radio autoincrementa la dirección
+    mockCount();
+    writeRegs(LORARegFifoAddrPtr, 0xA1, 0xA2);
+    const u1_t regsStream[] = { 0x80 | LORARegFifoAddrPtr, 0xA1, 0xA2 };
+    CHECK(mock.traceLen == sizeof(regsStream) && memcmp(mock.trace, regsStream, sizeof(regsStream)) == 0);
+    CHECK(mock.reg[LORARegFifoAddrPtr] == 0xA1 && mock.reg[LORARegFifoAddrPtr + 1] == 0xA2);
+
+    mockCount();
+    readBuf(LORARegFifoAddrPtr, in, 2);
+    CHECK(mock.transactions == 1 && in[0] == 0xA1 && in[1] == 0xA2);
+    CHECK(mock.trace[0] == LORARegFifoAddrPtr);
+}
+
+static void testConfigChannel(void) {
+    mockReset();
+    LMIC.freq = 868100000;
+    configChannel();
+    // Frf = 868.1 MHz * 2^19 / 32 MHz = 0xD90666
+    CHECK(mock.transactions == 1);
+    CHECK(mock.bytes == 4);
+    CHECK(mock.trace[0] == (0x80 | RegFrfMsb));
+    CHECK(mock.reg[RegFrfMsb] == 0xD9 && mock.reg[RegFrfMsb + 1] == 0x06 && mock.reg[RegFrfMsb + 2] == 0x66);
+}
+
+static void testConfigLoraModem(void) {
+    mockReset();
+    LMIC.rps = makeRps(SF7, BW125, CR_4_5, 0, 0);
+    configLoraModem();
+    // ModemConfig1/2 en una ráfaga y ModemConfig3
+    CHECK(mock.transactions == 2);
+    CHECK(mock.bytes == 5);
+    CHECK(mock.reg[LORARegModemConfig1] == (SX1276_MC1_BW_125 | SX1276_MC1_CR_4_5));
+    CHECK(mock.reg[LORARegModemConfig2] == (0x70 | SX1276_MC2_RX_PAYLOAD_CRCON));
+    CHECK(mock.reg[LORARegModemConfig3] == SX1276_MC3_AGCAUTO);
+
+    // SF12/125 kHz: optimización de baja tasa
+    mockReset();
+    LMIC.rps = makeRps(SF12, BW125, CR_4_5, 0, 0);
+    configLoraModem();
+    CHECK(mock.transactions == 2);
+    CHECK(mock.reg[LORARegModemConfig2] == (0xC0 | SX1276_MC2_RX_PAYLOAD_CRCON));
+    CHECK(mock.reg[LORARegModemConfig3] == (SX1276_MC3_AGCAUTO | SX1276_MC3_LOW_DATA_RATE_OPTIMIZE));
+
+    // Cabecera implícita: además la longitud de payload
+    mockReset();
+    LMIC.rps = makeRps(SF7, BW125, CR_4_5, 12, 0);
+    configLoraModem();
+    CHECK(mock.transactions == 3);
+    CHECK(mock.reg[LORARegPayloadLength] == 12);
+}
+
+static void testTxLora(void) {
+    mockReset();
+    LMIC.freq = 868100000;
+    LMIC.rps = makeRps(SF7, BW125, CR_4_5, 0, 0);
+    LMIC.txpow = 14;
+    LMIC.dataLen = 12;
+    for (u1_t i = 0; i < LMIC.dataLen; i++) {
+        LMIC.frame[i] = (u1_t)(0x40 + i);
+    }
+
+    txlora();
+    // 15 registros sueltos (lecturas incluidas) y 5 ráfagas: ModemConfig1/2,
+    // Frf, IrqFlagsMask/IrqFlags, FifoAddrPtr/FifoTxBaseAddr y el FIFO
+    CHECK(mock.failures == 0);
+    CHECK(mock.transactions == 20);
+    CHECK(mock.bytes == 15 * 2 + 3 + 4 + 3 + 3 + (1 + 12));
+    CHECK(memcmp(mock.fifo, LMIC.frame, LMIC.dataLen) == 0);
+    CHECK(mock.reg[LORARegIrqFlagsMask] == (u1_t)~IRQ_LORA_TXDONE_MASK && mock.reg[LORARegIrqFlags] == 0xFF);
+    CHECK(mock.reg[LORARegFifoAddrPtr] == 0 && mock.reg[LORARegFifoTxBaseAddr] == 0);
+    CHECK(mock.reg[LORARegPayloadLength] == 12);
+    CHECK((mock.reg[RegOpMode] & OPMODE_MASK) == OPMODE_TX);
+}
+
+static void testTxFsk(void) {
+    mockReset();
+    LMIC.freq = 868800000;
+    LMIC.txpow = 14;
+    LMIC.dataLen = 8;
+    memset(LMIC.frame, 0x3C, LMIC.dataLen);
+
+    txfsk();
+    // 12 registros sueltos y 4 ráfagas: bitrate+fdev+Frf, preámbulo+sync,
+    // PacketConfig1/2 y el FIFO
+    CHECK(mock.failures == 0);
+    CHECK(mock.transactions == 16);
+    CHECK(mock.bytes == 12 * 2 + 8 + 7 + 3 + (1 + 8));
+    CHECK(mock.reg[FSKRegBitrateMsb] == 0x02 && mock.reg[FSKRegBitrateMsb + 3] == 0x99);
+    CHECK(mock.reg[RegFrfMsb] == 0xD9 && mock.reg[RegFrfMsb + 1] == 0x33 && mock.reg[RegFrfMsb + 2] == 0x33);
+    CHECK(mock.reg[FSKRegSyncValue1] == 0xC1 && mock.reg[FSKRegSyncValue1 + 2] == 0xC1);
+    CHECK(mock.fifo[0] == 8 && mock.fifo[8] == 0x3C);
+}
+
+int main(void) {
+    testBuffers();
+    testConfigChannel();
+    testConfigLoraModem();
+    testTxLora();
+    testTxFsk();
+    return testResult("radio_spi");
+}
@@ -0,0 +1,194 @@
+/**
+ * @file      test_main.cpp
+ * @brief     Pruebas en el host del registro de estado retenido
+ *
+ * Los bloques de la prueba hacen de memoria RTC sin inicializar: conservan
+ * su contenido entre "arranques" sea cual sea el motivo, como la sección
+ * RTC_NOINIT del ESP32. Cada arranque fija el motivo de reinicio y vacía el
+ * registro en RAM, que es lo que hace un reinicio real; por eso se incluye
+ * retained_state.cpp en esta unidad en lugar de enlazarlo.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include "../test_common.h"
+#include "../../src/retained_state.cpp"
+
+#define STATE_VERSION 3
+
+typedef struct {
+    uint32_t counter;
+    uint8_t bytes[13];
+} sample_state_t;
+
+RETAINED_STATE(sample_state_t, sampleBlock);
+static sample_state_t& sample = sampleBlock.state;
+
+/**
+ * @brief Reinicio: la RAM se pierde, la memoria RTC sin inicializar (los bloques) no
+ */
+static void boot(esp_reset_reason_t reason) {
+    memset(entries, 0, sizeof(entries));
+    stubResetReason() = reason;
+}
+
+static bool registerSample() {
+    return retainedRegister(RETAINED_REPORT_POLICY, sampleBlock, STATE_VERSION);
+}
+
+static bool stateIsZero(const void* state, size_t size) {
+    const uint8_t* p = (const uint8_t*)state;
+    for (size_t i = 0; i < size; i++) {
+        if (p[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Deja el bloque con contenido conocido y sellado
+ */
+static void sealKnownState() {
+    boot(ESP_RST_POWERON);
+    registerSample();
+    sample.counter = 0xCAFE;
+    memset(sample.bytes, 0x5A, sizeof(sample.bytes));
+    retainedSealAll();
+}
+
+static bool sampleKept() {
+    return sample.counter == 0xCAFE && sample.bytes[0] == 0x5A &&
+           sample.bytes[sizeof(sample.bytes) - 1] == 0x5A;
+}
+
+static void testColdStart() {
+    // Basura con cabecera y CRC correctos: el power-on la descarta igual
+    sealKnownState();
+    boot(ESP_RST_POWERON);
+    CHECK(!registerSample());
+    CHECK(stateIsZero(&sample, sizeof(sample)));
+
+    sealKnownState();
+    boot(ESP_RST_UNKNOWN);
+    CHECK(!registerSample());
+    CHECK(stateIsZero(&sample, sizeof(sample)));
+
+    // Memoria RTC sin escribir nunca: nadie la pone a cero salvo el registro
+    const esp_reset_reason_t warm[] = { ESP_RST_DEEPSLEEP, ESP_RST_TASK_WDT, ESP_RST_BROWNOUT };
+    for (size_t i = 0; i < sizeof(warm) / sizeof(warm[0]); i++) {
+        memset(&sampleBlock, 0xA5, sizeof(sampleBlock));
+        boot(warm[i]);
+        CHECK(!registerSample());
+        CHECK(stateIsZero(&sample, sizeof(sample)));
+        CHECK(sampleBlock.header.magic == RETAINED_MAGIC);
+    }
+}
+
+static void testWarmBoot() {
+    const esp_reset_reason_t warm[] = { ESP_RST_DEEPSLEEP, ESP_RST_BROWNOUT, ESP_RST_TASK_WDT, ESP_RST_SW };
+    for (size_t i = 0; i < sizeof(warm) / sizeof(warm[0]); i++) {
+        sealKnownState();
+        boot(warm[i]);
+        CHECK(registerSample());
+        CHECK(sampleKept());
+    }
+
+    // Un bloque reiniciado queda sellado y vale en el arranque siguiente
+    sealKnownState();
+    boot(ESP_RST_POWERON);
+    registerSample();
+    boot(ESP_RST_DEEPSLEEP);
+    CHECK(registerSample());
+}
+
+static void testCorruptedCrc() {
+    // Un byte del estado cambiado después de sellar
+    sealKnownState();
+    sample.bytes[7] ^= 0x01;
+    boot(ESP_RST_DEEPSLEEP);
+    CHECK(!registerSample());
+    CHECK(stateIsZero(&sample, sizeof(sample)));
+
+    // Un byte del CRC
+    sealKnownState();
+    ((uint8_t*)&sampleBlock.header.crc)[2] ^= 0x40;
+    boot(ESP_RST_DEEPSLEEP);
+    CHECK(!registerSample());
+    CHECK(stateIsZero(&sample, sizeof(sample)));
+
+    // Cambio sin sellar (p. ej. watchdog a mitad de ciclo)
+    sealKnownState();
+    boot(ESP_RST_DEEPSLEEP);
+    registerSample();
+    sample.counter++;
+    boot(ESP_RST_TASK_WDT);
+    CHECK(!registerSample());
+
+    // retainedCommit() sella un solo bloque a mitad de ciclo
+    sealKnownState();
+    boot(ESP_RST_DEEPSLEEP);
+    registerSample();
+    sample.counter = 0xBEEF;
+    retainedCommit(RETAINED_REPORT_POLICY);
+    boot(ESP_RST_TASK_WDT);
+    CHECK(registerSample());
+    CHECK(sample.counter == 0xBEEF);
+}
+
+static void testVersionMismatch() {
+    sealKnownState();
+    boot(ESP_RST_DEEPSLEEP);
+    CHECK(!retainedRegister(RETAINED_REPORT_POLICY, sampleBlock, STATE_VERSION + 1));
+    CHECK(stateIsZero(&sample, sizeof(sample)));
+    CHECK(sampleBlock.header.version == STATE_VERSION + 1);
+
+    // Identificador de otro módulo en la cabecera
+    sealKnownState();
+    sampleBlock.header.id = RETAINED_NET_TIME;
+    boot(ESP_RST_DEEPSLEEP);
+    CHECK(!registerSample());
+    CHECK(stateIsZero(&sample, sizeof(sample)));
+}
+
+static void testSizeMismatch() {
+    // El mismo bloque registrado con un estado más corto (otra versión del
+    // firmware que no subió la versión de formato)
+    sealKnownState();
+    boot(ESP_RST_DEEPSLEEP);
+    uint16_t shorter = (uint16_t)(sizeof(sample_state_t) - 4);
+    CHECK(!retainedRegisterRaw(RETAINED_REPORT_POLICY, &sampleBlock.header, &sample, shorter, STATE_VERSION));
+    CHECK(stateIsZero(&sample, shorter));
+    CHECK(sampleBlock.header.size == shorter);
+}
+
+static void testRegistry() {
+    // Idempotente en el mismo arranque: no vuelve a validar ni a borrar
+    sealKnownState();
+    boot(ESP_RST_DEEPSLEEP);
+    CHECK(registerSample());
+    sample.counter = 7;
+    CHECK(registerSample());
+    CHECK(sample.counter == 7);
+
+    boot(ESP_RST_POWERON);
+    CHECK(!registerSample());
+    sample.counter = 9;
+    CHECK(!registerSample());
+    CHECK(sample.counter == 9);
+
+    // Identificador fuera de rango
+    CHECK(!retainedRegisterRaw(RETAINED_ID_COUNT, &sampleBlock.header, &sample, sizeof(sample), 1));
+}
+
+int main() {
+    testColdStart();
+    testWarmBoot();
+    testCorruptedCrc();
+    testVersionMismatch();
+    testSizeMismatch();
+    testRegistry();
+    return testResult("retained_state");
+}
@@ -0,0 +1,147 @@
+/**
+ * @file      test_main.cpp
+ * @brief     Pruebas en el host de soc_estimator
+ *
+ * Reproduce discharge_18650.csv, una descarga sintética generada con
+ * gen_discharge.py (no hay todavía un registro real de la celda de la
+ * boya), con socEstimatorStep() tal como lo llama battery_soc.cpp: la
+ * carga supuesta durante la lectura es siempre SOC_AWAKE_CURRENT_MA,
+ * aunque en una de cada siete lecturas la real sea la de TX.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include "../test_common.h"
+#include "soc_estimator.h"
+
+#define FIRMWARE_LOAD_MA   45       // SOC_AWAKE_CURRENT_MA
+#define SETTLE_STEPS       6        // Pasos hasta que el recuento converge
+#define MAX_ERROR_PERCENT  3.0f
+#define MAX_STEP_PERCENT   0.55f
+
+static const soc_params_t params = { 3000, 150, 0.2f };
+
+static void testOcvCurve() {
+    CHECK_NEAR(socFromOcv(3.79f), 50.0f, 0.01f);
+    CHECK_NEAR(socFromOcv(3.765f), 45.0f, 0.01f);
+    CHECK_NEAR(socFromOcv(3.00f), 0.0f, 0.01f);
+    CHECK_NEAR(socFromOcv(4.18f), 100.0f, 0.01f);
+    CHECK_NEAR(socFromOcv(2.50f), 0.0f, 0.01f);
+    CHECK_NEAR(socFromOcv(4.35f), 100.0f, 0.01f);
+
+    // Monótona en todo el rango
+    float prev = -1.0f;
+    bool monotonic = true;
+    for (float v = 2.9f; v <= 4.25f; v += 0.005f) {
+        float soc = socFromOcv(v);
+        monotonic = monotonic && soc >= prev;
+        prev = soc;
+    }
+    CHECK(monotonic);
+
+    // La zona plana tiene menos pendiente que los extremos
+    CHECK(socOcvSlope(50.0f) < socOcvSlope(5.0f));
+    CHECK(socOcvSlope(50.0f) < socOcvSlope(95.0f));
+    CHECK_NEAR(socOcvSlope(100.0f), socOcvSlope(95.0f), 1e-6);
+    CHECK_NEAR(socOcvSlope(-5.0f), socOcvSlope(0.0f), 1e-6);
+}
+
+static void testCompensation() {
+    // 100 mA por 150 mΩ a 25 °C y sin temperatura
+    CHECK_NEAR(socCompensateOcv(3.70f, 100.0f, 25.0f, 150), 3.715f, 1e-4);
+    CHECK_NEAR(socCompensateOcv(3.70f, 100.0f, NAN, 150), 3.715f, 1e-4);
+    // Sin carga no hay corrección
+    CHECK_NEAR(socCompensateOcv(3.70f, 0.0f, -10.0f, 150), 3.70f, 1e-6);
+    // R_int no baja del valor a 25 °C con calor
+    CHECK_NEAR(socCompensateOcv(3.70f, 100.0f, 45.0f, 150), 3.715f, 1e-4);
+    // Con frío crece un 2 % por grado: a 0 °C, x1.5
+    CHECK_NEAR(socCompensateOcv(3.70f, 100.0f, 0.0f, 150), 3.7225f, 1e-4);
+    // Temperaturas imposibles se limitan a -20 °C (x1.9), no al valor de error
+    CHECK_NEAR(socCompensateOcv(3.70f, 100.0f, -999.0f, 150), 3.7285f, 1e-4);
+    CHECK_NEAR(socCompensateOcv(3.70f, 100.0f, -20.0f, 150),
+               socCompensateOcv(3.70f, 100.0f, -60.0f, 150), 1e-6);
+    CHECK_NEAR(socCompensateOcv(3.70f, 100.0f, 500.0f, 150), 3.715f, 1e-4);
+}
+
+static void testStep() {
+    // El primer paso toma la OCV tal cual
+    soc_estimate_t first = { 0.0f, false };
+    socEstimatorStep(&first, &params, 100.0f, 3.79f, 0.0f, NAN);
+    CHECK(first.valid);
+    CHECK_NEAR(first.percent, 50.0f, 0.01f);
+
+    // Sin lectura solo cuenta: 30 mAh de 3000 es un punto
+    soc_estimate_t counted = { 50.0f, true };
+    socEstimatorStep(&counted, &params, 30.0f, 0.0f, 45.0f, NAN);
+    CHECK_NEAR(counted.percent, 49.0f, 0.001f);
+
+    // Sin lectura y sin estado no inventa nada
+    soc_estimate_t none = { 0.0f, false };
+    socEstimatorStep(&none, &params, 30.0f, 0.0f, 45.0f, NAN);
+    CHECK(!none.valid);
+
+    // El recuento no baja de 0
+    soc_estimate_t empty = { 0.5f, true };
+    socEstimatorStep(&empty, &params, 300.0f, 0.0f, 45.0f, NAN);
+    CHECK_NEAR(empty.percent, 0.0f, 1e-6);
+
+    // Con lectura se acerca a la OCV sin llegar (peso < 1)
+    soc_estimate_t pulled = { 60.0f, true };
+    socEstimatorStep(&pulled, &params, 0.0f, 3.79f, 0.0f, NAN);
+    CHECK(pulled.percent < 60.0f && pulled.percent > 50.0f);
+}
+
+/**
+ * @brief Reproduce la descarga sintética de gen_discharge.py
+ */
+static void testDischargeLog() {
+    FILE* f = fopen(TEST_DIR "/discharge_18650.csv", "r");
+    CHECK(f != NULL);
+    if (!f) {
+        return;
+    }
+
+    char line[128];
+    CHECK(fgets(line, sizeof(line), f) != NULL);   // Cabecera
+
+    soc_estimate_t est = { 0.0f, false };
+    float maxError = 0.0f;
+    float maxStep = 0.0f;
+    float maxLinearError = 0.0f;
+    int rows = 0;
+    float hours, socRef, volts, tempC, consumedMah;
+    int loadMa;
+    while (fscanf(f, "%f,%f,%f,%d,%f,%f", &hours, &socRef, &volts, &loadMa, &tempC, &consumedMah) == 6) {
+        float before = est.percent;
+        socEstimatorStep(&est, &params, consumedMah, volts, FIRMWARE_LOAD_MA, tempC);
+
+        if (rows >= SETTLE_STEPS) {
+            maxError = fmaxf(maxError, fabsf(est.percent - socRef));
+        }
+        if (rows > 0) {
+            maxStep = fmaxf(maxStep, fabsf(est.percent - before));
+        }
+        // batteryPercentFromVoltage(): lineal entre 3.0 y 4.1 V
+        float linear = fminf(fmaxf((volts - 3.0f) / 1.1f * 100.0f, 0.0f), 100.0f);
+        maxLinearError = fmaxf(maxLinearError, fabsf(linear - socRef));
+        rows++;
+    }
+    fclose(f);
+
+    printf("descarga: %d pasos, error máx %.2f %% (lineal %.2f %%), salto máx %.2f %%\n",
+           rows, maxError, maxLinearError, maxStep);
+    CHECK(rows > 2000);
+    CHECK(maxError < MAX_ERROR_PERCENT);
+    CHECK(maxStep < MAX_STEP_PERCENT);
+    CHECK(maxLinearError > 10 * MAX_ERROR_PERCENT);
+}
+
+int main() {
+    testOcvCurve();
+    testCompensation();
+    testStep();
+    testDischargeLog();
+    return testResult("soc_estimator");
+}
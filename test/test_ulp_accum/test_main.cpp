@@ -0,0 +1,205 @@
+/**
+ * @file      test_main.cpp
+ * @brief     Pruebas en el host del programa de acumulación del ULP
+ *
+ * ulpAccumStep() interpreta ulpAccumProgram, la misma tabla que
+ * ulp_sampler.cpp traduce a instrucciones del ULP, sobre una memoria RTC
+ * lenta simulada de 2048 palabras.
+ *
+ * @author    Proyecto IoT de Bajo Consumo
+ * @version   1.0
+ * @date      2025
+ */
+
+#include <string.h>
+#include "../test_common.h"
+#include "ulp_accum.h"
+
+#define SLOW_MEM_WORDS 2048
+#define LOG_BASE       300
+#define NO_LO          0
+#define NO_HI          0xFFFF
+
+static uint32_t slowMem[SLOW_MEM_WORDS];
+
+static void reset(uint16_t phLo, uint16_t phHi, uint16_t window) {
+    memset(slowMem, 0, sizeof(slowMem));
+    ulpAccumReset(slowMem, phLo, phHi, window, LOG_BASE);
+}
+
+static uint32_t& data(uint8_t offset) {
+    return slowMem[ULP_ACC_DATA_WORD + offset];
+}
+
+static ulp_accum_channel_t channel(uint8_t channelWord) {
+    ulp_accum_channel_t out;
+    ulpAccumChannel(slowMem, channelWord, &out);
+    return out;
+}
+
+static void testReset() {
+    reset(100, 200, 10);
+    ulp_accum_channel_t ph = channel(ULP_ACC_W_PH);
+    CHECK(ph.count == 0 && ph.min == 0xFFFF && ph.max == 0 && ph.sum == 0);
+    CHECK(ulpAccumReason(slowMem) == ULP_WAKE_NONE);
+    CHECK(data(ULP_ACC_W_LOG_BASE) == LOG_BASE);
+}
+
+static void testAccumulate() {
+    const uint16_t battery[] = { 2000, 1990, 2010, 1995 };
+    const uint16_t ph[] = { 1500, 1400, 1600, 1550 };
+    reset(NO_LO, NO_HI, 100);
+    for (uint8_t i = 0; i < 4; i++) {
+        CHECK(ulpAccumStep(slowMem, battery[i], ph[i]) == ULP_WAKE_NONE);
+    }
+
+    ulp_accum_channel_t b = channel(ULP_ACC_W_BATTERY);
+    CHECK(b.count == 4 && b.min == 1990 && b.max == 2010 && b.sum == 7995 && b.last == 1995);
+    ulp_accum_channel_t p = channel(ULP_ACC_W_PH);
+    CHECK(p.count == 4 && p.min == 1400 && p.max == 1600 && p.sum == 6050 && p.last == 1550);
+
+    // Registro de muestras de pH, con datos del PC en los 16 bits altos
+    for (uint8_t i = 0; i < 4; i++) {
+        CHECK((slowMem[LOG_BASE + i] & 0xFFFF) == ph[i]);
+        CHECK((slowMem[LOG_BASE + i] >> 16) != 0);
+    }
+    CHECK(slowMem[LOG_BASE + 4] == 0);
+    CHECK(ulpAccumReason(slowMem) == ULP_WAKE_NONE);
+}
+
+static void testSumCarry() {
+    // 20 x 4095 = 81900: pasa de 16 bits
+    reset(NO_LO, NO_HI, 100);
+    for (uint8_t i = 0; i < 20; i++) {
+        ulpAccumStep(slowMem, 4095, 4095);
+    }
+    CHECK(channel(ULP_ACC_W_PH).sum == 81900);
+    CHECK(channel(ULP_ACC_W_BATTERY).sum == 81900);
+    CHECK((data(ULP_ACC_W_PH + ULP_ACC_CH_SUM_HI) & 0xFFFF) == 1);
+
+    // Exactamente 0x10000: palabra baja a 0 y acarreo
+    reset(NO_LO, NO_HI, 100);
+    data(ULP_ACC_W_PH + ULP_ACC_CH_SUM_LO) = 0xFFF0;
+    ulpAccumStep(slowMem, 0, 0x10);
+    CHECK(channel(ULP_ACC_W_PH).sum == 0x10000);
+    // Sin acarreo en el canal de batería (suma 0)
+    CHECK(channel(ULP_ACC_W_BATTERY).sum == 0);
+
+    // Justo por debajo: sin acarreo
+    reset(NO_LO, NO_HI, 100);
+    data(ULP_ACC_W_PH + ULP_ACC_CH_SUM_LO) = 0xFFF0;
+    ulpAccumStep(slowMem, 0, 0x0F);
+    CHECK(channel(ULP_ACC_W_PH).sum == 0xFFFF);
+}
+
+static void testBorrowCompares() {
+    // Iguales: el préstamo no se activa y min/max no cambian
+    reset(NO_LO, NO_HI, 100);
+    ulpAccumStep(slowMem, 0, 1000);
+    uint32_t minWord = data(ULP_ACC_W_PH + ULP_ACC_CH_MIN);
+    uint32_t maxWord = data(ULP_ACC_W_PH + ULP_ACC_CH_MAX);
+    ulpAccumStep(slowMem, 0, 1000);
+    CHECK(data(ULP_ACC_W_PH + ULP_ACC_CH_MIN) == minWord);
+    CHECK(data(ULP_ACC_W_PH + ULP_ACC_CH_MAX) == maxWord);
+
+    // Extremos de 16 bits
+    reset(NO_LO, NO_HI, 100);
+    ulpAccumStep(slowMem, 0, 0);
+    ulpAccumStep(slowMem, 0, 0xFFFF);
+    ulp_accum_channel_t p = channel(ULP_ACC_W_PH);
+    CHECK(p.min == 0 && p.max == 0xFFFF);
+
+    // Comparación sin signo: 0x8000 es mayor que 0x7FFF
+    reset(NO_LO, NO_HI, 100);
+    ulpAccumStep(slowMem, 0, 0x7FFF);
+    ulpAccumStep(slowMem, 0, 0x8000);
+    p = channel(ULP_ACC_W_PH);
+    CHECK(p.min == 0x7FFF && p.max == 0x8000);
+    ulpAccumStep(slowMem, 0, 0x7FFE);
+    CHECK(channel(ULP_ACC_W_PH).min == 0x7FFE);
+
+    // Basura del ULP en los 16 bits altos de todo el bloque
+    reset(1000, 2000, 100);
+    for (uint8_t i = 0; i < ULP_ACC_WORDS; i++) {
+        data(i) |= 0xABCD0000;
+    }
+    CHECK(ulpAccumStep(slowMem, 3000, 1500) == ULP_WAKE_NONE);
+    p = channel(ULP_ACC_W_PH);
+    CHECK(p.count == 1 && p.min == 1500 && p.max == 1500 && p.sum == 1500);
+    CHECK(channel(ULP_ACC_W_BATTERY).max == 3000);
+    CHECK((slowMem[LOG_BASE] & 0xFFFF) == 1500);
+}
+
+static void testWindowWake() {
+    reset(NO_LO, NO_HI, 3);
+    CHECK(ulpAccumStep(slowMem, 0, 100) == ULP_WAKE_NONE);
+    CHECK(ulpAccumStep(slowMem, 0, 101) == ULP_WAKE_NONE);
+    CHECK(ulpAccumReason(slowMem) == ULP_WAKE_NONE);
+    CHECK(ulpAccumStep(slowMem, 0, 102) == ULP_WAKE_WINDOW);
+    CHECK(ulpAccumReason(slowMem) == ULP_WAKE_WINDOW);
+    CHECK(channel(ULP_ACC_W_PH).count == 3);
+    CHECK((slowMem[LOG_BASE + 2] & 0xFFFF) == 102);
+
+    // Ventana de una muestra
+    reset(NO_LO, NO_HI, 1);
+    CHECK(ulpAccumStep(slowMem, 0, 100) == ULP_WAKE_WINDOW);
+}
+
+static void testThresholdWake() {
+    // Los límites de la banda no despiertan
+    reset(1000, 2000, 100);
+    CHECK(ulpAccumStep(slowMem, 0, 1000) == ULP_WAKE_NONE);
+    CHECK(ulpAccumStep(slowMem, 0, 2000) == ULP_WAKE_NONE);
+    CHECK(ulpAccumStep(slowMem, 0, 999) == ULP_WAKE_THRESHOLD);
+    CHECK(ulpAccumReason(slowMem) == ULP_WAKE_THRESHOLD);
+
+    reset(1000, 2000, 100);
+    CHECK(ulpAccumStep(slowMem, 0, 2001) == ULP_WAKE_THRESHOLD);
+    CHECK(channel(ULP_ACC_W_PH).max == 2001);
+
+    // La batería no cuenta para los umbrales
+    reset(1000, 2000, 100);
+    CHECK(ulpAccumStep(slowMem, 4095, 1500) == ULP_WAKE_NONE);
+    CHECK(ulpAccumStep(slowMem, 0, 1500) == ULP_WAKE_NONE);
+
+    // Umbral y fin de ventana en la misma muestra: gana el umbral
+    reset(1000, 2000, 2);
+    ulpAccumStep(slowMem, 0, 1500);
+    CHECK(ulpAccumStep(slowMem, 0, 500) == ULP_WAKE_THRESHOLD);
+    CHECK(ulpAccumReason(slowMem) == ULP_WAKE_THRESHOLD);
+}
+
+static void testProgram() {
+    // Saltos a etiquetas existentes y etiquetas libres para la traducción
+    size_t words = 0;
+    bool labelsOk = true;
+    for (size_t i = 0; i < ulpAccumProgramLength; i++) {
+        const ulp_op_t& op = ulpAccumProgram[i];
+        if (op.code == ULP_OP_BX || op.code == ULP_OP_BXF) {
+            bool found = false;
+            for (size_t j = i + 1; j < ulpAccumProgramLength; j++) {
+                found = found || (ulpAccumProgram[j].code == ULP_OP_LABEL && ulpAccumProgram[j].imm == op.imm);
+            }
+            labelsOk = labelsOk && found;
+        }
+        if (op.code == ULP_OP_LABEL) {
+            labelsOk = labelsOk && op.imm < ULP_ACC_LABEL_FREE;
+        } else {
+            words += op.code == ULP_OP_WAKE ? 5 : 1;
+        }
+    }
+    CHECK(labelsOk);
+    CHECK(ulpAccumProgram[ulpAccumProgramLength - 1].code == ULP_OP_HALT);
+    CHECK(words <= ULP_ACC_PROGRAM_WORDS);
+}
+
+int main() {
+    testReset();
+    testAccumulate();
+    testSumCarry();
+    testBorrowCompares();
+    testWindowWake();
+    testThresholdWake();
+    testProgram();
+    return testResult("ulp_accum");
+}
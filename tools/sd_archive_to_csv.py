@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""
+Convierte el archivo binario de la tarjeta SD (src/sd_logger.cpp) a CSV.
+
+Uso:
+    python3 tools/sd_archive_to_csv.py /ruta/a/boya.bin > boya.csv
+
+El archivo es un buffer circular de bloques de 512 bytes. Se descartan los
+bloques sin cabecera o con CRC incorrecto (sectores nunca escritos o
+escrituras interrumpidas) y el resto se ordena por número de secuencia.
+"""
+
+import csv
+import datetime
+import struct
+import sys
+import zlib
+
+BLOCK_SIZE = 512
+HEADER = struct.Struct("<IIBBBBI")   # magic, secuencia, versión, tamaño registro, registros, rsv, rsv
+RECORD = struct.Struct("<IhhhHHHBB")  # utc, pH, temp 1m, temp, humedad, presión, batería, flags, rsv
+MAGIC = 0x474F4C42                    # "BLOG"
+
+HAS_PH, HAS_TEMP_1M, HAS_TEMP, HAS_HUMIDITY, HAS_PRESSURE, HAS_BATTERY = (1 << i for i in range(6))
+
+COLUMNS = ["secuencia", "utc", "fecha", "ph", "temp_1m", "temp_ambiente",
+           "humedad", "presion_hPa", "bateria_V"]
+
+
+def read_blocks(data):
+    """Devuelve (secuencia, registros) de cada bloque válido, ordenados por secuencia."""
+    blocks = []
+    for offset in range(0, len(data) - BLOCK_SIZE + 1, BLOCK_SIZE):
+        block = data[offset:offset + BLOCK_SIZE]
+        magic, seq, version, rec_size, count, _, _ = HEADER.unpack_from(block)
+        if magic != MAGIC or version != 1 or rec_size != RECORD.size:
+            continue
+        (crc,) = struct.unpack_from("<I", block, BLOCK_SIZE - 4)
+        if crc != zlib.crc32(block[:BLOCK_SIZE - 4]) & 0xFFFFFFFF:
+            print("Bloque %d: CRC incorrecto, descartado" % (offset // BLOCK_SIZE), file=sys.stderr)
+            continue
+        records = [RECORD.unpack_from(block, HEADER.size + i * RECORD.size) for i in range(count)]
+        blocks.append((seq, records))
+    blocks.sort(key=lambda b: b[0])
+    return blocks
+
+
+def field(flags, bit, value, scale):
+    return "%.2f" % (value / scale) if flags & bit else ""
+
+
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__.strip(), file=sys.stderr)
+        return 1
+
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+
+    writer = csv.writer(sys.stdout)
+    writer.writerow(COLUMNS)
+    for seq, records in read_blocks(data):
+        for utc, ph, temp_1m, temp, hum, pres, batt, flags, _ in records:
+            date = ""
+            if utc:
+                date = datetime.datetime.fromtimestamp(utc, datetime.timezone.utc).isoformat()
+            writer.writerow([
+                seq, utc or "", date,
+                field(flags, HAS_PH, ph, 100.0),
+                field(flags, HAS_TEMP_1M, temp_1m, 100.0),
+                field(flags, HAS_TEMP, temp, 100.0),
+                field(flags, HAS_HUMIDITY, hum, 100.0),
+                field(flags, HAS_PRESSURE, pres, 10.0),
+                "%.3f" % (batt / 1000.0) if flags & HAS_BATTERY else "",
+            ])
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())